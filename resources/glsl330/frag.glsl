@@ -0,0 +1,12 @@
+#version 330 core
+
+uniform sampler2D alphaTexture;
+
+in vec4 vCol;
+out vec4 fragColor;
+
+void main()
+{
+	float alpha = texture(alphaTexture, gl_PointCoord).r;
+	fragColor = vec4(vCol.rgb, vCol.a*alpha);
+}
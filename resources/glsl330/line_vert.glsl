@@ -0,0 +1,20 @@
+#version 330 core
+
+layout(std140) uniform Frame {
+	mat4 P;
+	vec3 lightPos;
+};
+uniform mat4 MV;
+
+layout(location = 0) in vec4 aPos;
+layout(location = 3) in vec3 aCol;
+layout(location = 5) in float aSca;
+
+out vec3 vCol;
+
+void main()
+{
+	gl_Position = P * MV * aPos;
+	gl_PointSize = aSca;
+	vCol = aCol;
+}
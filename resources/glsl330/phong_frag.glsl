@@ -0,0 +1,25 @@
+#version 330 core
+in vec3 vPos; // in camera space
+in vec3 vNor; // in camera space
+layout(std140) uniform Frame {
+	mat4 P;
+	vec3 lightPos; // in camera space
+};
+uniform vec3 ka;
+uniform vec3 kd;
+uniform vec3 ks;
+uniform float s;
+out vec4 fragColor;
+
+void main()
+{
+	vec3 n = normalize(vNor);
+	vec3 l = normalize(lightPos - vPos);
+	vec3 v = -normalize(vPos);
+	vec3 h = normalize(l + v);
+	vec3 colorA = ka;
+	vec3 colorD = max(dot(l, n), 0.0) * kd;
+	vec3 colorS = pow(max(dot(h, n), 0.0), s) * ks;
+	vec3 color = colorA + colorD + colorS;
+	fragColor = vec4(color.r, color.g, color.b, 1.0);
+}
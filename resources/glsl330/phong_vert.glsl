@@ -0,0 +1,19 @@
+#version 330 core
+layout(location = 0) in vec4 aPos; // in object space
+layout(location = 1) in vec3 aNor; // in object space
+layout(std140) uniform Frame {
+	mat4 P;
+	vec3 lightPos; // in camera space
+};
+uniform mat4 MV;
+out vec3 vPos; // in camera space
+out vec3 vNor; // in camera space
+
+void main()
+{
+	vec4 posCamera = MV * aPos;
+	vec4 norCamera = MV * vec4(aNor, 0.0);
+	gl_Position = P * posCamera;
+	vPos = posCamera.xyz;
+	vNor = norCamera.xyz;
+}
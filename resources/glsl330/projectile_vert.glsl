@@ -0,0 +1,27 @@
+#version 330 core
+
+layout(std140) uniform Frame {
+	mat4 P;
+	vec3 lightPos;
+};
+uniform mat4 MV;
+uniform float dt; // From the snapshot's tick to the time being drawn
+uniform float beamSpeed;
+uniform float beamLength;
+uniform float beamLife;
+
+// One instance per beam: vertex 0 is its tail and vertex 1 its head
+layout(location = 0) in vec3 aPos;  // Tail at the snapshot's tick
+layout(location = 1) in vec3 aNor;  // Direction
+layout(location = 5) in float aSca; // Age at the snapshot's tick
+
+out vec3 vCol;
+
+void main()
+{
+	// A beam fired on this tick waits at the muzzle rather than being drawn behind it
+	float age = max(aSca + dt, 0.0);
+	vec3 p = aPos + ((age - aSca) * beamSpeed + float(gl_VertexID) * beamLength) * aNor;
+	gl_Position = P * MV * vec4(p, 1.0);
+	vCol = vec3(1.0 - age / beamLife, 0.0, 0.0);
+}
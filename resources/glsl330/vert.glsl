@@ -0,0 +1,25 @@
+#version 330 core
+
+layout(std140) uniform Frame {
+	mat4 P;
+	vec3 lightPos;
+};
+uniform mat4 MV;
+uniform vec2 screenSize;
+
+layout(location = 0) in vec4 aPos;
+layout(location = 4) in float aAlp;
+layout(location = 3) in vec3 aCol;
+layout(location = 5) in float aSca;
+
+out vec4 vCol;
+
+void main()
+{
+	gl_Position = P * MV * aPos;
+	vCol.rgb = aCol;
+	vCol.a = aAlp;
+
+	// http://stackoverflow.com/questions/25780145/gl-pointsize-corresponding-to-world-space-size
+	gl_PointSize = screenSize.y * P[1][1] * aSca / gl_Position.w;
+}
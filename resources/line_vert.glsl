@@ -0,0 +1,17 @@
+#version 120
+
+uniform mat4 P;
+uniform mat4 MV;
+
+attribute vec4 aPos;
+attribute vec3 aCol;
+attribute float aSca;
+
+varying vec3 vCol;
+
+void main()
+{
+	gl_Position = P * MV * aPos;
+	gl_PointSize = aSca;
+	vCol = aCol;
+}
@@ -0,0 +1,44 @@
+#include "AllocStats.h"
+
+#include <atomic>
+#include <cstdlib>
+#include <new>
+
+static std::atomic<uint64_t> numAllocs(0);
+static thread_local uint64_t numThreadAllocs = 0;
+
+namespace AllocStats {
+
+	uint64_t getCount()
+	{
+		return numAllocs.load(std::memory_order_relaxed);
+	}
+
+	uint64_t getThreadCount()
+	{
+		return numThreadAllocs;
+	}
+
+}
+
+// The default new[] and nothrow forms call this one, and the default array deletes call the ones below
+void *operator new(std::size_t size)
+{
+	numAllocs.fetch_add(1, std::memory_order_relaxed);
+	numThreadAllocs++;
+	void *p = std::malloc(size ? size : 1);
+	if(!p) {
+		throw std::bad_alloc();
+	}
+	return p;
+}
+
+void operator delete(void *p) noexcept
+{
+	std::free(p);
+}
+
+void operator delete(void *p, std::size_t) noexcept
+{
+	std::free(p);
+}
@@ -0,0 +1,20 @@
+#pragma once
+#ifndef ALLOC_STATS_H
+#define ALLOC_STATS_H
+
+#include <cstdint>
+
+/**
+ * Counts heap allocations. AllocStats.cpp replaces the global operator new, so every
+ * new, make_shared and container growth on any thread is seen here.
+ */
+namespace AllocStats {
+
+	// Calls to operator new since the program started
+	uint64_t getCount();
+	// Calls to operator new made by the calling thread
+	uint64_t getThreadCount();
+
+}
+
+#endif
@@ -9,9 +9,22 @@
 #define GLM_FORCE_RADIANS
 #include <glm/glm.hpp>
 
+unsigned nextAsteroidID = 0;
+
 Asteroid::Asteroid(std::shared_ptr<Shape> &model){
-    this->pos = glm::vec3(randomFloat(-MAX_X, MAX_X), 0, randomFloat(-MAX_Z, MAX_Z));
-    this->dir = glm::normalize(glm::vec3((float) rand() / (RAND_MAX), 0.0f, (float) rand() / (RAND_MAX)));
+    this->body = asteroidBodies.add();
+    reset(model);
+}
+
+Asteroid::~Asteroid(){
+    asteroidBodies.remove(this->body);
+}
+
+void Asteroid::reset(std::shared_ptr<Shape> &model){
+    this->id = nextAsteroidID++;
+    randomPos();
+    // Drawn in the same order as before the direction moved into asteroidBodies
+    glm::vec3 dir = glm::normalize(glm::vec3((float) rand() / (RAND_MAX), 0.0f, (float) rand() / (RAND_MAX)));
     this->color = glm::vec3(randomFloat(0.1f, 1.0f), randomFloat(0.1f, 1.0f), randomFloat(0.1f, 1.0f));
     bool zNeg = rand() % 2;
     bool xNeg = rand() % 2;
@@ -23,69 +36,96 @@ Asteroid::Asteroid(std::shared_ptr<Shape> &model){
     if (xNeg){
         dir[0] *= -1.0f;
     }
+    setDir(dir);
 
-    this->speed = randomFloat(MIN_ASTEROID_SPEED, MAX_ASTEROID_SPEED);
-    this->size = randomFloat(MIN_ASTEROID_SIZE, MAX_ASTEROID_SIZE);
+    setSpeed(randomFloat(MIN_ASTEROID_SPEED, MAX_ASTEROID_SPEED));
     this->model = model;
+    setSize(randomFloat(MIN_ASTEROID_SIZE, MAX_ASTEROID_SIZE));
 }
 
-void Asteroid::setSize(float size){ this->size = size; }
-void Asteroid::setSpeed(float speed) { this->speed = speed; }
-void Asteroid::setDir(glm::vec3 dir){ this->dir = dir; }
-void Asteroid::setPos(glm::vec3 pos){ this->pos = pos; }
+void Asteroid::setSize(float size){
+    this->size = size;
+    // What getModelMatrix() does to the model's sphere
+    asteroidBodies.radius[this->body] = this->model->getMeshSphere().radius * size;
+}
+void Asteroid::setSpeed(float speed) { asteroidBodies.speed[this->body] = speed; }
+void Asteroid::setDir(glm::vec3 dir){
+    asteroidBodies.dirX[this->body] = dir.x;
+    asteroidBodies.dirY[this->body] = dir.y;
+    asteroidBodies.dirZ[this->body] = dir.z;
+}
+void Asteroid::setPos(glm::vec3 pos){
+    asteroidBodies.x[this->body] = pos.x;
+    asteroidBodies.y[this->body] = pos.y;
+    asteroidBodies.z[this->body] = pos.z;
+}
 void Asteroid::setColor(glm::vec3 color){ this->color = color; }
 
+glm::vec3 Asteroid::getDir(){
+    return glm::vec3(asteroidBodies.dirX[this->body], asteroidBodies.dirY[this->body], asteroidBodies.dirZ[this->body]);
+}
+
+
+// pos is where the center of the model's bounding sphere goes
+void Asteroid::applyMVTransforms(MatrixStack &MV){
+    MV.translate(getPos());
+    MV.scale(size, size, size);
+    MV.translate(-this->model->getMeshSphere().center);
+}
 
-void Asteroid::applyMVTransforms(std::shared_ptr<MatrixStack> &MV){
-    MV->translate(this->pos);
-    MV->translate(0.0f, 0.0f, -7.0f * size / (MAX_ASTEROID_SIZE - MIN_ASTEROID_SIZE));
-    MV->scale(size, size, size);
+glm::mat4 Asteroid::getModelMatrix(){
+    MatrixStack M;
+    applyMVTransforms(M);
+    return M.topMatrix();
 }
 
-void Asteroid::drawAsteroid(const std::shared_ptr<Program> prog, std::shared_ptr<MatrixStack> &MV){
-    MV->pushMatrix();
-    applyMVTransforms(MV);
-    
-    glUniformMatrix4fv(prog->getUniform("MV"), 1, GL_FALSE, glm::value_ptr(MV->topMatrix()));
-	glUniform3f(prog->getUniform("kd"), color[0], color[1], color[2]);
-    
-    this->model->draw(prog);
-    
-    MV->popMatrix();
+void Asteroid::getInstance(AsteroidInstance &inst){
+    inst.id = this->id;
+    inst.model = this->model.get();
+    inst.M = getModelMatrix();
+    inst.color = this->color;
+    inst.bsCenter = getPos();
+    inst.bsRadius = getBoundingSphere().radius;
 }
 
 void Asteroid::move(){
-    this->pos += this->speed * this->dir;
-    
-    if (this->pos.x > MAX_X){
-        this->pos.x = -MAX_X;
+    drift(1.0f);
+
+    glm::vec3 pos = getPos();
+    if (pos.x > MAX_X){
+        pos.x = -MAX_X;
     }
-    else if (this->pos.x < -MAX_X){
-        this->pos.x = MAX_X;
+    else if (pos.x < -MAX_X){
+        pos.x = MAX_X;
     }
 
-    if (this->pos.z > MAX_Z){
-        this->pos.z = -MAX_Z;
+    if (pos.z > MAX_Z){
+        pos.z = -MAX_Z;
     }
-    else if (this->pos.z < -MAX_Z){
-        this->pos.z = MAX_Z;
+    else if (pos.z < -MAX_Z){
+        pos.z = MAX_Z;
     }
+    setPos(pos);
+}
+
+void Asteroid::drift(float ticks){
+    setPos(getPos() + ticks * getSpeed() * getDir());
 }
 
 glm::vec3 Asteroid::getPos(){
-    return this->pos;
+    return glm::vec3(asteroidBodies.x[this->body], asteroidBodies.y[this->body], asteroidBodies.z[this->body]);
 }
 
 void Asteroid::updatePos(glm::vec3 newPos){
-    this->pos = newPos;
+    setPos(newPos);
 }
 
 void Asteroid::randomPos(){
-    this->pos = glm::vec3(randomFloat(-MAX_X, MAX_X), 0, randomFloat(-MAX_Z, MAX_Z));
+    setPos(glm::vec3(randomFloat(-MAX_X, MAX_X), 0, randomFloat(-MAX_Z, MAX_Z)));
 }
 
 void Asteroid::randomDir(){
-    this->dir = glm::normalize(glm::vec3((float) rand() / (RAND_MAX), 0.0f, (float) rand() / (RAND_MAX)));
+    glm::vec3 dir = glm::normalize(glm::vec3((float) rand() / (RAND_MAX), 0.0f, (float) rand() / (RAND_MAX)));
     bool zNeg = rand() % 2;
     bool xNeg = rand() % 2;
 
@@ -96,20 +136,27 @@ void Asteroid::randomDir(){
     if (xNeg){
         dir[0] *= -1.0f;
     }
+    setDir(dir);
 }
 
-std::shared_ptr<BoundingSphere> Asteroid::getBoundingSphere(){
-    return std::make_shared<BoundingSphere>(0.75 * this->size / 0.001, this->pos);
+BoundingSphere Asteroid::getBoundingSphere(){
+    return BoundingSphere(asteroidBodies.radius[this->body], getPos());
 }
 
+OBB Asteroid::getOBB(){
+    return this->model->getMeshOBB().transformed(getModelMatrix());
+}
 
-std::vector<std::shared_ptr<Asteroid> > Asteroid::getChildren(){
-    std::vector<std::shared_ptr<Asteroid> > children;
 
+bool Asteroid::getChildren(Pool<Asteroid> &pool, std::shared_ptr<Asteroid> &c1, std::shared_ptr<Asteroid> &c2){
     if (this->size / 2.0f > MIN_ASTEROID_SIZE){
         // Create children
-        auto c1 = std::make_shared<Asteroid>(this->model);
-        auto c2 = std::make_shared<Asteroid>(this->model);
+        c1 = pool.acquire();
+        c2 = pool.acquire();
+        if (c1){ c1->reset(this->model); }
+        else{ c1 = std::make_shared<Asteroid>(this->model); }
+        if (c2){ c2->reset(this->model); }
+        else{ c2 = std::make_shared<Asteroid>(this->model); }
 
         // - Size = this->size / 2
         float cSize = this->size / 2.0f;
@@ -117,22 +164,22 @@ std::vector<std::shared_ptr<Asteroid> > Asteroid::getChildren(){
         c2->setSize(cSize);
         
         // - Speed = this->speed * 1.2f;
-        float cSpeed = std::min(this->speed * 1.2f, MAX_ASTEROID_SPEED);
+        float cSpeed = std::min(getSpeed() * 1.2f, MAX_ASTEROID_SPEED);
         c1->setSpeed(cSpeed);
         c2->setSpeed(cSpeed);
         
         // - Direction is perpendicular to the current direction
+        glm::vec3 dir = getDir();
         glm::vec3 cDir(dir.z, dir.y, dir.x);
         c1->setDir(cDir);
         c2->setDir(-1.0f * cDir);
 
         // - Position is equal to the parent asteroid's position
-        c1->setPos(pos);
-        c2->setPos(pos);
+        c1->setPos(getPos());
+        c2->setPos(getPos());
 
-        children.push_back(c1);
-        children.push_back(c2);
+        return true;
     }
 
-    return children;
+    return false;
 }
\ No newline at end of file
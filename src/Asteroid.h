@@ -2,9 +2,13 @@
 #ifndef ASTEROID_H
 #define ASTEROID_H
 
+#include "AsteroidBodies.h"
+#include "BoundingBox.h"
 #include "BoundingSphere.h"
 #include "Shape.h"
 #include "MatrixStack.h"
+#include "WorldSnapshot.h"
+#include "Pool.h"
 
 #define GLM_FORCE_RADIANS
 #include <glm/glm.hpp>
@@ -23,14 +27,19 @@
 
 extern int NUM_ASTEROIDS;
 
-extern double tGlobal;
+extern thread_local double tGlobal;
 extern bool drawBoundingBox;
 
 class Asteroid
 {   
     public:
         Asteroid(std::shared_ptr<Shape> &model);
-        ~Asteroid(){}
+        ~Asteroid();
+        // Each asteroid has a body of its own in asteroidBodies
+        Asteroid(const Asteroid &) = delete;
+        Asteroid &operator=(const Asteroid &) = delete;
+        // Turns this into a brand new asteroid (new id, random position, size, etc.), for pooling
+        void reset(std::shared_ptr<Shape> &model);
 
         void setSize(float size);
         void setSpeed(float speed);
@@ -38,23 +47,36 @@ class Asteroid
         void setPos(glm::vec3 pos);
         void setColor(glm::vec3 color);
         glm::vec3 getColor() { return this->color; }
+        glm::vec3 getDir();
+        float getSize() { return this->size; }
+        float getSpeed() { return asteroidBodies.speed[this->body]; }
 
         std::shared_ptr<Shape> model;
-        void drawAsteroid(const std::shared_ptr<Program> prog, std::shared_ptr<MatrixStack> &MV);
+        unsigned getID() { return this->id; }
+        void getInstance(AsteroidInstance &inst);
         void move();
+        // Moves as far as it would in `ticks` calls to move(), without wrapping around the map
+        void drift(float ticks);
         glm::vec3 getPos();
         void updatePos(glm::vec3 newPos);
-        void applyMVTransforms(std::shared_ptr<MatrixStack> &MV);
+        void applyMVTransforms(MatrixStack &MV);
+        // Takes the model's vertices into the world
+        glm::mat4 getModelMatrix();
         void randomPos();
         void randomDir();
-        std::shared_ptr<BoundingSphere> getBoundingSphere();
-        std::vector<std::shared_ptr<Asteroid>> getChildren();
+        // The model's bounding volumes, in the world
+        BoundingSphere getBoundingSphere();
+        OBB getOBB();
+        // Splits the asteroid in two, taking the children from the pool if it has any.
+        // Returns false if it is too small to split.
+        bool getChildren(Pool<Asteroid> &pool, std::shared_ptr<Asteroid> &c1, std::shared_ptr<Asteroid> &c2);
+        // Index of its position, direction, speed and radius in asteroidBodies
+        int getBody() { return this->body; }
     private:
-        glm::vec3 pos;
-        glm::vec3 dir;
+        unsigned id; // Unique and increasing, so the renderer can match asteroids across snapshots
+        int body;
         glm::vec3 color;
         float size;
-        float speed;
 };
 
 #endif
\ No newline at end of file
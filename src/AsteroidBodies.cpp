@@ -0,0 +1,35 @@
+#include "AsteroidBodies.h"
+
+void AsteroidBodies::reserve(int n)
+{
+	x.reserve(n); y.reserve(n); z.reserve(n);
+	dirX.reserve(n); dirY.reserve(n); dirZ.reserve(n);
+	speed.reserve(n);
+	radius.reserve(n);
+	freeBodies.reserve(n);
+}
+
+int AsteroidBodies::add()
+{
+	int i;
+	if(freeBodies.empty()) {
+		i = capacity();
+		x.push_back(0.0f); y.push_back(0.0f); z.push_back(0.0f);
+		dirX.push_back(1.0f); dirY.push_back(0.0f); dirZ.push_back(0.0f);
+		speed.push_back(0.0f);
+		radius.push_back(0.0f);
+		return i;
+	}
+	i = freeBodies.back();
+	freeBodies.pop_back();
+	x[i] = y[i] = z[i] = 0.0f;
+	dirX[i] = 1.0f; dirY[i] = dirZ[i] = 0.0f;
+	speed[i] = 0.0f;
+	radius[i] = 0.0f;
+	return i;
+}
+
+void AsteroidBodies::remove(int i)
+{
+	freeBodies.push_back(i);
+}
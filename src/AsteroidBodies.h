@@ -0,0 +1,33 @@
+#pragma once
+#ifndef ASTEROID_BODIES_H
+#define ASTEROID_BODIES_H
+
+#include <vector>
+
+/**
+ * Where every asteroid is and how it moves, kept as one array per field instead of in the
+ * Asteroid objects, so whatever walks all of them (AsteroidCollider) streams through a few arrays
+ * rather than following a pointer to each asteroid. Each Asteroid holds the index of its body,
+ * which stays the same for as long as the asteroid exists, and reads and writes through it.
+ * A freed body goes on a free list for the next asteroid. Only the simulation thread uses it.
+ */
+struct AsteroidBodies {
+	std::vector<float> x, y, z;
+	std::vector<float> dirX, dirY, dirZ; // Unit direction
+	std::vector<float> speed;            // Per tick
+	std::vector<float> radius;           // Of the bounding sphere in the world
+
+	void reserve(int n);
+	// Returns the index of a body at rest at the origin
+	int add();
+	void remove(int i);
+	// One more than the highest index handed out so far
+	int capacity() const { return (int)x.size(); }
+
+private:
+	std::vector<int> freeBodies;
+};
+
+extern AsteroidBodies asteroidBodies;
+
+#endif
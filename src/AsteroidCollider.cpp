@@ -0,0 +1,337 @@
+#include "AsteroidCollider.h"
+
+#include <algorithm>
+#include <cmath>
+#include <thread>
+
+namespace {
+
+	// The shortest way from 0 to d on an axis that wraps every 2 * half (or doesn't, for half 0)
+	inline float wrapDelta(float d, float half)
+	{
+		if(half > 0.0f) {
+			if(d > half) { d -= 2.0f * half; }
+			else if(d < -half) { d += 2.0f * half; }
+		}
+		return d;
+	}
+
+	// Asteroids move on the x-z plane
+	void setVelocity(int body, float vx, float vz)
+	{
+		AsteroidBodies &b = asteroidBodies;
+		float speed = std::sqrt(vx * vx + vz * vz);
+		b.speed[body] = speed;
+		if(speed > 0.0f) {
+			b.dirX[body] = vx / speed;
+			b.dirY[body] = 0.0f;
+			b.dirZ[body] = vz / speed;
+		}
+	}
+
+}
+
+AsteroidCollider::AsteroidCollider() :
+	axis(0),
+	halfAxis(0.0f),
+	halfOther(0.0f),
+	bandWidth(0.0f),
+	bandScale(0.0f),
+	numBands(1),
+	maxRadius(0.0f),
+	tick(0),
+	numTouching(0),
+	numSwaps(0),
+	numReinserted(0)
+{
+}
+
+void AsteroidCollider::setKeys(Proxy &p) const
+{
+	const AsteroidBodies &b = asteroidBodies;
+	int i = p.body;
+	float c = axis == 0 ? b.x[i] : b.z[i];
+	p.radius = b.radius[i];
+	p.lo = c - p.radius;
+	p.hi = c + p.radius;
+	p.other = axis == 0 ? b.z[i] : b.x[i];
+	if(halfOther > 0.0f) {
+		p.band = std::min(numBands - 1, std::max(0, (int)((p.other + halfOther) * bandScale)));
+	}
+	else {
+		p.band = (int)std::floor(p.other * bandScale);
+	}
+}
+
+int AsteroidCollider::step(std::vector<std::shared_ptr<Asteroid> > &asteroids, float halfX, float halfZ)
+{
+	const AsteroidBodies &b = asteroidBodies;
+	int n = (int)asteroids.size();
+	tick++;
+	numTouching = 0;
+	numSwaps = 0;
+	fresh.clear();
+	if((int)seen.size() < b.capacity()) {
+		seen.resize(b.capacity(), 0);
+		sorted.resize(b.capacity(), 0);
+	}
+
+	// Mark the bodies in play this tick, and sort in the ones that weren't last tick
+	double sumX = 0.0, sumXX = 0.0, sumZ = 0.0, sumZZ = 0.0;
+	maxRadius = 0.0f;
+	for(int i = 0; i < n; i++) {
+		int k = asteroids[i]->getBody();
+		seen[k] = tick;
+		float x = b.x[k], z = b.z[k];
+		sumX += x; sumXX += x * x;
+		sumZ += z; sumZZ += z * z;
+		maxRadius = std::max(maxRadius, b.radius[k]);
+		if(!sorted[k]) {
+			sorted[k] = 1;
+			Proxy fp;
+			fp.body = k;
+			fresh.push_back(fp);
+		}
+	}
+
+	// Sweep along whichever axis the asteroids are more spread out on, with some hysteresis so it
+	// doesn't flip back and forth. Anything that changes the keys of every asteroid means sorting
+	// from scratch.
+	int newAxis = axis;
+	if(n > 0) {
+		double varX = sumXX / n - (sumX / n) * (sumX / n);
+		double varZ = sumZZ / n - (sumZ / n) * (sumZ / n);
+		if(axis == 0 && varZ > COLLIDER_AXIS_SWITCH * varX) { newAxis = 1; }
+		else if(axis == 1 && varX > COLLIDER_AXIS_SWITCH * varZ) { newAxis = 0; }
+	}
+	float newHalfAxis = newAxis == 0 ? halfX : halfZ;
+	float newHalfOther = newAxis == 0 ? halfZ : halfX;
+	float newBandWidth = std::max(COLLIDER_MIN_BAND, 2.0f * maxRadius);
+	int newNumBands = 1;
+	if(newHalfOther > 0.0f) {
+		// A whole number of bands around the playfield
+		newNumBands = std::max(1, (int)std::floor(2.0f * newHalfOther / newBandWidth));
+		newBandWidth = 2.0f * newHalfOther / newNumBands;
+	}
+	bool resort = newAxis != axis || newHalfAxis != halfAxis || newHalfOther != halfOther || newBandWidth != bandWidth;
+	axis = newAxis;
+	halfAxis = newHalfAxis;
+	halfOther = newHalfOther;
+	bandWidth = newBandWidth;
+	bandScale = 1.0f / bandWidth;
+	numBands = newNumBands;
+
+	for(auto p = fresh.begin(); p != fresh.end(); ++p) {
+		setKeys(*p);
+	}
+
+	// Drop the asteroids that are gone and update where the rest are. The ones that moved to
+	// another band or wrapped around would have a long way to go in the insertion sort, so they
+	// are sorted in with the new ones instead.
+	size_t m = 0;
+	for(size_t k = 0; k < proxies.size(); k++) {
+		if(seen[proxies[k].body] != tick) {
+			sorted[proxies[k].body] = 0;
+			continue;
+		}
+		Proxy p = proxies[k];
+		setKeys(p);
+		if(!resort && (p.band != proxies[k].band || std::abs(p.lo - proxies[k].lo) > bandWidth)) {
+			fresh.push_back(p);
+		}
+		else {
+			proxies[m++] = p;
+		}
+	}
+	proxies.resize(m);
+	numReinserted = (int)fresh.size();
+
+	if(resort) {
+		proxies.insert(proxies.end(), fresh.begin(), fresh.end());
+		std::sort(proxies.begin(), proxies.end(), sortsBefore);
+	}
+	else {
+		// Nearly sorted already
+		for(size_t k = 1; k < proxies.size(); k++) {
+			Proxy p = proxies[k];
+			size_t j = k;
+			while(j > 0 && sortsBefore(p, proxies[j - 1])) {
+				proxies[j] = proxies[j - 1];
+				j--;
+			}
+			proxies[j] = p;
+			numSwaps += (long)(k - j);
+		}
+		if(!fresh.empty()) {
+			std::sort(fresh.begin(), fresh.end(), sortsBefore);
+			merged.resize(proxies.size() + fresh.size());
+			std::merge(proxies.begin(), proxies.end(), fresh.begin(), fresh.end(), merged.begin(), sortsBefore);
+			proxies.swap(merged);
+		}
+	}
+	// Where each band starts
+	bandStart.clear();
+	for(size_t k = 0; k < proxies.size(); k++) {
+		if(k == 0 || proxies[k].band != proxies[k - 1].band) {
+			bandStart.push_back(k);
+		}
+	}
+	bandStart.push_back(proxies.size());
+
+	// Each band against itself and the next one up, in runs of COLLIDER_BANDS_PER_RUN bands. A run
+	// also bounces asteroids in the band after its last, which is the next run's first, so the
+	// even runs are swept at once on as many threads as there are cores, and then the odd ones.
+	// Runs swept at the same time never write the same asteroid, and the order the bounces
+	// happen in, so the result, doesn't depend on how many threads there are.
+	int nb = (int)bandStart.size() - 1;
+	int numRuns = (nb + COLLIDER_BANDS_PER_RUN - 1) / COLLIDER_BANDS_PER_RUN;
+	int maxThreads = std::max(1, std::min((int)std::thread::hardware_concurrency(), n / COLLIDER_MIN_PER_THREAD));
+	Tally total;
+	for(int parity = 0; parity < 2; parity++) {
+		int runs = (numRuns - parity + 1) / 2;
+		int numThreads = std::max(1, std::min(maxThreads, runs));
+		std::vector<Tally> tallies(numThreads);
+		auto sweepRuns = [this, parity, runs, numThreads, nb, &tallies](int t){
+			for(int k = runs * t / numThreads; k < runs * (t + 1) / numThreads; k++) {
+				int r = (2 * k + parity) * COLLIDER_BANDS_PER_RUN;
+				sweepRange(r, std::min(nb, r + COLLIDER_BANDS_PER_RUN), tallies[t]);
+			}
+		};
+		std::vector<std::thread> threads;
+		for(int t = 1; t < numThreads; t++) {
+			threads.push_back(std::thread(sweepRuns, t));
+		}
+		sweepRuns(0);
+		for(int t = 0; t < numThreads; t++) {
+			if(t > 0) {
+				threads[t - 1].join();
+			}
+			total.touching += tallies[t].touching;
+			total.bounced += tallies[t].bounced;
+		}
+	}
+	// The last band and the first are next to each other around the playfield. (With two bands
+	// they already were.)
+	if(halfOther > 0.0f && numBands > 2 && nb >= 2 && proxies[0].band == 0 && proxies[bandStart[nb - 1]].band == numBands - 1) {
+		size_t a0 = bandStart[nb - 1], a1 = bandStart[nb];
+		size_t b0 = bandStart[0], b1 = bandStart[1];
+		sweepBands(a0, a1, b0, b1, 0.0f, total);
+		if(halfAxis > 0.0f) {
+			sweepWrap(a0, a1, b0, b1, total);
+			sweepWrap(b0, b1, a0, a1, total);
+		}
+	}
+	numTouching = total.touching;
+	return total.bounced;
+}
+
+void AsteroidCollider::sweepRange(int first, int last, Tally &tally) const
+{
+	for(int r = first; r < last; r++) {
+		size_t a0 = bandStart[r], a1 = bandStart[r + 1];
+		sweepBand(a0, a1, tally);
+		if(halfAxis > 0.0f) {
+			sweepWrap(a0, a1, a0, a1, tally);
+		}
+		if(r + 1 < (int)bandStart.size() - 1 && proxies[a1].band == proxies[a0].band + 1) {
+			size_t b0 = bandStart[r + 1], b1 = bandStart[r + 2];
+			sweepBands(a0, a1, b0, b1, 0.0f, tally);
+			if(halfAxis > 0.0f) {
+				sweepWrap(a0, a1, b0, b1, tally);
+				sweepWrap(b0, b1, a0, a1, tally);
+			}
+		}
+	}
+}
+
+void AsteroidCollider::sweepBand(size_t begin, size_t end, Tally &tally) const
+{
+	for(size_t k = begin; k < end; k++) {
+		const Proxy &a = proxies[k];
+		for(size_t j = k + 1; j < end && proxies[j].lo <= a.hi; j++) {
+			if(touches(a, proxies[j], 0.0f)) {
+				resolve(a, proxies[j], 0.0f, tally);
+			}
+		}
+	}
+}
+
+void AsteroidCollider::sweepBands(size_t aBegin, size_t aEnd, size_t bBegin, size_t bEnd, float shift, Tally &tally) const
+{
+	// Walk both in order of where they start. Whichever starts first is tested against everything
+	// in the other band that starts before it ends.
+	size_t i = aBegin, j = bBegin;
+	while(i < aEnd && j < bEnd) {
+		if(proxies[i].lo <= proxies[j].lo + shift) {
+			const Proxy &a = proxies[i];
+			for(size_t k = j; k < bEnd && proxies[k].lo + shift <= a.hi; k++) {
+				if(touches(a, proxies[k], shift)) {
+					resolve(a, proxies[k], shift, tally);
+				}
+			}
+			i++;
+		}
+		else {
+			const Proxy &b = proxies[j];
+			for(size_t k = i; k < aEnd && proxies[k].lo <= b.hi + shift; k++) {
+				if(touches(proxies[k], b, shift)) {
+					resolve(proxies[k], b, shift, tally);
+				}
+			}
+			j++;
+		}
+	}
+}
+
+void AsteroidCollider::sweepWrap(size_t aBegin, size_t aEnd, size_t bBegin, size_t bEnd, Tally &tally) const
+{
+	// Everything is centered on the playfield, so only asteroids that start within maxRadius of
+	// the near end can touch ones that end within maxRadius of the far end
+	auto startsBefore = [](const Proxy &p, float v){ return p.lo < v; };
+	size_t headEnd = std::lower_bound(proxies.begin() + aBegin, proxies.begin() + aEnd, -halfAxis + maxRadius, startsBefore) - proxies.begin();
+	size_t tailBegin = std::lower_bound(proxies.begin() + bBegin, proxies.begin() + bEnd, halfAxis - 3.0f * maxRadius, startsBefore) - proxies.begin();
+	sweepBands(aBegin, headEnd, tailBegin, bEnd, -2.0f * halfAxis, tally);
+}
+
+inline bool AsteroidCollider::touches(const Proxy &a, const Proxy &b, float shift) const
+{
+	// Nearly every pair tested misses, so this is the only branch most of them see. The reach is
+	// from the radii rather than the keys, which have lost some of their precision to the position.
+	float dAxis = (b.lo + b.radius) + shift - (a.lo + a.radius);
+	float dOther = wrapDelta(b.other - a.other, halfOther);
+	float reach = a.radius + b.radius;
+	return (dAxis * dAxis + dOther * dOther < reach * reach) & (a.body != b.body);
+}
+
+void AsteroidCollider::resolve(const Proxy &a, const Proxy &b, float shift, Tally &tally) const
+{
+	tally.touching++;
+	float dAxis = (b.lo + b.radius) + shift - (a.lo + a.radius);
+	float dOther = wrapDelta(b.other - a.other, halfOther);
+	float dx = axis == 0 ? dAxis : dOther;
+	float dz = axis == 0 ? dOther : dAxis;
+	float dist2 = dx * dx + dz * dz;
+	// Exactly on top of each other, like the halves of a split at the tick it happens: no normal
+	if(dist2 < 1e-12f) {
+		return;
+	}
+
+	AsteroidBodies &bodies = asteroidBodies;
+	int i = a.body, j = b.body;
+	float vxi = bodies.speed[i] * bodies.dirX[i], vzi = bodies.speed[i] * bodies.dirZ[i];
+	float vxj = bodies.speed[j] * bodies.dirX[j], vzj = bodies.speed[j] * bodies.dirZ[j];
+	float dist = std::sqrt(dist2);
+	float nx = dx / dist, nz = dz / dist;
+	float vn = (vxj - vxi) * nx + (vzj - vzi) * nz;
+	if(vn >= 0.0f) {
+		return;
+	}
+
+	float mi = a.radius * a.radius * a.radius;
+	float mj = b.radius * b.radius * b.radius;
+	float ki = 2.0f * mj / (mi + mj) * vn;
+	float kj = 2.0f * mi / (mi + mj) * vn;
+	setVelocity(i, vxi + ki * nx, vzi + ki * nz);
+	setVelocity(j, vxj - kj * nx, vzj - kj * nz);
+	tally.bounced++;
+}
@@ -0,0 +1,105 @@
+#pragma once
+#ifndef ASTEROID_COLLIDER_H
+#define ASTEROID_COLLIDER_H
+
+#include <memory>
+#include <vector>
+
+#include "Asteroid.h"
+
+#define COLLIDER_AXIS_SWITCH 1.25f // How much more spread out the other axis has to be before sweeping along it instead
+#define COLLIDER_MIN_BAND 22.5f    // Narrowest a band can be; step() widens them to the largest asteroid's diameter
+#define COLLIDER_BANDS_PER_RUN 4   // How many bands a thread sweeps at a time
+#define COLLIDER_MIN_PER_THREAD 8192 // Fewer asteroids than this per thread aren't worth starting one for
+
+/**
+ * Bounces asteroids off each other. Elastic collisions between spheres whose masses go with the
+ * cube of their radii.
+ * The broadphase is sweep and prune along whichever of x and z the asteroids are more spread out
+ * on. The other axis is cut into bands at least an asteroid across, so an asteroid can only touch
+ * ones in its own band or the two next to it, and the asteroids are kept sorted by band and then
+ * by where they start along the sweep axis. Within and between neighbouring bands, a pair can only
+ * touch if each starts before the other ends.
+ * Everything is read from and written back to asteroidBodies, and the sorted list is kept from
+ * tick to tick by body, so a tick never touches the Asteroid objects beyond asking each for its
+ * body. Asteroids barely move in a tick, so an insertion sort puts the order right again in close
+ * to linear time. New asteroids, and ones that changed band or wrapped around, are sorted on their
+ * own and merged in.
+ * On a wrapping playfield, the ends of each band's sweep are swept against each other a playfield
+ * apart, the first and last bands are neighbours, and distances across the bands are taken the
+ * short way around.
+ * Only pairs that are moving towards each other bounce. Pairs that overlap but are already moving
+ * apart are left alone, which is what lets the two halves of a split asteroid, which start in the
+ * same place, fly apart instead of bouncing off each other.
+ */
+class AsteroidCollider
+{
+public:
+	AsteroidCollider();
+
+	// Bounces every touching pair. halfX and halfZ are half the size of the wrapping playfield,
+	// or 0 for the open world. Returns how many pairs bounced.
+	int step(std::vector<std::shared_ptr<Asteroid> > &asteroids, float halfX, float halfZ);
+
+	// What the last step() did
+	int getNumTouching() const { return numTouching; }
+	long getNumSwaps() const { return numSwaps; }
+	int getNumReinserted() const { return numReinserted; } // New, changed band or wrapped around
+	int getAxis() const { return axis; }
+
+private:
+	struct Proxy {
+		int band;        // Along the other axis
+		float lo, hi;    // Extent along the sweep axis
+		float other;     // Center on the other axis
+		float radius;
+		int body;        // In asteroidBodies
+	};
+
+	static bool sortsBefore(const Proxy &a, const Proxy &b)
+	{
+		return a.band != b.band ? a.band < b.band : a.lo < b.lo;
+	}
+
+	// What a thread's share of the sweeps found
+	struct Tally {
+		int touching = 0;
+		int bounced = 0;
+	};
+
+	void setKeys(Proxy &p) const;
+	// Each band from first up to last against itself and the next one up
+	void sweepRange(int first, int last, Tally &tally) const;
+	// Bounces the touching pairs within proxies [begin, end)
+	void sweepBand(size_t begin, size_t end, Tally &tally) const;
+	// Bounces the touching pairs with one in [aBegin, aEnd) and the other in [bBegin, bEnd), the
+	// second moved along the sweep axis by shift
+	void sweepBands(size_t aBegin, size_t aEnd, size_t bBegin, size_t bEnd, float shift, Tally &tally) const;
+	// sweepBands() between the start of one band and the end of the other, a playfield apart
+	void sweepWrap(size_t aBegin, size_t aEnd, size_t bBegin, size_t bEnd, Tally &tally) const;
+	// Whether a and b, the second moved along the sweep axis by shift, touch
+	bool touches(const Proxy &a, const Proxy &b, float shift) const;
+	// Bounces a pair that touches if it's moving together. Only writes the pair's bodies.
+	void resolve(const Proxy &a, const Proxy &b, float shift, Tally &tally) const;
+
+	int axis; // 0 for x, 1 for z
+	float halfAxis, halfOther;
+	float bandWidth;
+	float bandScale; // 1 / bandWidth
+	int numBands; // On a wrapping playfield
+	float maxRadius;
+	unsigned tick;
+	int numTouching;
+	long numSwaps;
+	int numReinserted;
+
+	std::vector<Proxy> proxies;   // Sorted by band, then lo
+	std::vector<Proxy> fresh;     // Scratch: asteroids that need sorting in from scratch
+	std::vector<Proxy> merged;    // Scratch
+	std::vector<size_t> bandStart; // Scratch: where each band present starts in proxies, and the end
+	// By body
+	std::vector<unsigned> seen;   // Last step() the body was in
+	std::vector<char> sorted;     // Whether it has a proxy
+};
+
+#endif
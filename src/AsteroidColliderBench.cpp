@@ -0,0 +1,123 @@
+#include "Benchmark.h"
+#include "AsteroidCollider.h"
+
+#include <chrono>
+#include <cmath>
+#include <iomanip>
+#include <iostream>
+#include <memory>
+#include <vector>
+
+#include "AsteroidMesh.h"
+#include "randomFunctions.h"
+
+#define COLLIDER_BENCH_TICKS 600
+#define COLLIDER_BENCH_CHECKED 2000 // Asteroids checked against all pairs
+
+// n asteroids over a wrapping playfield sized to keep about the same share of it covered
+static void makeField(int n, float half, std::vector<std::shared_ptr<Asteroid> > &asteroids)
+{
+	// Asteroids size their spheres from their model's mesh
+	static std::shared_ptr<Shape> model;
+	if(!model) {
+		AsteroidMeshData data;
+		generateAsteroidMesh(1, data);
+		model = std::make_shared<Shape>();
+		model->setMesh(data.pos[0], data.nor[0]);
+	}
+	asteroids.clear();
+	for(int i = 0; i < n; i++) {
+		std::shared_ptr<Asteroid> a = std::make_shared<Asteroid>(model);
+		a->setPos(glm::vec3(randomFloat(-half, half), 0.0f, randomFloat(-half, half)));
+		asteroids.push_back(a);
+	}
+}
+
+// Asteroid::move(), but wrapping around a playfield of any size
+static void moveAll(std::vector<std::shared_ptr<Asteroid> > &asteroids, float half)
+{
+	for(auto a = asteroids.begin(); a != asteroids.end(); ++a) {
+		(*a)->drift(1.0f);
+		glm::vec3 p = (*a)->getPos();
+		if(p.x > half) { p.x = -half; }
+		else if(p.x < -half) { p.x = half; }
+		if(p.z > half) { p.z = -half; }
+		else if(p.z < -half) { p.z = half; }
+		(*a)->setPos(p);
+	}
+}
+
+static float kineticEnergy(std::vector<std::shared_ptr<Asteroid> > &asteroids)
+{
+	double e = 0.0;
+	for(auto a = asteroids.begin(); a != asteroids.end(); ++a) {
+		float r = (*a)->getBoundingSphere().radius;
+		e += 0.5 * r * r * r * (*a)->getSpeed() * (*a)->getSpeed();
+	}
+	return (float)e;
+}
+
+// Touching pairs by testing every one, the short way around the wrapping playfield
+static int bruteForce(std::vector<std::shared_ptr<Asteroid> > &asteroids, float half)
+{
+	int touching = 0;
+	for(size_t i = 0; i < asteroids.size(); i++) {
+		BoundingSphere a = asteroids[i]->getBoundingSphere();
+		for(size_t j = i + 1; j < asteroids.size(); j++) {
+			BoundingSphere b = asteroids[j]->getBoundingSphere();
+			glm::vec3 d = b.center - a.center;
+			d.x -= 2.0f * half * std::round(d.x / (2.0f * half));
+			d.z -= 2.0f * half * std::round(d.z / (2.0f * half));
+			touching += glm::dot(d, d) < (a.radius + b.radius) * (a.radius + b.radius);
+		}
+	}
+	return touching;
+}
+
+static void benchSize(int n, float half)
+{
+	std::cout << "  -- " << n << " asteroids over " << 2.0f * half << " x " << 2.0f * half << std::endl;
+	srand(1);
+	std::vector<std::shared_ptr<Asteroid> > asteroids;
+	makeField(n, half, asteroids);
+
+	AsteroidCollider collider;
+	collider.step(asteroids, half, half); // The first step sorts from scratch
+	float e0 = kineticEnergy(asteroids);
+	long touching = 0, bounced = 0, swaps = 0, reinserted = 0;
+	double stepNs = 0.0; // Without the move
+	double ns = Benchmark::time("step", COLLIDER_BENCH_TICKS, [&](){
+		moveAll(asteroids, half);
+		std::chrono::steady_clock::time_point t0 = std::chrono::steady_clock::now();
+		bounced += collider.step(asteroids, half, half);
+		stepNs += std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - t0).count();
+		touching += collider.getNumTouching();
+		swaps += collider.getNumSwaps();
+		reinserted += collider.getNumReinserted();
+	});
+	long ticks = (COLLIDER_BENCH_TICKS / 10 + 1) + BENCH_REPEATS * COLLIDER_BENCH_TICKS;
+	std::cout << "  " << std::fixed << std::setprecision(2) << stepNs / ticks / 1e6 << " ms per tick in step() on average, " << ns / 1e6 << " at best with the move, " << std::defaultfloat << touching / ticks << " touching, "
+		<< bounced / ticks << " bounces, " << swaps / ticks << " insertion sort moves and " << reinserted / ticks << " merged in per tick" << std::endl;
+	std::cout << "  kinetic energy " << e0 << " before, " << kineticEnergy(asteroids) << " after" << std::endl;
+}
+
+BENCHMARK_SUITE(collisions)
+{
+	// About 30% of the playfield covered
+	benchSize(5000, 800.0f);
+	benchSize(50000, 2500.0f);
+
+	// The sweep finds the same touching pairs as testing every one, wraparound included
+	srand(2);
+	std::vector<std::shared_ptr<Asteroid> > asteroids;
+	makeField(COLLIDER_BENCH_CHECKED, 400.0f, asteroids);
+	AsteroidCollider collider;
+	int wrong = 0;
+	for(int t = 0; t < 100; t++) {
+		moveAll(asteroids, 400.0f);
+		int expected = bruteForce(asteroids, 400.0f);
+		collider.step(asteroids, 400.0f, 400.0f);
+		wrong += collider.getNumTouching() != expected;
+	}
+	std::cout << "  100 ticks of " << COLLIDER_BENCH_CHECKED << " asteroids checked against all pairs, " << wrong << " different" << std::endl;
+}
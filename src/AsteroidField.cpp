@@ -0,0 +1,408 @@
+#include "AsteroidField.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdlib>
+#include <random>
+
+AsteroidField::AsteroidField(unsigned seed, int perChunk, std::vector<std::shared_ptr<Shape> > &models, Pool<Asteroid> &pool)
+	: seed(seed), perChunk(perChunk), models(models), pool(pool)
+{
+	int n = 2 * CHUNK_DORMANT_RADIUS + 1;
+	chunks.reserve(2 * n * n);
+	for(int i = 0; i < CHUNK_WORKERS; i++) {
+		workers.push_back(std::thread(&AsteroidField::workerLoop, this));
+	}
+}
+
+AsteroidField::~AsteroidField()
+{
+	{
+		std::lock_guard<std::mutex> lock(jobMutex);
+		stopping = true;
+	}
+	jobReady.notify_all();
+	for(auto w = workers.begin(); w != workers.end(); ++w) {
+		w->join();
+	}
+}
+
+// Chunk (cx, cz) is centered on world position (cx, cz) * CHUNK_SIZE
+int AsteroidField::chunkX(float x) const { return (int)std::floor(x / CHUNK_SIZE + 0.5f) + originX; }
+int AsteroidField::chunkZ(float z) const { return (int)std::floor(z / CHUNK_SIZE + 0.5f) + originZ; }
+
+glm::vec3 AsteroidField::corner(const Chunk &c) const
+{
+	return glm::vec3((c.cx - originX - 0.5f) * CHUNK_SIZE, 0.0f, (c.cz - originZ - 0.5f) * CHUNK_SIZE);
+}
+
+AsteroidField::Chunk *AsteroidField::find(int cx, int cz)
+{
+	auto it = chunks.find(key(cx, cz));
+	return (it == chunks.end()) ? NULL : &it->second;
+}
+
+AsteroidField::Chunk *AsteroidField::chunkAt(const glm::vec3 &pos)
+{
+	return find(chunkX(pos.x), chunkZ(pos.z));
+}
+
+void AsteroidField::start(const glm::vec3 &shipPos, std::vector<std::shared_ptr<Asteroid> > &active)
+{
+	centerX = chunkX(shipPos.x);
+	centerZ = chunkZ(shipPos.z);
+
+	// The ship's own neighbourhood can't wait for the workers
+	for(int dz = -CHUNK_ACTIVE_RADIUS; dz <= CHUNK_ACTIVE_RADIUS; dz++) {
+		for(int dx = -CHUNK_ACTIVE_RADIUS; dx <= CHUNK_ACTIVE_RADIUS; dx++) {
+			Job job;
+			job.cx = centerX + dx;
+			job.cz = centerZ + dz;
+			generate(seed, perChunk, (int)models.size(), job);
+
+			Chunk &c = chunks[key(job.cx, job.cz)];
+			c.cx = job.cx;
+			c.cz = job.cz;
+			c.state = CHUNK_DORMANT;
+			c.dormant.swap(job.asteroids);
+		}
+	}
+
+	update(shipPos, active);
+}
+
+void AsteroidField::update(const glm::vec3 &shipPos, std::vector<std::shared_ptr<Asteroid> > &active)
+{
+	tick++;
+	bool changed = collectFinished();
+
+	int cx = chunkX(shipPos.x);
+	int cz = chunkZ(shipPos.z);
+	if(cx != centerX || cz != centerZ || tick == 1) {
+		centerX = cx;
+		centerZ = cz;
+		for(int dz = -CHUNK_DORMANT_RADIUS; dz <= CHUNK_DORMANT_RADIUS; dz++) {
+			for(int dx = -CHUNK_DORMANT_RADIUS; dx <= CHUNK_DORMANT_RADIUS; dx++) {
+				request(cx + dx, cz + dz);
+			}
+		}
+		changed = true;
+	}
+
+	bool added = false;
+	if(changed) {
+		added |= classify(active);
+	}
+	if(changed || tick % CHUNK_REBUCKET_TICKS == 0) {
+		rebucket(active);
+	}
+	added |= stepReduced(active);
+
+	// Asteroids that came in from other chunks are older than the children appended since
+	if(added) {
+		std::sort(active.begin(), active.end(), [](const std::shared_ptr<Asteroid> &a, const std::shared_ptr<Asteroid> &b){
+			return a->getID() < b->getID();
+		});
+	}
+}
+
+// Queues a chunk for generation unless it already exists
+void AsteroidField::request(int cx, int cz)
+{
+	if(find(cx, cz)) {
+		return;
+	}
+
+	Chunk &c = chunks[key(cx, cz)];
+	c.cx = cx;
+	c.cz = cz;
+	c.state = CHUNK_PENDING;
+
+	Job job;
+	job.cx = cx;
+	job.cz = cz;
+	{
+		std::lock_guard<std::mutex> lock(jobMutex);
+		jobs.push_back(std::move(job));
+	}
+	jobReady.notify_one();
+}
+
+// Turns generated chunks dormant. Returns whether there were any.
+bool AsteroidField::collectFinished()
+{
+	{
+		std::lock_guard<std::mutex> lock(jobMutex);
+		collected.swap(finished);
+	}
+	if(collected.empty()) {
+		return false;
+	}
+
+	for(auto job = collected.begin(); job != collected.end(); ++job) {
+		// The ship may have left before the chunk was ready
+		Chunk *c = find(job->cx, job->cz);
+		if(c && c->state == CHUNK_PENDING) {
+			c->dormant.swap(job->asteroids);
+			c->state = CHUNK_DORMANT;
+		}
+	}
+	collected.clear();
+	return true;
+}
+
+// Moves every chunk to the state its distance from the ship calls for. Returns whether any
+// asteroids were added to active.
+bool AsteroidField::classify(std::vector<std::shared_ptr<Asteroid> > &active)
+{
+	bool added = false;
+	for(auto it = chunks.begin(); it != chunks.end(); ) {
+		Chunk &c = it->second;
+		int d = std::max(std::abs(c.cx - centerX), std::abs(c.cz - centerZ));
+
+		if(d > CHUNK_DORMANT_RADIUS) {
+			for(auto a = c.asteroids.begin(); a != c.asteroids.end(); ++a) {
+				pool.release(*a);
+			}
+			it = chunks.erase(it);
+			continue;
+		}
+
+		if(c.state != CHUNK_PENDING) {
+			int state = CHUNK_DORMANT;
+			if(d <= CHUNK_ACTIVE_RADIUS) {
+				state = CHUNK_ACTIVE;
+			}
+			else if(d <= CHUNK_REDUCED_RADIUS) {
+				state = CHUNK_REDUCED;
+			}
+
+			if(state != c.state) {
+				added |= (state == CHUNK_ACTIVE);
+				setState(c, state, active);
+			}
+		}
+		++it;
+	}
+	return added;
+}
+
+void AsteroidField::setState(Chunk &c, int state, std::vector<std::shared_ptr<Asteroid> > &active)
+{
+	if(c.state == CHUNK_DORMANT) {
+		std::vector<std::shared_ptr<Asteroid> > &to = (state == CHUNK_ACTIVE) ? active : c.asteroids;
+		for(auto d = c.dormant.begin(); d != c.dormant.end(); ++d) {
+			to.push_back(inflate(c, *d));
+		}
+		c.dormant.clear();
+	}
+	else if(c.state == CHUNK_REDUCED) {
+		for(auto a = c.asteroids.begin(); a != c.asteroids.end(); ++a) {
+			if(state == CHUNK_ACTIVE) {
+				active.push_back(*a);
+			}
+			else {
+				c.dormant.push_back(deflate(c, **a));
+				pool.release(*a);
+			}
+		}
+		c.asteroids.clear();
+	}
+	// A chunk that stops being active gives its asteroids away in rebucket()
+
+	c.state = state;
+}
+
+// Hands active asteroids that have left the active chunks to the chunks they are now in
+void AsteroidField::rebucket(std::vector<std::shared_ptr<Asteroid> > &active)
+{
+	size_t kept = 0;
+	for(size_t i = 0; i < active.size(); i++) {
+		Chunk *c = chunkAt(active[i]->getPos());
+		if(c && c->state == CHUNK_ACTIVE) {
+			active[kept++] = std::move(active[i]);
+		}
+		else {
+			place(active[i], active);
+		}
+	}
+	active.resize(kept);
+}
+
+// Moves each reduced-rate chunk once every CHUNK_REDUCED_RATE ticks, spread across the ticks.
+// Returns whether any asteroids were added to active.
+bool AsteroidField::stepReduced(std::vector<std::shared_ptr<Asteroid> > &active)
+{
+	for(auto it = chunks.begin(); it != chunks.end(); ++it) {
+		Chunk &c = it->second;
+		if(c.state != CHUNK_REDUCED || (unsigned)(c.cx * 3 + c.cz + tick) % CHUNK_REDUCED_RATE != 0) {
+			continue;
+		}
+
+		size_t kept = 0;
+		for(size_t i = 0; i < c.asteroids.size(); i++) {
+			std::shared_ptr<Asteroid> &a = c.asteroids[i];
+			a->drift((float)CHUNK_REDUCED_RATE);
+			if(chunkAt(a->getPos()) == &c) {
+				c.asteroids[kept++] = std::move(a);
+			}
+			else {
+				drifted.push_back(std::move(a));
+			}
+		}
+		c.asteroids.resize(kept);
+	}
+
+	// Placed afterwards so nothing moves twice in one tick
+	bool added = false;
+	for(auto a = drifted.begin(); a != drifted.end(); ++a) {
+		added |= place(*a, active);
+	}
+	drifted.clear();
+	return added;
+}
+
+// Gives an asteroid to the chunk it is in. Asteroids that drift into space that hasn't been
+// generated yet are dropped, since the chunk will have its own. Returns whether it went to active.
+bool AsteroidField::place(std::shared_ptr<Asteroid> &a, std::vector<std::shared_ptr<Asteroid> > &active)
+{
+	Chunk *c = chunkAt(a->getPos());
+	if(!c || c->state == CHUNK_PENDING) {
+		pool.release(a);
+	}
+	else if(c->state == CHUNK_ACTIVE) {
+		active.push_back(a);
+		return true;
+	}
+	else if(c->state == CHUNK_REDUCED) {
+		c->asteroids.push_back(a);
+	}
+	else {
+		c->dormant.push_back(deflate(*c, *a));
+		pool.release(a);
+	}
+	return false;
+}
+
+glm::vec3 AsteroidField::rebase(const glm::vec3 &shipPos, std::vector<std::shared_ptr<Asteroid> > &active)
+{
+	if(std::abs(shipPos.x) < REBASE_DISTANCE && std::abs(shipPos.z) < REBASE_DISTANCE) {
+		return glm::vec3(0.0f);
+	}
+
+	// Whole chunks, so the chunk grid stays put
+	int dx = (int)std::floor(shipPos.x / CHUNK_SIZE + 0.5f);
+	int dz = (int)std::floor(shipPos.z / CHUNK_SIZE + 0.5f);
+	originX += dx;
+	originZ += dz;
+	glm::vec3 shift(-dx * CHUNK_SIZE, 0.0f, -dz * CHUNK_SIZE);
+
+	// Dormant asteroids are stored relative to their chunk and don't need to move
+	for(auto a = active.begin(); a != active.end(); ++a) {
+		(*a)->setPos((*a)->getPos() + shift);
+	}
+	for(auto it = chunks.begin(); it != chunks.end(); ++it) {
+		for(auto a = it->second.asteroids.begin(); a != it->second.asteroids.end(); ++a) {
+			(*a)->setPos((*a)->getPos() + shift);
+		}
+	}
+
+	return shift;
+}
+
+void AsteroidField::getInstances(std::vector<AsteroidInstance> &out)
+{
+	for(auto it = chunks.begin(); it != chunks.end(); ++it) {
+		for(auto a = it->second.asteroids.begin(); a != it->second.asteroids.end(); ++a) {
+			out.push_back(AsteroidInstance());
+			(*a)->getInstance(out.back());
+		}
+	}
+}
+
+std::shared_ptr<Asteroid> AsteroidField::inflate(const Chunk &c, const DormantAsteroid &d)
+{
+	std::shared_ptr<Shape> &model = models.at(d.model);
+	std::shared_ptr<Asteroid> a = pool.acquire();
+	if(a) {
+		a->reset(model);
+	}
+	else {
+		a = std::make_shared<Asteroid>(model);
+	}
+
+	a->setPos(corner(c) + glm::vec3(d.x, 0.0f, d.z));
+	a->setDir(glm::vec3(std::sin(d.heading), 0.0f, std::cos(d.heading)));
+	a->setSpeed(d.speed);
+	a->setSize(d.size);
+	a->setColor(glm::vec3(d.color[0], d.color[1], d.color[2]) / 255.0f);
+	return a;
+}
+
+DormantAsteroid AsteroidField::deflate(const Chunk &c, Asteroid &a)
+{
+	DormantAsteroid d;
+	glm::vec3 p = a.getPos() - corner(c);
+	glm::vec3 dir = a.getDir();
+	glm::vec3 col = a.getColor();
+
+	d.x = p.x;
+	d.z = p.z;
+	d.heading = std::atan2(dir.x, dir.z);
+	d.speed = a.getSpeed();
+	d.size = a.getSize();
+	for(int i = 0; i < 3; i++) {
+		d.color[i] = (unsigned char)glm::clamp(col[i] * 255.0f + 0.5f, 0.0f, 255.0f);
+	}
+
+	d.model = 0;
+	for(size_t i = 0; i < models.size(); i++) {
+		if(models[i] == a.model) {
+			d.model = (uint16_t)i;
+		}
+	}
+	return d;
+}
+
+// The same chunk always comes out the same for the same seed, whichever thread makes it
+void AsteroidField::generate(unsigned seed, int perChunk, int numModels, Job &job)
+{
+	std::mt19937 rng(seed * 0x9E3779B1u ^ (unsigned)job.cx * 0x85EBCA77u ^ (unsigned)job.cz * 0xC2B2AE3Du);
+	std::uniform_real_distribution<float> unit(0.0f, 1.0f);
+
+	job.asteroids.resize(perChunk);
+	for(int i = 0; i < perChunk; i++) {
+		DormantAsteroid &d = job.asteroids[i];
+		d.x = unit(rng) * CHUNK_SIZE;
+		d.z = unit(rng) * CHUNK_SIZE;
+		d.heading = unit(rng) * 2.0f * (float)M_PI;
+		d.speed = MIN_ASTEROID_SPEED + unit(rng) * (MAX_ASTEROID_SPEED - MIN_ASTEROID_SPEED);
+		d.size = MIN_ASTEROID_SIZE + unit(rng) * (MAX_ASTEROID_SIZE - MIN_ASTEROID_SIZE);
+		for(int c = 0; c < 3; c++) {
+			d.color[c] = (unsigned char)(255.0f * (0.1f + 0.9f * unit(rng)));
+		}
+		d.model = (uint16_t)(rng() % numModels);
+	}
+}
+
+void AsteroidField::workerLoop()
+{
+	int numModels = (int)models.size();
+	for(;;) {
+		Job job;
+		{
+			std::unique_lock<std::mutex> lock(jobMutex);
+			jobReady.wait(lock, [this](){ return stopping || !jobs.empty(); });
+			if(stopping) {
+				return;
+			}
+			job = std::move(jobs.front());
+			jobs.pop_front();
+		}
+
+		generate(seed, perChunk, numModels, job);
+
+		std::lock_guard<std::mutex> lock(jobMutex);
+		finished.push_back(std::move(job));
+	}
+}
@@ -0,0 +1,142 @@
+#pragma once
+#ifndef ASTEROID_FIELD_H
+#define ASTEROID_FIELD_H
+
+#include "Asteroid.h"
+#include "Pool.h"
+#include "Shape.h"
+#include "WorldSnapshot.h"
+
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+#define GLM_FORCE_RADIANS
+#include <glm/glm.hpp>
+
+// Each chunk is as big as the classic wrapping field, and holds as many asteroids as it did
+#define CHUNK_SIZE (2.0f * MAX_X)
+// Chunks within this many chunks of the ship's are simulated every tick, collide and are shot at
+#define CHUNK_ACTIVE_RADIUS 1
+// Out to this radius chunks only move every CHUNK_REDUCED_RATE ticks (and are still drawn)
+#define CHUNK_REDUCED_RADIUS 2
+#define CHUNK_REDUCED_RATE 4
+// Out to this radius chunks are kept frozen in compact form. Beyond it they are forgotten and
+// regenerate from the seed if the ship comes back.
+#define CHUNK_DORMANT_RADIUS 4
+// How often active asteroids are checked for having drifted out of the active chunks
+#define CHUNK_REBUCKET_TICKS 15
+#define CHUNK_WORKERS 2
+// The ship may get this far from the origin before the whole world is shifted back
+#define REBASE_DISTANCE CHUNK_SIZE
+
+enum CHUNK_STATES{
+	CHUNK_PENDING, // Being generated on a worker thread
+	CHUNK_DORMANT,
+	CHUNK_REDUCED,
+	CHUNK_ACTIVE
+};
+
+// An asteroid in a chunk far from the ship, stored compactly until the ship comes back
+struct DormantAsteroid {
+	float x, z;     // Relative to the chunk's corner
+	float heading;  // Direction of travel, in radians about the y axis
+	float speed;
+	float size;
+	unsigned char color[3];
+	uint16_t model; // Index into the models, of which --procedural can make more than 256
+};
+
+/**
+ * The --open-world asteroid field. Space is split into square chunks that are generated from a
+ * seed on worker threads as the ship approaches, simulated at full rate only next to it, at a
+ * reduced rate a little further out, and frozen or forgotten beyond that. Memory and CPU follow
+ * the neighbourhood of the ship, not the size of the field.
+ *
+ * The asteroids in active chunks live in the game's usual asteroids vector, so collisions,
+ * shooting and splitting work as they do in the wrapping field. To keep float precision the
+ * world's origin follows the ship in whole chunks (see rebase()).
+ */
+class AsteroidField
+{
+public:
+	AsteroidField(unsigned seed, int perChunk, std::vector<std::shared_ptr<Shape> > &models, Pool<Asteroid> &pool);
+	~AsteroidField();
+
+	// Generates the chunks around the ship right away and fills active with their asteroids
+	void start(const glm::vec3 &shipPos, std::vector<std::shared_ptr<Asteroid> > &active);
+	// Once per tick, after the active asteroids have moved. Streams chunks in and out around
+	// the ship and steps the reduced-rate ones. Keeps active sorted by id.
+	void update(const glm::vec3 &shipPos, std::vector<std::shared_ptr<Asteroid> > &active);
+	// Shifts the field back to the origin once the ship is REBASE_DISTANCE away from it, and
+	// returns the shift. Everything else in world space (the ship, beams, ...) has to move by it too.
+	glm::vec3 rebase(const glm::vec3 &shipPos, std::vector<std::shared_ptr<Asteroid> > &active);
+
+	// Appends the reduced-rate asteroids, which are drawn but not collided with
+	void getInstances(std::vector<AsteroidInstance> &out);
+
+	// World position of the local origin
+	double getOriginX() const { return originX * (double)CHUNK_SIZE; }
+	double getOriginZ() const { return originZ * (double)CHUNK_SIZE; }
+	int getNumChunks() const { return (int)chunks.size(); }
+
+private:
+	struct Chunk {
+		int cx, cz;
+		int state;
+		std::vector<DormantAsteroid> dormant; // Dormant chunks
+		std::vector<std::shared_ptr<Asteroid> > asteroids; // Reduced-rate chunks
+	};
+
+	struct Job {
+		int cx, cz;
+		std::vector<DormantAsteroid> asteroids; // Filled in by the worker
+	};
+
+	static long long key(int cx, int cz) { return ((long long)cx << 32) | (unsigned)cz; }
+	int chunkX(float x) const;
+	int chunkZ(float z) const;
+	glm::vec3 corner(const Chunk &c) const;
+	Chunk *find(int cx, int cz);
+	Chunk *chunkAt(const glm::vec3 &pos);
+
+	void request(int cx, int cz);
+	bool collectFinished();
+	bool classify(std::vector<std::shared_ptr<Asteroid> > &active);
+	void setState(Chunk &c, int state, std::vector<std::shared_ptr<Asteroid> > &active);
+	void rebucket(std::vector<std::shared_ptr<Asteroid> > &active);
+	bool stepReduced(std::vector<std::shared_ptr<Asteroid> > &active);
+	bool place(std::shared_ptr<Asteroid> &a, std::vector<std::shared_ptr<Asteroid> > &active);
+
+	std::shared_ptr<Asteroid> inflate(const Chunk &c, const DormantAsteroid &d);
+	DormantAsteroid deflate(const Chunk &c, Asteroid &a);
+	static void generate(unsigned seed, int perChunk, int numModels, Job &job);
+	void workerLoop();
+
+	unsigned seed;
+	int perChunk;
+	std::vector<std::shared_ptr<Shape> > &models;
+	Pool<Asteroid> &pool;
+
+	std::unordered_map<long long, Chunk> chunks;
+	int originX = 0, originZ = 0; // The chunk the local origin is the center of
+	int centerX = 0, centerZ = 0; // The chunk the ship is in
+	unsigned long tick = 0;
+	std::vector<std::shared_ptr<Asteroid> > drifted; // Reused by stepReduced()
+
+	// Generation jobs for the workers, and the ones they've finished
+	std::vector<std::thread> workers;
+	std::mutex jobMutex;
+	std::condition_variable jobReady;
+	std::deque<Job> jobs;
+	std::vector<Job> finished;
+	std::vector<Job> collected; // Swapped with finished, so the lock is held briefly
+	bool stopping = false;
+};
+
+#endif
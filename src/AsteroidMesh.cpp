@@ -0,0 +1,377 @@
+#include "AsteroidMesh.h"
+
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <cstdint>
+#include <filesystem>
+#include <fstream>
+#include <map>
+#include <random>
+#include <thread>
+#include <utility>
+
+#define GLM_FORCE_RADIANS
+#include <glm/glm.hpp>
+
+namespace {
+
+	struct Crater {
+		glm::vec3 center; // On the unit sphere
+		float radius;     // Chord length from the center to the rim
+		float depth;
+		float rim;
+	};
+
+	struct Surface {
+		unsigned seed;
+		std::vector<Crater> craters;
+	};
+
+	// Hashes an integer lattice point to [-1, 1]
+	float lattice(unsigned seed, int x, int y, int z)
+	{
+		uint32_t h = seed;
+		h ^= (uint32_t)x * 0x8DA6B343u;
+		h ^= (uint32_t)y * 0xD8163841u;
+		h ^= (uint32_t)z * 0xCB1AB31Fu;
+		h ^= h >> 13;
+		h *= 0x5BD1E995u;
+		h ^= h >> 15;
+		return (h & 0xFFFFFF) / (float)0x7FFFFF - 1.0f;
+	}
+
+	float smooth(float t) { return t * t * (3.0f - 2.0f * t); }
+
+	// Trilinear value noise, roughly in [-1, 1]
+	float valueNoise(unsigned seed, const glm::vec3 &p)
+	{
+		int x = (int)std::floor(p.x), y = (int)std::floor(p.y), z = (int)std::floor(p.z);
+		float fx = smooth(p.x - x), fy = smooth(p.y - y), fz = smooth(p.z - z);
+
+		float c[2][2];
+		for(int dz = 0; dz < 2; dz++) {
+			for(int dy = 0; dy < 2; dy++) {
+				float a = lattice(seed, x, y + dy, z + dz);
+				float b = lattice(seed, x + 1, y + dy, z + dz);
+				c[dz][dy] = a + (b - a) * fx;
+			}
+		}
+		float c0 = c[0][0] + (c[0][1] - c[0][0]) * fy;
+		float c1 = c[1][0] + (c[1][1] - c[1][0]) * fy;
+		return c0 + (c1 - c0) * fz;
+	}
+
+	float fbm(unsigned seed, glm::vec3 p)
+	{
+		float sum = 0.0f, amplitude = 0.5f;
+		for(int i = 0; i < ASTEROID_NOISE_OCTAVES; i++) {
+			sum += amplitude * valueNoise(seed + i, p);
+			p *= 2.0f;
+			amplitude *= 0.5f;
+		}
+		return sum;
+	}
+
+	// A bowl inside the crater's radius, with a raised rim that fades out just past it
+	float crater(const Crater &c, const glm::vec3 &dir)
+	{
+		float t = glm::length(dir - c.center) / c.radius;
+		if(t < 1.0f) {
+			return c.depth * (t * t - 1.0f) + c.rim;
+		}
+		if(t < 1.3f) {
+			return c.rim * (1.0f - smooth((t - 1.0f) / 0.3f));
+		}
+		return 0.0f;
+	}
+
+	// Radius of the surface in the direction dir, relative to ASTEROID_MESH_RADIUS
+	float surfaceRadius(const Surface &s, const glm::vec3 &dir)
+	{
+		float r = 1.0f + ASTEROID_NOISE_AMPLITUDE * fbm(s.seed, dir * ASTEROID_NOISE_FREQUENCY);
+		for(auto c = s.craters.begin(); c != s.craters.end(); ++c) {
+			r += crater(*c, dir);
+		}
+		return r;
+	}
+
+	struct Icosphere {
+		std::vector<glm::vec3> verts; // Unit directions
+		std::vector<int> tris;
+
+		Icosphere()
+		{
+			const float t = (1.0f + std::sqrt(5.0f)) / 2.0f;
+			const float v[12][3] = {
+				{-1, t, 0}, {1, t, 0}, {-1, -t, 0}, {1, -t, 0},
+				{0, -1, t}, {0, 1, t}, {0, -1, -t}, {0, 1, -t},
+				{t, 0, -1}, {t, 0, 1}, {-t, 0, -1}, {-t, 0, 1}
+			};
+			const int f[20][3] = {
+				{0, 11, 5}, {0, 5, 1}, {0, 1, 7}, {0, 7, 10}, {0, 10, 11},
+				{1, 5, 9}, {5, 11, 4}, {11, 10, 2}, {10, 7, 6}, {7, 1, 8},
+				{3, 9, 4}, {3, 4, 2}, {3, 2, 6}, {3, 6, 8}, {3, 8, 9},
+				{4, 9, 5}, {2, 4, 11}, {6, 2, 10}, {8, 6, 7}, {9, 8, 1}
+			};
+			for(int i = 0; i < 12; i++) {
+				verts.push_back(glm::normalize(glm::vec3(v[i][0], v[i][1], v[i][2])));
+			}
+			for(int i = 0; i < 20; i++) {
+				tris.insert(tris.end(), f[i], f[i] + 3);
+			}
+		}
+
+		// Splits every triangle in four, sharing the new edge midpoints between neighbours
+		void subdivide()
+		{
+			std::map<std::pair<int, int>, int> midpoints;
+			auto midpoint = [&](int a, int b){
+				std::pair<int, int> key(std::min(a, b), std::max(a, b));
+				auto it = midpoints.find(key);
+				if(it != midpoints.end()) {
+					return it->second;
+				}
+				verts.push_back(glm::normalize(verts[a] + verts[b]));
+				int m = (int)verts.size() - 1;
+				midpoints[key] = m;
+				return m;
+			};
+
+			std::vector<int> next;
+			next.reserve(4 * tris.size());
+			for(size_t i = 0; i < tris.size(); i += 3) {
+				int a = tris[i], b = tris[i + 1], c = tris[i + 2];
+				int ab = midpoint(a, b), bc = midpoint(b, c), ca = midpoint(c, a);
+				int t[12] = { a, ab, ca, b, bc, ab, c, ca, bc, ab, bc, ca };
+				next.insert(next.end(), t, t + 12);
+			}
+			tris.swap(next);
+		}
+	};
+
+	// Displaces the sphere onto the surface and expands it into a triangle list with smooth normals
+	void buildLOD(const Surface &s, const Icosphere &sphere, std::vector<float> &pos, std::vector<float> &nor)
+	{
+		std::vector<glm::vec3> p(sphere.verts.size());
+		for(size_t i = 0; i < p.size(); i++) {
+			p[i] = sphere.verts[i] * (ASTEROID_MESH_RADIUS * surfaceRadius(s, sphere.verts[i]));
+		}
+
+		std::vector<glm::vec3> n(p.size(), glm::vec3(0.0f));
+		for(size_t i = 0; i < sphere.tris.size(); i += 3) {
+			int a = sphere.tris[i], b = sphere.tris[i + 1], c = sphere.tris[i + 2];
+			glm::vec3 fn = glm::cross(p[b] - p[a], p[c] - p[a]); // Area weighted
+			n[a] += fn;
+			n[b] += fn;
+			n[c] += fn;
+		}
+
+		pos.clear();
+		nor.clear();
+		pos.reserve(3 * sphere.tris.size());
+		nor.reserve(3 * sphere.tris.size());
+		for(size_t i = 0; i < sphere.tris.size(); i++) {
+			int v = sphere.tris[i];
+			glm::vec3 vn = glm::normalize(n[v]);
+			pos.push_back(p[v].x);
+			pos.push_back(p[v].y);
+			pos.push_back(p[v].z + ASTEROID_MESH_CENTER_Z);
+			nor.push_back(vn.x);
+			nor.push_back(vn.y);
+			nor.push_back(vn.z);
+		}
+	}
+
+	// Floats in each of a LOD's buffers: three per vertex, three vertices per triangle, and the
+	// icosahedron's 20 triangles split in four once per subdivision
+	uint32_t lodFloats(int lod)
+	{
+		return 9u * 20u << (2 * (ASTEROID_SUBDIVISIONS - lod));
+	}
+
+	// FNV-1a over the parameters a mesh is generated with, so that changing any of them misses the
+	// cache rather than serving stale meshes. Changes to the generator itself bump
+	// ASTEROID_CACHE_VERSION instead.
+	uint32_t parameterHash()
+	{
+		const float params[] = {
+			(float)ASTEROID_LODS, (float)ASTEROID_SUBDIVISIONS,
+			ASTEROID_MESH_RADIUS, ASTEROID_MESH_CENTER_Z,
+			ASTEROID_NOISE_AMPLITUDE, ASTEROID_NOISE_FREQUENCY, (float)ASTEROID_NOISE_OCTAVES,
+			(float)ASTEROID_MIN_CRATERS, (float)ASTEROID_MAX_CRATERS
+		};
+		uint32_t h = 2166136261u;
+		const unsigned char *b = (const unsigned char *)params;
+		for(size_t i = 0; i < sizeof(params); i++) {
+			h = (h ^ b[i]) * 16777619u;
+		}
+		return h;
+	}
+
+	unsigned variantSeed(unsigned seed, int variant)
+	{
+		uint32_t h = seed * 0x9E3779B1u + (uint32_t)variant * 0x85EBCA77u;
+		return h ^ (h >> 16);
+	}
+
+}
+
+void generateAsteroidMesh(unsigned seed, AsteroidMeshData &out)
+{
+	std::mt19937 rng(seed);
+	std::uniform_real_distribution<float> unit(0.0f, 1.0f);
+
+	Surface s;
+	s.seed = seed;
+	int numCraters = ASTEROID_MIN_CRATERS + (int)(rng() % (ASTEROID_MAX_CRATERS - ASTEROID_MIN_CRATERS + 1));
+	for(int i = 0; i < numCraters; i++) {
+		Crater c;
+		// Uniform on the sphere
+		float z = 2.0f * unit(rng) - 1.0f;
+		float a = 2.0f * (float)M_PI * unit(rng);
+		float r = std::sqrt(1.0f - z * z);
+		c.center = glm::vec3(r * std::cos(a), r * std::sin(a), z);
+		c.radius = 0.15f + 0.3f * unit(rng);
+		c.depth = c.radius * (0.15f + 0.2f * unit(rng));
+		c.rim = 0.25f * c.depth;
+		s.craters.push_back(c);
+	}
+
+	// Subdivide down to LOD 0, building each coarser level on the way
+	Icosphere sphere;
+	for(int i = 0; i < ASTEROID_SUBDIVISIONS - (ASTEROID_LODS - 1); i++) {
+		sphere.subdivide();
+	}
+	for(int lod = ASTEROID_LODS - 1; lod >= 0; lod--) {
+		buildLOD(s, sphere, out.pos[lod], out.nor[lod]);
+		if(lod > 0) {
+			sphere.subdivide();
+		}
+	}
+}
+
+int generateAsteroidMeshes(unsigned seed, int n, std::vector<AsteroidMeshData> &out)
+{
+	out.clear();
+	out.resize(n);
+
+	std::error_code err;
+	std::filesystem::create_directories(ASTEROID_CACHE_DIR, err);
+
+	std::atomic<int> next(0);
+	std::atomic<int> cached(0);
+	auto work = [&](){
+		for(int i = next++; i < n; i = next++) {
+			unsigned s = variantSeed(seed, i);
+			std::string path = std::string(ASTEROID_CACHE_DIR) + "asteroid-" + std::to_string(seed) + "-" + std::to_string(i) + ".mesh";
+			if(readAsteroidMesh(path, s, out[i])) {
+				cached++;
+				continue;
+			}
+			generateAsteroidMesh(s, out[i]);
+			writeAsteroidMesh(path, s, out[i]);
+		}
+	};
+
+	// This thread works too
+	int numThreads = std::min(n, std::max(1, (int)std::thread::hardware_concurrency()));
+	std::vector<std::thread> threads;
+	for(int i = 1; i < numThreads; i++) {
+		threads.push_back(std::thread(work));
+	}
+	work();
+	for(auto t = threads.begin(); t != threads.end(); ++t) {
+		t->join();
+	}
+
+	return cached;
+}
+
+// Layout: magic, version, seed, number of LODs, hash of the generation parameters, then for each
+// LOD the number of floats and the positions and normals
+bool readAsteroidMesh(const std::string &path, unsigned seed, AsteroidMeshData &out)
+{
+	// Whatever was read so far is no use if the rest isn't there
+	auto fail = [&out](){
+		for(int lod = 0; lod < ASTEROID_LODS; lod++) {
+			out.pos[lod].clear();
+			out.nor[lod].clear();
+		}
+		return false;
+	};
+
+	std::ifstream in(path, std::ios::binary);
+	if(!in) {
+		return false;
+	}
+
+	uint32_t header[5];
+	in.read((char *)header, sizeof(header));
+	if(!in || header[0] != ASTEROID_CACHE_MAGIC || header[1] != ASTEROID_CACHE_VERSION || header[2] != seed || header[3] != ASTEROID_LODS || header[4] != parameterHash()) {
+		return false;
+	}
+
+	for(int lod = 0; lod < ASTEROID_LODS; lod++) {
+		uint32_t count = 0;
+		in.read((char *)&count, sizeof(count));
+		// Checked before sizing anything by it, so a corrupt count can't ask for a huge buffer
+		if(!in || count != lodFloats(lod)) {
+			return fail();
+		}
+		out.pos[lod].resize(count);
+		out.nor[lod].resize(count);
+		in.read((char *)out.pos[lod].data(), count * sizeof(float));
+		in.read((char *)out.nor[lod].data(), count * sizeof(float));
+		if(!in) {
+			return fail();
+		}
+	}
+	return true;
+}
+
+bool writeAsteroidMesh(const std::string &path, unsigned seed, const AsteroidMeshData &data)
+{
+	std::ofstream out(path, std::ios::binary | std::ios::trunc);
+	if(!out) {
+		return false;
+	}
+
+	uint32_t header[5] = { ASTEROID_CACHE_MAGIC, ASTEROID_CACHE_VERSION, seed, ASTEROID_LODS, parameterHash() };
+	out.write((const char *)header, sizeof(header));
+	for(int lod = 0; lod < ASTEROID_LODS; lod++) {
+		uint32_t count = (uint32_t)data.pos[lod].size();
+		out.write((const char *)&count, sizeof(count));
+		out.write((const char *)data.pos[lod].data(), count * sizeof(float));
+		out.write((const char *)data.nor[lod].data(), count * sizeof(float));
+	}
+	return (bool)out;
+}
+
+void AsteroidModel::setMeshData(AsteroidMeshData &data)
+{
+	setMesh(data.pos[0], data.nor[0]);
+	for(int lod = 1; lod < ASTEROID_LODS; lod++) {
+		lods[lod - 1] = std::make_shared<Shape>();
+		lods[lod - 1]->setMesh(data.pos[lod], data.nor[lod]);
+	}
+}
+
+void AsteroidModel::init()
+{
+	Shape::init();
+	for(int i = 0; i < ASTEROID_LODS - 1; i++) {
+		lods[i]->init();
+	}
+}
+
+const Shape *AsteroidModel::getLOD(float distance) const
+{
+	if(distance > ASTEROID_LOD2_DISTANCE && ASTEROID_LODS > 2) {
+		return lods[1].get();
+	}
+	if(distance > ASTEROID_LOD1_DISTANCE) {
+		return lods[0].get();
+	}
+	return this;
+}
@@ -0,0 +1,70 @@
+#pragma once
+#ifndef ASTEROID_MESH_H
+#define ASTEROID_MESH_H
+
+#include "Shape.h"
+
+#include <memory>
+#include <string>
+#include <vector>
+
+// Levels of detail per variant. LOD 0 is the icosahedron subdivided ASTEROID_SUBDIVISIONS
+// times, and each further level is subdivided once less.
+#define ASTEROID_LODS 3
+#define ASTEROID_SUBDIVISIONS 4
+// Distances from the ship past which LOD 1 and LOD 2 are drawn
+#define ASTEROID_LOD1_DISTANCE 60.0f
+#define ASTEROID_LOD2_DISTANCE 150.0f
+
+// The same size and offset as asteroid1.obj, so both kinds of asteroid come out the same size
+#define ASTEROID_MESH_RADIUS 690.0f
+#define ASTEROID_MESH_CENTER_Z 700.0f
+
+#define ASTEROID_NOISE_AMPLITUDE 0.18f
+#define ASTEROID_NOISE_FREQUENCY 1.6f
+#define ASTEROID_NOISE_OCTAVES 4
+#define ASTEROID_MIN_CRATERS 4
+#define ASTEROID_MAX_CRATERS 9
+
+// Generated variants are cached here, relative to the working directory
+#define ASTEROID_CACHE_DIR "asteroid-cache/"
+#define ASTEROID_CACHE_MAGIC 0x48534D41u // "AMSH"
+#define ASTEROID_CACHE_VERSION 2
+
+// One variant's triangles at every level of detail, laid out like Shape's buffers
+struct AsteroidMeshData {
+	std::vector<float> pos[ASTEROID_LODS];
+	std::vector<float> nor[ASTEROID_LODS];
+};
+
+/**
+ * Builds n asteroid variants from seed: noise-displaced icospheres with craters stamped in.
+ * The variants are built in parallel on up to one thread per core. Each one is first looked
+ * up in ASTEROID_CACHE_DIR and written there after it is built. Returns how many were cached.
+ */
+int generateAsteroidMeshes(unsigned seed, int n, std::vector<AsteroidMeshData> &out);
+
+// Builds a single variant. The same seed always gives the same mesh.
+void generateAsteroidMesh(unsigned seed, AsteroidMeshData &out);
+
+bool readAsteroidMesh(const std::string &path, unsigned seed, AsteroidMeshData &out);
+bool writeAsteroidMesh(const std::string &path, unsigned seed, const AsteroidMeshData &out);
+
+// A generated variant. It draws as LOD 0 and hands out its coarser levels by distance.
+class AsteroidModel : public Shape
+{
+public:
+	AsteroidModel() {}
+	virtual ~AsteroidModel() {}
+
+	// Takes the data's buffers
+	void setMeshData(AsteroidMeshData &data);
+	// Sends every level to the GPU
+	void init();
+	virtual const Shape *getLOD(float distance) const;
+
+private:
+	std::shared_ptr<Shape> lods[ASTEROID_LODS - 1]; // LOD 1 onwards
+};
+
+#endif
@@ -0,0 +1,50 @@
+#include "Benchmark.h"
+
+#include <iomanip>
+#include <iostream>
+#include <utility>
+#include <vector>
+
+namespace Benchmark {
+
+	// Function-local so it exists before any file's static registration runs
+	static std::vector<std::pair<std::string, Suite> > &suites()
+	{
+		static std::vector<std::pair<std::string, Suite> > s;
+		return s;
+	}
+
+	bool registerSuite(const char *name, Suite suite)
+	{
+		suites().push_back(std::make_pair(std::string(name), suite));
+		return true;
+	}
+
+	bool run(const std::string &name)
+	{
+		bool found = false;
+		for(auto s = suites().begin(); s != suites().end(); ++s) {
+			if(name == "all" || name == s->first) {
+				std::cout << "== " << s->first << " ==" << std::endl;
+				s->second();
+				found = true;
+			}
+		}
+		return found;
+	}
+
+	void list(std::ostream &out)
+	{
+		for(auto s = suites().begin(); s != suites().end(); ++s) {
+			out << s->first << " ";
+		}
+		out << "all" << std::endl;
+	}
+
+	void report(const char *label, double nsPerIteration)
+	{
+		std::cout << "  " << std::left << std::setw(40) << label << std::right << std::fixed << std::setprecision(1)
+			<< std::setw(12) << nsPerIteration << " ns/iter" << std::defaultfloat << std::endl;
+	}
+
+}
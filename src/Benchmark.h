@@ -0,0 +1,73 @@
+#pragma once
+#ifndef BENCHMARK_H
+#define BENCHMARK_H
+
+#include <algorithm>
+#include <chrono>
+#include <ostream>
+#include <string>
+
+#define BENCH_REPEATS 5
+
+/**
+ * A small micro-benchmark harness, run with `--bench NAME` (or `--bench all`) instead of the game.
+ * Suites register themselves with BENCHMARK_SUITE in whichever file they test, and time their
+ * cases with Benchmark::time(). No window or GL context exists while they run.
+ */
+namespace Benchmark {
+
+	typedef void (*Suite)();
+
+	bool registerSuite(const char *name, Suite suite);
+	// Runs one suite, or all of them for "all". Returns false if there is no such suite.
+	bool run(const std::string &name);
+	void list(std::ostream &out);
+
+	// Prints one result line
+	void report(const char *label, double nsPerIteration);
+
+	// Runs op `iterations` times after a warm-up, best of BENCH_REPEATS.
+	// Prints and returns the nanoseconds per iteration. A template so op can be inlined.
+	template <typename Op>
+	double time(const char *label, int iterations, Op op)
+	{
+		typedef std::chrono::steady_clock Clock;
+
+		for(int i = 0; i < iterations / 10 + 1; i++) {
+			op();
+		}
+
+		double best = 1e30;
+		for(int r = 0; r < BENCH_REPEATS; r++) {
+			Clock::time_point t0 = Clock::now();
+			for(int i = 0; i < iterations; i++) {
+				op();
+			}
+			best = std::min(best, std::chrono::duration<double, std::nano>(Clock::now() - t0).count() / iterations);
+		}
+
+		report(label, best);
+		return best;
+	}
+
+	// Keeps the compiler from optimizing away a result that is otherwise unused
+	template <typename T>
+	inline void keep(const T &v)
+	{
+#if defined(__GNUC__) || defined(__clang__)
+		asm volatile("" : : "r"(&v) : "memory");
+#else
+		static const void *volatile sink;
+		sink = &v;
+#endif
+	}
+
+}
+
+// Defines a suite and registers it before main() runs
+#define BENCHMARK_SUITE(name) \
+	static void bench_##name(); \
+	static bool bench_##name##_registered = Benchmark::registerSuite(#name, bench_##name); \
+	static void bench_##name()
+
+#endif
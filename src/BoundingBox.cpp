@@ -0,0 +1,163 @@
+#include "BoundingBox.h"
+
+#include <algorithm>
+#include <cmath>
+
+#include <Eigen/Dense>
+
+AABB::AABB() :
+	lo(0.0f),
+	hi(0.0f)
+{
+}
+
+AABB::AABB(const glm::vec3 &lo, const glm::vec3 &hi) :
+	lo(lo),
+	hi(hi)
+{
+}
+
+bool AABB::overlaps(const AABB &other) const
+{
+	return lo.x <= other.hi.x && other.lo.x <= hi.x &&
+		lo.y <= other.hi.y && other.lo.y <= hi.y &&
+		lo.z <= other.hi.z && other.lo.z <= hi.z;
+}
+
+AABB AABB::enclosing(const std::vector<glm::vec3> &points)
+{
+	if(points.empty()) {
+		return AABB();
+	}
+	AABB box(points[0], points[0]);
+	for(auto p = points.begin(); p != points.end(); ++p) {
+		box.lo = glm::min(box.lo, *p);
+		box.hi = glm::max(box.hi, *p);
+	}
+	return box;
+}
+
+OBB::OBB() :
+	center(0.0f),
+	halfExtents(0.0f)
+{
+	axes[0] = glm::vec3(1.0f, 0.0f, 0.0f);
+	axes[1] = glm::vec3(0.0f, 1.0f, 0.0f);
+	axes[2] = glm::vec3(0.0f, 0.0f, 1.0f);
+}
+
+OBB OBB::transformed(const glm::mat4 &M) const
+{
+	OBB box;
+	box.center = glm::vec3(M * glm::vec4(center, 1.0f));
+	for(int i = 0; i < 3; i++) {
+		glm::vec3 a = glm::vec3(M * glm::vec4(axes[i], 0.0f));
+		float scale = glm::length(a);
+		box.axes[i] = scale > 0.0f ? a / scale : axes[i];
+		box.halfExtents[i] = halfExtents[i] * scale;
+	}
+	return box;
+}
+
+AABB OBB::getAABB() const
+{
+	glm::vec3 half(0.0f);
+	for(int i = 0; i < 3; i++) {
+		half += glm::abs(axes[i]) * halfExtents[i];
+	}
+	return AABB(center - half, center + half);
+}
+
+bool OBB::overlaps(const OBB &other) const
+{
+	// R[i][j] is axis i of this box along axis j of the other, and t the distance between the
+	// centers along this box's axes
+	float R[3][3], absR[3][3];
+	glm::vec3 d = other.center - center;
+	glm::vec3 t;
+	for(int i = 0; i < 3; i++) {
+		for(int j = 0; j < 3; j++) {
+			R[i][j] = glm::dot(axes[i], other.axes[j]);
+			// Keeps near-parallel edges from making a cross product of nothing separate the boxes
+			absR[i][j] = std::abs(R[i][j]) + 1e-6f;
+		}
+		t[i] = glm::dot(d, axes[i]);
+	}
+	const glm::vec3 &a = halfExtents, &b = other.halfExtents;
+
+	for(int i = 0; i < 3; i++) {
+		if(std::abs(t[i]) > a[i] + b[0] * absR[i][0] + b[1] * absR[i][1] + b[2] * absR[i][2]) {
+			return false;
+		}
+	}
+	for(int j = 0; j < 3; j++) {
+		float dist = t[0] * R[0][j] + t[1] * R[1][j] + t[2] * R[2][j];
+		if(std::abs(dist) > a[0] * absR[0][j] + a[1] * absR[1][j] + a[2] * absR[2][j] + b[j]) {
+			return false;
+		}
+	}
+	for(int i = 0; i < 3; i++) {
+		int i1 = (i + 1) % 3, i2 = (i + 2) % 3;
+		for(int j = 0; j < 3; j++) {
+			int j1 = (j + 1) % 3, j2 = (j + 2) % 3;
+			float ra = a[i1] * absR[i2][j] + a[i2] * absR[i1][j];
+			float rb = b[j1] * absR[i][j2] + b[j2] * absR[i][j1];
+			if(std::abs(t[i2] * R[i1][j] - t[i1] * R[i2][j]) > ra + rb) {
+				return false;
+			}
+		}
+	}
+	return true;
+}
+
+bool OBB::overlaps(const BoundingSphere &s) const
+{
+	// How far the sphere's center is outside the box along each axis
+	glm::vec3 d = s.center - center;
+	float dist2 = 0.0f;
+	for(int i = 0; i < 3; i++) {
+		float out = std::max(0.0f, std::abs(glm::dot(d, axes[i])) - halfExtents[i]);
+		dist2 += out * out;
+	}
+	return dist2 <= s.radius * s.radius;
+}
+
+OBB OBB::enclosing(const std::vector<glm::vec3> &points)
+{
+	OBB box;
+	if(points.empty()) {
+		return box;
+	}
+
+	Eigen::Vector3f mean = Eigen::Vector3f::Zero();
+	for(auto p = points.begin(); p != points.end(); ++p) {
+		mean += Eigen::Vector3f(p->x, p->y, p->z);
+	}
+	mean /= (float)points.size();
+	Eigen::Matrix3f cov = Eigen::Matrix3f::Zero();
+	for(auto p = points.begin(); p != points.end(); ++p) {
+		Eigen::Vector3f q = Eigen::Vector3f(p->x, p->y, p->z) - mean;
+		cov += q * q.transpose();
+	}
+	Eigen::SelfAdjointEigenSolver<Eigen::Matrix3f> solver(cov);
+	for(int i = 0; i < 3; i++) {
+		Eigen::Vector3f v = solver.eigenvectors().col(i);
+		box.axes[i] = glm::normalize(glm::vec3(v.x(), v.y(), v.z()));
+	}
+
+	// Fit the box to the points along each axis
+	glm::vec3 lo(INFINITY), hi(-INFINITY);
+	for(auto p = points.begin(); p != points.end(); ++p) {
+		for(int i = 0; i < 3; i++) {
+			float s = glm::dot(*p, box.axes[i]);
+			lo[i] = std::min(lo[i], s);
+			hi[i] = std::max(hi[i], s);
+		}
+	}
+	box.center = glm::vec3(0.0f);
+	for(int i = 0; i < 3; i++) {
+		box.center += 0.5f * (lo[i] + hi[i]) * box.axes[i];
+	}
+	box.halfExtents = 0.5f * (hi - lo);
+	return box;
+}
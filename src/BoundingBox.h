@@ -0,0 +1,46 @@
+#pragma once
+#ifndef BOUNDING_BOX_H
+#define BOUNDING_BOX_H
+
+#include <vector>
+
+#define GLM_FORCE_RADIANS
+#include <glm/glm.hpp>
+
+#include "BoundingSphere.h"
+
+// Axis-aligned box
+struct AABB {
+	glm::vec3 lo, hi;
+
+	AABB();
+	AABB(const glm::vec3 &lo, const glm::vec3 &hi);
+
+	glm::vec3 getCenter() const { return 0.5f * (lo + hi); }
+	glm::vec3 getHalfExtents() const { return 0.5f * (hi - lo); }
+	bool overlaps(const AABB &other) const;
+
+	static AABB enclosing(const std::vector<glm::vec3> &points);
+};
+
+// Box along its own unit axes: every center + u.x * axes[0] + u.y * axes[1] + u.z * axes[2]
+// with |u| <= halfExtents on each axis
+struct OBB {
+	glm::vec3 center;
+	glm::vec3 axes[3];
+	glm::vec3 halfExtents;
+
+	OBB();
+
+	// The box after M, which may rotate, scale uniformly and translate
+	OBB transformed(const glm::mat4 &M) const;
+	AABB getAABB() const;
+	// Separating axis test: both boxes' axes and the nine pairs of them
+	bool overlaps(const OBB &other) const;
+	bool overlaps(const BoundingSphere &s) const;
+
+	// Along the principal axes of the points, from their covariance
+	static OBB enclosing(const std::vector<glm::vec3> &points);
+};
+
+#endif
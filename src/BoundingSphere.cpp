@@ -1,5 +1,7 @@
 #include "BoundingSphere.h"
+#include <algorithm>
 #include <iostream>
+#include <random>
 
 using std::cout, std::endl;
 
@@ -7,7 +9,7 @@ BoundingSphere::BoundingSphere(): radius(0.0f), center(0.0f, 0.0f, 0.0f) {}
 
 BoundingSphere::BoundingSphere(float r, glm::vec3 c): radius(r), center(c) {}
 
-bool BoundingSphere::collided(BoundingSphere &other){
+bool BoundingSphere::collided(const BoundingSphere &other) const{
 
     const float dist = sqrt(
         (this->center.x - other.center.x) * (this->center.x - other.center.x) +
@@ -25,7 +27,7 @@ void printVec(glm::vec3 v){
 // Checks if a line segment characterized by two points intersects the sphere
 // Implementation obtained here: https://www.baeldung.com/cs/circle-line-segment-collision-detection
 // Alternate formula for minDist obtained here: https://mathworld.wolfram.com/Point-LineDistance3-Dimensional.html
-bool BoundingSphere::collided(glm::vec3 p1, glm::vec3 p2){
+bool BoundingSphere::collided(const glm::vec3 &p1, const glm::vec3 &p2) const{
 
     // Finds the shortest distance from a line specified by p1 and p2 to the center of the sphere
     // If this distance is less than or equal to the sphere's radius, we have an intersection    
@@ -44,4 +46,121 @@ bool BoundingSphere::collided(glm::vec3 p1, glm::vec3 p2){
     }
 
     return minDist <= radius && maxDist >= radius;
-}
\ No newline at end of file
+}
+
+bool BoundingSphere::intersect(const glm::vec3 &p, const glm::vec3 &d, float len, float &t) const{
+    glm::vec3 m = p - center;
+    float c = glm::dot(m, m) - radius * radius;
+    if (c <= 0.0f){
+        t = 0.0f;
+        return true;
+    }
+
+    // Outside and moving away
+    float b = glm::dot(m, d);
+    if (b > 0.0f){
+        return false;
+    }
+
+    float disc = b * b - c;
+    if (disc < 0.0f){
+        return false;
+    }
+    t = -b - std::sqrt(disc);
+    return t <= len;
+}
+
+BoundingSphere BoundingSphere::transformed(const glm::mat4 &M) const{
+    float scale = std::max(glm::length(glm::vec3(M[0])), std::max(glm::length(glm::vec3(M[1])), glm::length(glm::vec3(M[2]))));
+    return BoundingSphere(radius * scale, glm::vec3(M * glm::vec4(center, 1.0f)));
+}
+
+namespace {
+
+    // The smallest spheres with two, three and four points on their surface. Degenerate sets
+    // (coincident, collinear or coplanar points) fall back to the widest pair.
+    BoundingSphere sphereThrough(const glm::vec3 &a, const glm::vec3 &b){
+        return BoundingSphere(0.5f * glm::length(b - a), 0.5f * (a + b));
+    }
+
+    BoundingSphere widest(const glm::vec3 *p, int n){
+        BoundingSphere best = sphereThrough(p[0], p[1]);
+        for (int i = 0; i < n; i++){
+            for (int j = i + 1; j < n; j++){
+                BoundingSphere s = sphereThrough(p[i], p[j]);
+                if (s.radius > best.radius){ best = s; }
+            }
+        }
+        return best;
+    }
+
+    BoundingSphere sphereThrough(const glm::vec3 &a, const glm::vec3 &b, const glm::vec3 &c){
+        glm::vec3 ab = b - a, ac = c - a;
+        glm::vec3 n = glm::cross(ab, ac);
+        float d = 2.0f * glm::dot(n, n);
+        if (d <= 1e-12f * glm::dot(ab, ab) * glm::dot(ac, ac)){
+            glm::vec3 p[3] = {a, b, c};
+            return widest(p, 3);
+        }
+        glm::vec3 o = (glm::dot(ac, ac) * glm::cross(n, ab) + glm::dot(ab, ab) * glm::cross(ac, n)) / d;
+        return BoundingSphere(glm::length(o), a + o);
+    }
+
+    BoundingSphere sphereThrough(const glm::vec3 &a, const glm::vec3 &b, const glm::vec3 &c, const glm::vec3 &e){
+        glm::vec3 u = b - a, v = c - a, w = e - a;
+        float det = 2.0f * glm::dot(u, glm::cross(v, w));
+        float scale = glm::length(u) * glm::length(v) * glm::length(w);
+        if (std::abs(det) <= 1e-6f * scale){
+            glm::vec3 p[4] = {a, b, c, e};
+            BoundingSphere best = widest(p, 4);
+            for (int i = 0; i < 4; i++){
+                BoundingSphere s = sphereThrough(p[(i + 1) % 4], p[(i + 2) % 4], p[(i + 3) % 4]);
+                if (s.radius > best.radius){ best = s; }
+            }
+            return best;
+        }
+        glm::vec3 o = (glm::dot(u, u) * glm::cross(v, w) + glm::dot(v, v) * glm::cross(w, u) + glm::dot(w, w) * glm::cross(u, v)) / det;
+        return BoundingSphere(glm::length(o), a + o);
+    }
+
+    bool outside(const BoundingSphere &s, const glm::vec3 &p){
+        return glm::length(p - s.center) > s.radius * (1.0f + 1e-5f);
+    }
+
+}
+
+BoundingSphere BoundingSphere::enclosing(const std::vector<glm::vec3> &points){
+    if (points.empty()){
+        return BoundingSphere();
+    }
+
+    // Welzl's algorithm, unrolled into its move-to-front loops: whenever a point is outside, the
+    // sphere is rebuilt with that point on its surface, around the points before it. Shuffled
+    // first, so the expected time is linear.
+    std::vector<glm::vec3> p(points);
+    std::shuffle(p.begin(), p.end(), std::mt19937(1));
+    BoundingSphere s(0.0f, p[0]);
+    for (size_t i = 1; i < p.size(); i++){
+        if (!outside(s, p[i])){ continue; }
+        s = BoundingSphere(0.0f, p[i]);
+        for (size_t j = 0; j < i; j++){
+            if (!outside(s, p[j])){ continue; }
+            s = sphereThrough(p[i], p[j]);
+            for (size_t k = 0; k < j; k++){
+                if (!outside(s, p[k])){ continue; }
+                s = sphereThrough(p[i], p[j], p[k]);
+                for (size_t l = 0; l < k; l++){
+                    if (outside(s, p[l])){
+                        s = sphereThrough(p[i], p[j], p[k], p[l]);
+                    }
+                }
+            }
+        }
+    }
+
+    // Whatever rounding left out
+    for (size_t i = 0; i < p.size(); i++){
+        s.radius = std::max(s.radius, glm::length(p[i] - s.center));
+    }
+    return s;
+}
@@ -5,7 +5,8 @@
 #define GLM_FORCE_RADIANS
 #include <glm/glm.hpp>
 
-#include "Beam.h"
+#include <cmath>
+#include <vector>
 
 struct BoundingSphere{
     float radius;
@@ -14,8 +15,16 @@ struct BoundingSphere{
     BoundingSphere();
     BoundingSphere(float r, glm::vec3 c);
 
-    bool collided(BoundingSphere &other);
-    bool collided(glm::vec3 p1, glm::vec3 p2);
+    bool collided(const BoundingSphere &other) const;
+    bool collided(const glm::vec3 &p1, const glm::vec3 &p2) const;
+    // Whether the segment from p along the unit direction d for len units touches the sphere.
+    // If it does, t is how far along it first does (0 if p is already inside).
+    bool intersect(const glm::vec3 &p, const glm::vec3 &d, float len, float &t) const;
+    // The sphere around this one after M (rotation, scale and translation)
+    BoundingSphere transformed(const glm::mat4 &M) const;
+
+    // The smallest sphere around all of the points (Welzl's algorithm)
+    static BoundingSphere enclosing(const std::vector<glm::vec3> &points);
 };
 
 #endif
\ No newline at end of file
@@ -0,0 +1,58 @@
+#include "CollisionEvents.h"
+
+#include <algorithm>
+
+CollisionEvent::CollisionEvent() :
+	kind(COLLISION_SHIP_ASTEROID),
+	source(-1),
+	target(-1),
+	t(0.0f)
+{
+}
+
+CollisionEvent::CollisionEvent(int kind, int source, int target, float t) :
+	kind(kind),
+	source(source),
+	target(target),
+	t(t)
+{
+}
+
+CollisionEventQueue::CollisionEventQueue() :
+	buffers(1)
+{
+}
+
+void CollisionEventQueue::clear()
+{
+	for(auto b = buffers.begin(); b != buffers.end(); ++b) {
+		b->clear();
+	}
+	events.clear();
+}
+
+void CollisionEventQueue::push(const CollisionEvent &e)
+{
+	buffers[0].push_back(e);
+}
+
+int CollisionEventQueue::getMaxThreads() const
+{
+	return std::max(1, (int)std::thread::hardware_concurrency());
+}
+
+const std::vector<CollisionEvent> &CollisionEventQueue::gather()
+{
+	events.clear();
+	for(auto b = buffers.begin(); b != buffers.end(); ++b) {
+		events.insert(events.end(), b->begin(), b->end());
+		b->clear();
+	}
+	std::sort(events.begin(), events.end(), [](const CollisionEvent &a, const CollisionEvent &b){
+		if(a.kind != b.kind) { return a.kind < b.kind; }
+		if(a.source != b.source) { return a.source < b.source; }
+		if(a.t != b.t) { return a.t < b.t; }
+		return a.target < b.target;
+	});
+	return events;
+}
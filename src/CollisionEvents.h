@@ -0,0 +1,82 @@
+#pragma once
+#ifndef COLLISION_EVENTS_H
+#define COLLISION_EVENTS_H
+
+#include <algorithm>
+#include <functional>
+#include <thread>
+#include <vector>
+
+#define COLLISION_MIN_PER_THREAD 2048 // Fewer items than this per thread aren't worth starting one for
+
+// In the order they are resolved
+enum CollisionKind {
+	COLLISION_SHIP_ASTEROID,
+	COLLISION_BEAM_ASTEROID
+};
+
+// Something that touched something else this tick
+struct CollisionEvent {
+	int kind;
+	int source; // The ship, or the index of the projectile
+	int target; // Index of the asteroid
+	float t;    // How far along the source's swept segment, for beams
+
+	CollisionEvent();
+	CollisionEvent(int kind, int source, int target, float t = 0.0f);
+};
+
+/**
+ * Collects a tick's collisions so that finding them and acting on them are separate stages.
+ * Detection only reads the world, so detect() can spread it over several threads, each writing
+ * to a buffer of its own. gather() then puts every thread's events into one list in an order
+ * that doesn't depend on how the work was split, for a single thread to apply kills, score,
+ * splits and explosions from.
+ */
+class CollisionEventQueue
+{
+public:
+	CollisionEventQueue();
+
+	// Forgets the last tick's events
+	void clear();
+	// For events found outside detect(), on the calling thread
+	void push(const CollisionEvent &e);
+
+	// Calls f(thread, begin, end, out) for contiguous ranges covering [0, n), on up to
+	// numThreads threads (0 for one per core), this one included. thread counts from 0 and is
+	// below getMaxThreads(); out is that thread's buffer, to append events to.
+	template <typename F>
+	void detect(int n, F f, int numThreads = 0);
+	int getMaxThreads() const;
+
+	// Every event since clear(), by kind, then source, t and target
+	const std::vector<CollisionEvent> &gather();
+
+private:
+	std::vector<std::vector<CollisionEvent> > buffers; // One per thread, the first for push()
+	std::vector<CollisionEvent> events;
+};
+
+template <typename F>
+void CollisionEventQueue::detect(int n, F f, int numThreads)
+{
+	if(numThreads <= 0) {
+		numThreads = getMaxThreads();
+	}
+	numThreads = std::max(1, std::min(numThreads, n / COLLISION_MIN_PER_THREAD));
+	if((int)buffers.size() < numThreads) {
+		buffers.resize(numThreads);
+	}
+
+	std::vector<std::thread> threads;
+	for(int i = 1; i < numThreads; i++) {
+		threads.push_back(std::thread(f, i, (int)((long)n * i / numThreads), (int)((long)n * (i + 1) / numThreads), std::ref(buffers[i])));
+	}
+	f(0, 0, (int)((long)n / numThreads), buffers[0]);
+	for(auto t = threads.begin(); t != threads.end(); ++t) {
+		t->join();
+	}
+}
+
+#endif
@@ -1,11 +1,9 @@
 #include "ExhaustFire.h"
 #include "MatrixStack.h"
+#include "GLState.h"
 #include <iostream>
 using std::cout, std::endl;
 
-#define EXHAUST_X_OFFSET 0.5f
-#define EXHAUST_Y_OFFSET 0.75f
-#define EXHAUST_Z_OFFSET -0.8f
 #define NUM_EXHAUST_PARTICLES 10000
 
 glm::vec4 worldDirMin(-0.4f, -0.4f, -0.5f, 0.0f);
@@ -47,12 +45,14 @@ ExhaustFire::ExhaustFire(const std::string RESOURCE_DIR, int e)
 	scaBufID = bufs[3];
 	
 	// Send color buffer to GPU
-	glBindBuffer(GL_ARRAY_BUFFER, colBufID);
+	GLState::bindArrayBuffer(colBufID);
 	glBufferData(GL_ARRAY_BUFFER, colBuf.size()*sizeof(float), &colBuf[0], GL_STATIC_DRAW);
 	
 	// Send scale buffer to GPU
-	glBindBuffer(GL_ARRAY_BUFFER, scaBufID);
+	GLState::bindArrayBuffer(scaBufID);
 	glBufferData(GL_ARRAY_BUFFER, scaBuf.size()*sizeof(float), &scaBuf[0], GL_STATIC_DRAW);
+
+	initVAO();
 	
 	assert(glGetError() == GL_NO_ERROR);
 
@@ -66,11 +66,11 @@ ExhaustFire::ExhaustFire(const std::string RESOURCE_DIR, int e)
 	}
 
 	// Send color buffer to GPU
-	glBindBuffer(GL_ARRAY_BUFFER, colBufID);
+	GLState::bindArrayBuffer(colBufID);
 	glBufferData(GL_ARRAY_BUFFER, colBuf.size()*sizeof(float), &colBuf[0], GL_STATIC_DRAW);
 	
 	// Send scale buffer to GPU
-	glBindBuffer(GL_ARRAY_BUFFER, scaBufID);
+	GLState::bindArrayBuffer(scaBufID);
 	glBufferData(GL_ARRAY_BUFFER, scaBuf.size()*sizeof(float), &scaBuf[0], GL_STATIC_DRAW);
 }
 
@@ -123,27 +123,16 @@ void ExhaustFire::step(MatrixStack M, bool wPressed)
 	sendColorBuf();
 }
 
-void ExhaustFire::draw(std::shared_ptr<MatrixStack> &P, 
-    std::shared_ptr<MatrixStack> &MV, int width, int height, 
-    std::shared_ptr<Texture> &alphaTex, std::shared_ptr<Program> &prog)
+void ExhaustFire::submit(RenderQueue &queue, int view, std::shared_ptr<MatrixStack> &MV)
 {
-    glEnable(GL_BLEND);
-	glDepthMask(GL_FALSE);
-	glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
-
-	alphaTex->bind(prog->getUniform("alphaTexture"));
-
-    MV->pushMatrix();
-	
-	glUniformMatrix4fv(prog->getUniform("P"), 1, GL_FALSE, glm::value_ptr(P->topMatrix()));
-	glUniformMatrix4fv(prog->getUniform("MV"), 1, GL_FALSE, glm::value_ptr(MV->topMatrix()));
-	glUniform2f(prog->getUniform("screenSize"), (float)width, (float)height);    
-    drawParticles(prog);
-
-    MV->popMatrix();
+    queue.submitParticles(view, this, MV->topMatrix(), center);
+}
 
-	alphaTex->unbind();
-	
-	glDepthMask(GL_TRUE);
-	glDisable(GL_BLEND);
+void ExhaustFire::translate(const glm::vec3 &d)
+{
+    for(int i = 0; i < (int)particles.size(); ++i) {
+        posBuf[3*i+0] += d.x;
+        posBuf[3*i+1] += d.y;
+        posBuf[3*i+2] += d.z;
+    }
 }
@@ -1,5 +1,22 @@
+#pragma once
+#ifndef EXHAUST_FIRE_H
+#define EXHAUST_FIRE_H
+
 #include "Explosion.h"
 
+// Where the nozzles sit in the ship's model space (the left one is at -EXHAUST_X_OFFSET)
+#define EXHAUST_X_OFFSET 0.5f
+#define EXHAUST_Y_OFFSET 0.75f
+#define EXHAUST_Z_OFFSET -0.8f
+
+// The cone, speeds and lifespans exhaust particles are emitted with. Shared with ShipFleet.
+extern glm::vec4 worldDirMin;
+extern glm::vec4 worldDirMax;
+extern float speedMin;
+extern float speedMax;
+extern float minls;
+extern float maxls;
+
 enum EXHAUST{
     LEFT = 0,
     RIGHT = 1
@@ -11,11 +28,14 @@ public:
     ExhaustFire(const std::string RESOURCE_DIR, int e);
     void setRoll(float angle) { roll = angle; }
     void step(MatrixStack M, bool wPressed);
-    void draw(std::shared_ptr<MatrixStack> &P, 
-    std::shared_ptr<MatrixStack> &MV, int width, int height, 
-    std::shared_ptr<Texture> &alphaTex, std::shared_ptr<Program> &prog);
+    // The exhaust particles are already in world space, so MV is used as is
+    void submit(RenderQueue &queue, int view, std::shared_ptr<MatrixStack> &MV);
+    // Moves every particle by d, when the world's origin moves
+    void translate(const glm::vec3 &d);
 
 private:
     int exhaust;
     float roll;
-};
\ No newline at end of file
+};
+
+#endif
@@ -1,4 +1,5 @@
 #include "Explosion.h"
+#include "GLState.h"
 
 #include <iostream>
 using std::cout, std::endl;
@@ -37,13 +38,15 @@ Explosion::Explosion(std::string RESOURCE_DIR, Eigen::Vector3f col){
 	scaBufID = bufs[3];
 
 	// Send color buffer to GPU
-	glBindBuffer(GL_ARRAY_BUFFER, colBufID);
+	GLState::bindArrayBuffer(colBufID);
 	glBufferData(GL_ARRAY_BUFFER, colBuf.size()*sizeof(float), &colBuf[0], GL_STATIC_DRAW);
 	
 	// Send scale buffer to GPU
-	glBindBuffer(GL_ARRAY_BUFFER, scaBufID);
+	GLState::bindArrayBuffer(scaBufID);
 	glBufferData(GL_ARRAY_BUFFER, scaBuf.size()*sizeof(float), &scaBuf[0], GL_STATIC_DRAW);
 
+	initVAO();
+
 	for(int i = 0; i < NUM_PARTICLES_PER_EXPLOSION; ++i) {
 		auto p = std::make_shared<Particle>(i, colBufID, scaBufID, posBuf, colBuf, alpBuf, scaBuf, col);
 		particles.push_back(p);
@@ -51,6 +54,42 @@ Explosion::Explosion(std::string RESOURCE_DIR, Eigen::Vector3f col){
 	}
 }
 
+void Explosion::reset(Eigen::Vector3f col){
+    tCreated = tGlobal;
+    for(int i = 0; i < (int)particles.size(); ++i) {
+        particles[i]->setColor(col.x(), col.y(), col.z());
+        particles[i]->rebirth();
+    }
+    sendColorBuf();
+}
+
+// On a core profile, record the attribute setup once in a vertex array object
+void Explosion::initVAO(){
+	if (!coreProfile){ return; }
+
+	glGenVertexArrays(1, &vaoID);
+	GLState::bindVertexArray(vaoID);
+
+	glEnableVertexAttribArray(ATTRIB_POS);
+	GLState::bindArrayBuffer(posBufID);
+	glVertexAttribPointer(ATTRIB_POS, 3, GL_FLOAT, GL_FALSE, 0, 0);
+
+	glEnableVertexAttribArray(ATTRIB_ALP);
+	GLState::bindArrayBuffer(alpBufID);
+	glVertexAttribPointer(ATTRIB_ALP, 1, GL_FLOAT, GL_FALSE, 0, 0);
+
+	glEnableVertexAttribArray(ATTRIB_COL);
+	GLState::bindArrayBuffer(colBufID);
+	glVertexAttribPointer(ATTRIB_COL, 3, GL_FLOAT, GL_FALSE, 0, 0);
+
+	glEnableVertexAttribArray(ATTRIB_SCA);
+	GLState::bindArrayBuffer(scaBufID);
+	glVertexAttribPointer(ATTRIB_SCA, 1, GL_FLOAT, GL_FALSE, 0, 0);
+
+	GLState::bindVertexArray(0);
+	GLState::bindArrayBuffer(0);
+}
+
 void Explosion::setCenter(glm::vec3 c){
     center = c;
 }
@@ -62,75 +101,64 @@ void Explosion::step(){
     }
 }
 
-void Explosion::draw(std::shared_ptr<MatrixStack> &P, 
-    std::shared_ptr<MatrixStack> &MV, int width, int height, 
-    std::shared_ptr<Texture> &alphaTex, std::shared_ptr<Program> &prog)
+void Explosion::submit(RenderQueue &queue, int view, std::shared_ptr<MatrixStack> &MV)
 {
-    glEnable(GL_BLEND);
-	glDepthMask(GL_FALSE);
-	glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
-
-	alphaTex->bind(prog->getUniform("alphaTexture"));
-
     MV->pushMatrix();
     MV->translate(center);
-	
-	glUniformMatrix4fv(prog->getUniform("P"), 1, GL_FALSE, glm::value_ptr(P->topMatrix()));
-	glUniformMatrix4fv(prog->getUniform("MV"), 1, GL_FALSE, glm::value_ptr(MV->topMatrix()));
-	glUniform2f(prog->getUniform("screenSize"), (float)width, (float)height);    
-    drawParticles(prog);
-
+    queue.submitParticles(view, this, MV->topMatrix(), glm::vec3(0.0f));
     MV->popMatrix();
-
-	alphaTex->unbind();
-	
-	glDepthMask(GL_TRUE);
-	glDisable(GL_BLEND);
 }
 
-void Explosion::drawParticles(std::shared_ptr<Program> &prog)
+void Explosion::drawParticles(std::shared_ptr<ParticleProgram> &prog)
 {
-    // Enable, bind, and send position array
-	glEnableVertexAttribArray(prog->getAttribute("aPos"));
-	glBindBuffer(GL_ARRAY_BUFFER, posBufID);
+	if (vaoID != 0){
+		// Only the positions and alphas change every frame
+		GLState::bindArrayBuffer(posBufID);
+		glBufferData(GL_ARRAY_BUFFER, posBuf.size()*sizeof(float), &posBuf[0], GL_DYNAMIC_DRAW);
+		GLState::bindArrayBuffer(alpBufID);
+		glBufferData(GL_ARRAY_BUFFER, alpBuf.size()*sizeof(float), &alpBuf[0], GL_DYNAMIC_DRAW);
+
+		GLState::bindVertexArray(vaoID);
+		glDrawArrays(GL_POINTS, 0, particles.size());
+		return;
+	}
+
+	GLint h_pos = prog->getAttribute(ATTRIB_POS);
+	GLint h_alp = prog->getAttribute(ATTRIB_ALP);
+	GLint h_col = prog->getAttribute(ATTRIB_COL);
+	GLint h_sca = prog->getAttribute(ATTRIB_SCA);
+	GLState::setAttribArrays((1u << h_pos) | (1u << h_alp) | (1u << h_col) | (1u << h_sca));
+
+    // Bind and send position array
+	GLState::bindArrayBuffer(posBufID);
 	glBufferData(GL_ARRAY_BUFFER, posBuf.size()*sizeof(float), &posBuf[0], GL_DYNAMIC_DRAW);
-	glVertexAttribPointer(prog->getAttribute("aPos"), 3, GL_FLOAT, GL_FALSE, 0, 0);
+	glVertexAttribPointer(h_pos, 3, GL_FLOAT, GL_FALSE, 0, 0);
 	
-	// Enable, bind, and send alpha array
-	glEnableVertexAttribArray(prog->getAttribute("aAlp"));
-	glBindBuffer(GL_ARRAY_BUFFER, alpBufID);
+	// Bind and send alpha array
+	GLState::bindArrayBuffer(alpBufID);
 	glBufferData(GL_ARRAY_BUFFER, alpBuf.size()*sizeof(float), &alpBuf[0], GL_DYNAMIC_DRAW);
-	glVertexAttribPointer(prog->getAttribute("aAlp"), 1, GL_FLOAT, GL_FALSE, 0, 0);
+	glVertexAttribPointer(h_alp, 1, GL_FLOAT, GL_FALSE, 0, 0);
 	
-	// Enable and bind color array
-	glEnableVertexAttribArray(prog->getAttribute("aCol"));
-	glBindBuffer(GL_ARRAY_BUFFER, colBufID);
-	glVertexAttribPointer(prog->getAttribute("aCol"), 3, GL_FLOAT, GL_FALSE, 0, 0);
+	// Bind color array
+	GLState::bindArrayBuffer(colBufID);
+	glVertexAttribPointer(h_col, 3, GL_FLOAT, GL_FALSE, 0, 0);
 	
-	// Enable and bind scale array
-	glEnableVertexAttribArray(prog->getAttribute("aSca"));
-	glBindBuffer(GL_ARRAY_BUFFER, scaBufID);
-	glVertexAttribPointer(prog->getAttribute("aSca"), 1, GL_FLOAT, GL_FALSE, 0, 0);
+	// Bind scale array
+	GLState::bindArrayBuffer(scaBufID);
+	glVertexAttribPointer(h_sca, 1, GL_FLOAT, GL_FALSE, 0, 0);
 	
 	// Draw
-	glDrawArrays(GL_POINTS, 0, 3*particles.size());
-	
-	// Disable and unbind
-	glDisableVertexAttribArray(prog->getAttribute("aSca"));
-	glDisableVertexAttribArray(prog->getAttribute("aCol"));
-	glDisableVertexAttribArray(prog->getAttribute("aAlp"));
-	glDisableVertexAttribArray(prog->getAttribute("aPos"));
-	glBindBuffer(GL_ARRAY_BUFFER, 0);
+	glDrawArrays(GL_POINTS, 0, particles.size());
 }
 
 void Explosion::sendColorBuf(){
 	// Send color buffer to GPU
-	glBindBuffer(GL_ARRAY_BUFFER, colBufID);
+	GLState::bindArrayBuffer(colBufID);
 	glBufferData(GL_ARRAY_BUFFER, colBuf.size()*sizeof(float), &colBuf[0], GL_STATIC_DRAW);
 }
 
 void Explosion::sendScaleBuf(){
 	// Send scale buffer to GPU
-	glBindBuffer(GL_ARRAY_BUFFER, scaBufID);
+	GLState::bindArrayBuffer(scaBufID);
 	glBufferData(GL_ARRAY_BUFFER, scaBuf.size()*sizeof(float), &scaBuf[0], GL_STATIC_DRAW);
 }
\ No newline at end of file
@@ -3,9 +3,10 @@
 #define EXPLOSION_H
 
 #include "Particle.h"
-#include "Program.h"
+#include "Uniforms.h"
 #include "Texture.h"
 #include "MatrixStack.h"
+#include "RenderQueue.h"
 
 #define GLEW_STATIC
 #include <GL/glew.h>
@@ -20,19 +21,23 @@
 #define NUM_PARTICLES_PER_EXPLOSION 500
 #define EXPLOSION_LIFESPAN 1.0 // In seconds
 
-extern double tGlobal;
+extern thread_local double tGlobal;
 
 class Explosion {
 public:
     Explosion(){}
     Explosion(std::string RESOURCE_DIR, Eigen::Vector3f col);
+    // Restarts a finished explosion in a new color instead of making a new one
+    void reset(Eigen::Vector3f col);
     void step();
-    void draw(std::shared_ptr<MatrixStack> &P, std::shared_ptr<MatrixStack> &MV, int width, int height, 
-            std::shared_ptr<Texture> &alphaTex, std::shared_ptr<Program> &prog);
-    void drawParticles(std::shared_ptr<Program> &prog);
+    virtual ~Explosion(){}
+    // Queues the particles for drawing. MV is the camera's view matrix.
+    virtual void submit(RenderQueue &queue, int view, std::shared_ptr<MatrixStack> &MV);
+    void drawParticles(std::shared_ptr<ParticleProgram> &prog);
     void setCenter(glm::vec3 c);
 
     bool isAlive() { return tGlobal < (tCreated + EXPLOSION_LIFESPAN); }
+    int getNumParticles() const { return (int)particles.size(); }
 
 protected:
     double tCreated = 0.0f;
@@ -48,7 +53,9 @@ protected:
     GLuint colBufID;
     GLuint alpBufID;
     GLuint scaBufID;
+    GLuint vaoID = 0; // Only used on a core profile
 
+    void initVAO();
     void sendColorBuf();
     void sendScaleBuf();
 };
@@ -0,0 +1,42 @@
+#include "FrameArena.h"
+
+#include <algorithm>
+
+FrameArena::FrameArena(size_t capacity) :
+	buf(new char[capacity]),
+	capacity(capacity),
+	used(0),
+	highWater(0),
+	overflows(0)
+{
+}
+
+FrameArena::~FrameArena()
+{
+	delete[] buf;
+}
+
+void *FrameArena::allocate(size_t bytes, size_t align)
+{
+	size_t start = (used + align - 1) & ~(align - 1);
+	if(start + bytes > capacity) {
+		overflows++;
+		return ::operator new(bytes);
+	}
+	used = start + bytes;
+	highWater = std::max(highWater, used);
+	return buf + start;
+}
+
+void FrameArena::deallocate(void *p)
+{
+	char *c = (char *)p;
+	if(c < buf || c >= buf + capacity) {
+		::operator delete(p);
+	}
+}
+
+void FrameArena::reset()
+{
+	used = 0;
+}
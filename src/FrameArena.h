@@ -0,0 +1,61 @@
+#pragma once
+#ifndef FRAME_ARENA_H
+#define FRAME_ARENA_H
+
+#include <cstddef>
+#include <cstdint>
+#include <new>
+
+/**
+ * A bump allocator for memory that only lives until the end of a frame (or simulation tick).
+ * allocate() just advances a pointer into a block made once up front, and reset() frees
+ * everything at once. When the block is full it falls back to the heap and counts an overflow,
+ * so a too-small arena shows up in the allocation stats instead of failing.
+ * Each thread should have its own arena.
+ */
+class FrameArena
+{
+public:
+	FrameArena(size_t capacity);
+	~FrameArena();
+
+	void *allocate(size_t bytes, size_t align);
+	void deallocate(void *p); // Only does anything for overflow allocations
+	void reset();
+
+	size_t getUsed() const { return used; }
+	size_t getHighWater() const { return highWater; }
+	uint64_t getOverflows() const { return overflows; }
+
+private:
+	FrameArena(const FrameArena &) = delete;
+	FrameArena &operator=(const FrameArena &) = delete;
+
+	char *buf;
+	size_t capacity;
+	size_t used;
+	size_t highWater;
+	uint64_t overflows;
+};
+
+// Lets standard containers take their memory from a FrameArena
+template <typename T>
+struct ArenaAllocator {
+	typedef T value_type;
+
+	ArenaAllocator(FrameArena &a) : arena(&a) {}
+	template <typename U>
+	ArenaAllocator(const ArenaAllocator<U> &other) : arena(other.arena) {}
+
+	T *allocate(size_t n) { return (T *)arena->allocate(n * sizeof(T), alignof(T)); }
+	void deallocate(T *p, size_t) { arena->deallocate(p); }
+
+	FrameArena *arena;
+};
+
+template <typename T, typename U>
+bool operator==(const ArenaAllocator<T> &a, const ArenaAllocator<U> &b) { return a.arena == b.arena; }
+template <typename T, typename U>
+bool operator!=(const ArenaAllocator<T> &a, const ArenaAllocator<U> &b) { return a.arena != b.arena; }
+
+#endif
@@ -0,0 +1,31 @@
+#include "FramePacer.h"
+
+#include <algorithm>
+#include <chrono>
+#include <thread>
+
+#include <GLFW/glfw3.h>
+
+FramePacer::FramePacer(double refreshHz) :
+	period(1.0 / refreshHz),
+	cost(0.0),
+	tStart(0.0),
+	tPresent(0.0)
+{
+}
+
+void FramePacer::wait()
+{
+	double tWake = tPresent + period - cost - PACER_MARGIN;
+	double t = glfwGetTime();
+	if(t < tWake) {
+		std::this_thread::sleep_for(std::chrono::duration<double>(tWake - t));
+	}
+}
+
+void FramePacer::workDone(double t)
+{
+	// Never budget more than a whole refresh, or one slow frame would make us start before the last swap
+	double c = std::min(t - tStart, period);
+	cost += PACER_COST_SMOOTHING * (c - cost);
+}
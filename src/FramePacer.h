@@ -0,0 +1,33 @@
+#pragma once
+#ifndef FRAME_PACER_H
+#define FRAME_PACER_H
+
+#define PACER_MARGIN 0.002       // Seconds of slack left before the refresh
+#define PACER_COST_SMOOTHING 0.1 // Weight of the newest frame in the running cost estimate
+
+/**
+ * Low-latency frame pacing. Instead of sampling input right after a swap and then waiting most of
+ * a refresh for vsync, the render thread sleeps until just before the next refresh, samples input
+ * and draws. The GPU is drained with glFinish() around the swap so frames never queue up.
+ *   wait() -> poll input -> beginWork() -> draw -> glFinish() -> workDone() -> swap -> glFinish() -> presented()
+ */
+class FramePacer
+{
+public:
+	FramePacer(double refreshHz);
+
+	void wait();
+	void beginWork(double t) { tStart = t; }
+	void workDone(double t);
+	void presented(double t) { tPresent = t; }
+
+	double getPeriod() const { return period; }
+
+private:
+	double period;
+	double cost;     // Smoothed time from beginWork() to workDone()
+	double tStart;
+	double tPresent; // When the last swap was known to be done
+};
+
+#endif
@@ -0,0 +1,56 @@
+#include "FrameUniforms.h"
+
+#include <cstddef>
+
+#include "GLSL.h"
+#include "Program.h"
+
+#include <glm/gtc/type_ptr.hpp>
+
+using namespace std;
+
+FrameUniforms::FrameUniforms() :
+	uboID(0)
+{
+	block.P = glm::mat4(1.0f);
+	block.lightPos = glm::vec4(0.0f);
+}
+
+FrameUniforms::~FrameUniforms()
+{
+}
+
+void FrameUniforms::init()
+{
+	glGenBuffers(1, &uboID);
+	glBindBuffer(GL_UNIFORM_BUFFER, uboID);
+	glBufferData(GL_UNIFORM_BUFFER, sizeof(Block), &block, GL_DYNAMIC_DRAW);
+	glBindBuffer(GL_UNIFORM_BUFFER, 0);
+	glBindBufferBase(GL_UNIFORM_BUFFER, FRAME_UBO_BINDING, uboID);
+
+	GLSL::checkError(GET_FILE_LINE);
+}
+
+void FrameUniforms::attach(const shared_ptr<Program> &prog) const
+{
+	if (uboID == 0){ return; }
+	prog->addUniformBlock("Frame", FRAME_UBO_BINDING);
+}
+
+void FrameUniforms::setProjection(const glm::mat4 &P)
+{
+	if (uboID == 0){ return; }
+	block.P = P;
+	glBindBuffer(GL_UNIFORM_BUFFER, uboID);
+	glBufferSubData(GL_UNIFORM_BUFFER, offsetof(Block, P), sizeof(glm::mat4), glm::value_ptr(block.P));
+	glBindBuffer(GL_UNIFORM_BUFFER, 0);
+}
+
+void FrameUniforms::setLightPos(const glm::vec3 &lightPos)
+{
+	if (uboID == 0){ return; }
+	block.lightPos = glm::vec4(lightPos, 1.0f);
+	glBindBuffer(GL_UNIFORM_BUFFER, uboID);
+	glBufferSubData(GL_UNIFORM_BUFFER, offsetof(Block, lightPos), sizeof(glm::vec3), glm::value_ptr(block.lightPos));
+	glBindBuffer(GL_UNIFORM_BUFFER, 0);
+}
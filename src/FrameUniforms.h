@@ -0,0 +1,46 @@
+#pragma once
+#ifndef FRAME_UNIFORMS_H
+#define FRAME_UNIFORMS_H
+
+#include <memory>
+
+#define GLEW_STATIC
+#include <GL/glew.h>
+
+#define GLM_FORCE_RADIANS
+#include <glm/glm.hpp>
+
+class Program;
+
+#define FRAME_UBO_BINDING 0
+
+/**
+ * Per-frame camera data (projection and light position) kept in a uniform buffer.
+ * Every GLSL 330 program declares the same "Frame" block, so one update is seen by all of them.
+ * Before init() is called (e.g. on a compatibility context) the setters do nothing and the
+ * programs keep using their plain P and lightPos uniforms.
+ */
+class FrameUniforms
+{
+public:
+	FrameUniforms();
+	virtual ~FrameUniforms();
+
+	void init();
+	void attach(const std::shared_ptr<Program> &prog) const;
+
+	void setProjection(const glm::mat4 &P);
+	void setLightPos(const glm::vec3 &lightPos);
+
+private:
+	// Matches the std140 layout of the Frame block
+	struct Block {
+		glm::mat4 P;
+		glm::vec4 lightPos;
+	};
+
+	GLuint uboID;
+	Block block;
+};
+
+#endif
@@ -0,0 +1,197 @@
+#include "GLState.h"
+
+#define MAX_TEXTURE_UNITS 16
+#define MAX_ATTRIB_ARRAYS 16
+
+namespace GLState {
+
+// -1 means "unknown", which forces the next call through to GL
+struct CapState {
+	GLenum cap;
+	int on;
+};
+
+static CapState caps[] = {
+	{ GL_BLEND, -1 },
+	{ GL_DEPTH_TEST, -1 },
+	{ GL_CULL_FACE, -1 },
+	{ GL_VERTEX_PROGRAM_POINT_SIZE, -1 }
+};
+static const int NUM_CAPS = sizeof(caps) / sizeof(caps[0]);
+
+static GLint blendSrc = -1;
+static GLint blendDst = -1;
+static int depthMaskOn = -1;
+static GLint polyMode = -1;
+static GLint program = -1;
+static GLint vertexArray = -1;
+static GLint arrayBuffer = -1;
+static GLint activeUnit = -1;
+static GLint textures[MAX_TEXTURE_UNITS] = {0}; // A new context has nothing bound on any unit
+static unsigned attribArrays = 0;
+static bool attribArraysKnown = false;
+
+static int skipped = 0;
+static int issued = 0;
+
+// Returns true (and counts an issued call) when the shadowed value has to change
+template <typename T>
+static bool update(T &shadow, T value)
+{
+	if(shadow == value) {
+		skipped++;
+		return false;
+	}
+	shadow = value;
+	issued++;
+	return true;
+}
+
+void setEnabled(GLenum cap, bool on)
+{
+	for(int i = 0; i < NUM_CAPS; i++) {
+		if(caps[i].cap == cap) {
+			if(update(caps[i].on, on ? 1 : 0)) {
+				on ? glEnable(cap) : glDisable(cap);
+			}
+			return;
+		}
+	}
+	issued++;
+	on ? glEnable(cap) : glDisable(cap);
+}
+
+void enable(GLenum cap)
+{
+	setEnabled(cap, true);
+}
+
+void disable(GLenum cap)
+{
+	setEnabled(cap, false);
+}
+
+void blendFunc(GLenum sfactor, GLenum dfactor)
+{
+	if(blendSrc == (GLint)sfactor && blendDst == (GLint)dfactor) {
+		skipped++;
+		return;
+	}
+	blendSrc = sfactor;
+	blendDst = dfactor;
+	issued++;
+	glBlendFunc(sfactor, dfactor);
+}
+
+void depthMask(GLboolean flag)
+{
+	if(update(depthMaskOn, flag ? 1 : 0)) {
+		glDepthMask(flag);
+	}
+}
+
+void polygonMode(GLenum mode)
+{
+	if(update(polyMode, (GLint)mode)) {
+		glPolygonMode(GL_FRONT_AND_BACK, mode);
+	}
+}
+
+void useProgram(GLuint pid)
+{
+	if(update(program, (GLint)pid)) {
+		glUseProgram(pid);
+	}
+}
+
+void bindVertexArray(GLuint vao)
+{
+	if(update(vertexArray, (GLint)vao)) {
+		glBindVertexArray(vao);
+	}
+}
+
+void bindArrayBuffer(GLuint buf)
+{
+	if(update(arrayBuffer, (GLint)buf)) {
+		glBindBuffer(GL_ARRAY_BUFFER, buf);
+	}
+}
+
+void bindTexture(GLint unit, GLuint tid)
+{
+	if(unit < 0 || unit >= MAX_TEXTURE_UNITS) {
+		issued += 2;
+		activeUnit = unit;
+		glActiveTexture(GL_TEXTURE0 + unit);
+		glBindTexture(GL_TEXTURE_2D, tid);
+		return;
+	}
+	// The unit is left active even when the texture is already there, like the calls this
+	// replaces, since callers go on to set parameters on whatever the active unit has bound
+	if(update(activeUnit, unit)) {
+		glActiveTexture(GL_TEXTURE0 + unit);
+	}
+	if(update(textures[unit], (GLint)tid)) {
+		glBindTexture(GL_TEXTURE_2D, tid);
+	}
+}
+
+void setAttribArrays(unsigned mask)
+{
+	unsigned changed = attribArraysKnown ? (attribArrays ^ mask) : ~0u;
+	for(int i = 0; i < MAX_ATTRIB_ARRAYS; i++) {
+		unsigned bit = 1u << i;
+		if(!(changed & bit)) {
+			// The old code enabled (and later disabled) every array it used
+			if(mask & bit) {
+				skipped++;
+			}
+			continue;
+		}
+		issued++;
+		if(mask & bit) {
+			glEnableVertexAttribArray(i);
+		} else {
+			glDisableVertexAttribArray(i);
+		}
+	}
+	attribArrays = mask;
+	attribArraysKnown = true;
+}
+
+void invalidate()
+{
+	for(int i = 0; i < NUM_CAPS; i++) {
+		caps[i].on = -1;
+	}
+	blendSrc = blendDst = -1;
+	depthMaskOn = -1;
+	polyMode = -1;
+	program = -1;
+	vertexArray = -1;
+	arrayBuffer = -1;
+	activeUnit = -1;
+	for(int i = 0; i < MAX_TEXTURE_UNITS; i++) {
+		textures[i] = -1;
+	}
+	attribArraysKnown = false;
+}
+
+int getSkippedCalls()
+{
+	return skipped;
+}
+
+int getIssuedCalls()
+{
+	return issued;
+}
+
+void resetFrameStats()
+{
+	skipped = 0;
+	issued = 0;
+}
+
+}
@@ -0,0 +1,45 @@
+#pragma once
+#ifndef GL_STATE_H
+#define GL_STATE_H
+
+#define GLEW_STATIC
+#include <GL/glew.h>
+
+/**
+ * A shadow copy of the GL state the renderer changes every frame.
+ * Each setter only calls into GL when the requested state differs from the shadowed one,
+ * so draw code can simply state what it needs before drawing.
+ * All binds of programs, VAOs, array buffers and textures should go through here,
+ * otherwise the shadow copy goes stale (call invalidate() after any code that doesn't).
+ */
+namespace GLState {
+
+	// Capabilities tracked: GL_BLEND, GL_DEPTH_TEST, GL_CULL_FACE, GL_VERTEX_PROGRAM_POINT_SIZE.
+	// Anything else is passed straight through.
+	void enable(GLenum cap);
+	void disable(GLenum cap);
+	void setEnabled(GLenum cap, bool on);
+
+	void blendFunc(GLenum sfactor, GLenum dfactor);
+	void depthMask(GLboolean flag);
+	void polygonMode(GLenum mode); // Always GL_FRONT_AND_BACK
+
+	void useProgram(GLuint pid);
+	void bindVertexArray(GLuint vao);
+	void bindArrayBuffer(GLuint buf);
+	void bindTexture(GLint unit, GLuint tid); // GL_TEXTURE_2D on the given unit, which is left active
+
+	// Sets exactly which generic attribute arrays are enabled (bit i = location i).
+	// Only meaningful while VAO 0 is bound, i.e. on the compatibility path.
+	void setAttribArrays(unsigned mask);
+
+	// Forgets everything, so the next call of each setter goes through to GL
+	void invalidate();
+
+	// Number of GL calls skipped / issued since the last resetFrameStats()
+	int getSkippedCalls();
+	int getIssuedCalls();
+	void resetFrameStats();
+}
+
+#endif
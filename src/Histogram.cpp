@@ -0,0 +1,79 @@
+#include "Histogram.h"
+
+#include <algorithm>
+#include <cmath>
+
+Histogram::Histogram()
+{
+	reset();
+}
+
+void Histogram::reset()
+{
+	for(int i = 0; i < HIST_NUM_BUCKETS; i++) {
+		buckets[i].store(0, std::memory_order_relaxed);
+	}
+	count.store(0, std::memory_order_relaxed);
+	sum.store(0, std::memory_order_relaxed);
+	max.store(0, std::memory_order_relaxed);
+}
+
+int Histogram::bucketOf(uint64_t us)
+{
+	if(us < HIST_SUB_COUNT) {
+		return (int)us;
+	}
+	int e = HIST_SUB_BITS; // Index of the highest set bit
+	while((us >> (e + 1)) != 0) {
+		e++;
+	}
+	int shift = e - HIST_SUB_BITS;
+	return (shift + 1) * HIST_SUB_COUNT + (int)(us >> shift) - HIST_SUB_COUNT;
+}
+
+uint64_t Histogram::bucketTop(int bucket)
+{
+	int group = bucket / HIST_SUB_COUNT;
+	uint64_t sub = bucket % HIST_SUB_COUNT;
+	if(group == 0) {
+		return sub;
+	}
+	return ((HIST_SUB_COUNT + sub + 1) << (group - 1)) - 1;
+}
+
+void Histogram::record(double seconds)
+{
+	uint64_t us = (uint64_t)std::llround(std::max(seconds, 0.0) * 1e6);
+	us = std::min(us, ((uint64_t)1 << (HIST_MAX_EXPONENT + 1)) - 1);
+	std::atomic<uint64_t> &b = buckets[bucketOf(us)];
+	b.store(b.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+	count.store(count.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+	sum.store(sum.load(std::memory_order_relaxed) + us, std::memory_order_relaxed);
+	if(us > max.load(std::memory_order_relaxed)) {
+		max.store(us, std::memory_order_relaxed);
+	}
+}
+
+double Histogram::getMean() const
+{
+	uint64_t n = getCount();
+	return n ? (double)sum.load(std::memory_order_relaxed) / n * 1e-6 : 0.0;
+}
+
+double Histogram::getPercentile(double p) const
+{
+	uint64_t n = getCount();
+	if(n == 0) {
+		return 0.0;
+	}
+	uint64_t rank = std::max((uint64_t)std::ceil(p * n), (uint64_t)1);
+	uint64_t seen = 0;
+	for(int i = 0; i < HIST_NUM_BUCKETS; i++) {
+		seen += buckets[i].load(std::memory_order_relaxed);
+		if(seen >= rank) {
+			// The bucket's top can overshoot the largest value actually seen
+			return std::min(bucketTop(i), max.load(std::memory_order_relaxed)) * 1e-6;
+		}
+	}
+	return getMax();
+}
@@ -0,0 +1,46 @@
+#pragma once
+#ifndef HISTOGRAM_H
+#define HISTOGRAM_H
+
+#include <atomic>
+#include <cstdint>
+
+#define HIST_SUB_BITS 5                               // 32 linear buckets per power of two, so within ~3%
+#define HIST_SUB_COUNT (1 << HIST_SUB_BITS)
+#define HIST_MAX_EXPONENT 40                          // Values up to 2^40 us (about 12 days)
+#define HIST_NUM_BUCKETS ((HIST_MAX_EXPONENT - HIST_SUB_BITS + 2) * HIST_SUB_COUNT)
+
+/**
+ * A log-bucketed histogram of durations in the style of HdrHistogram.
+ * Values are kept in whole microseconds: below HIST_SUB_COUNT each value has its own bucket,
+ * above that every power of two is split into HIST_SUB_COUNT equal buckets. Recording is a few
+ * shifts and an increment into a fixed array, so it never allocates.
+ * Only one thread may record into a histogram, but any thread may read it meanwhile; a reader
+ * racing a record() can see the count and the buckets one value apart.
+ */
+class Histogram
+{
+public:
+	Histogram();
+
+	void record(double seconds);
+	void reset();
+
+	uint64_t getCount() const { return count.load(std::memory_order_relaxed); }
+	// The smallest bucket bound that at least a fraction p of the values are under, in seconds
+	double getPercentile(double p) const;
+	double getMax() const { return max.load(std::memory_order_relaxed) * 1e-6; }
+	double getMean() const;
+
+private:
+	static int bucketOf(uint64_t us);
+	static uint64_t bucketTop(int bucket);
+
+	// Single writer, so a relaxed load and store is enough to bump these (no locked instructions)
+	std::atomic<uint64_t> buckets[HIST_NUM_BUCKETS];
+	std::atomic<uint64_t> count;
+	std::atomic<uint64_t> sum;
+	std::atomic<uint64_t> max;
+};
+
+#endif
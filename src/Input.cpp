@@ -0,0 +1,47 @@
+#include "Input.h"
+
+#include <GLFW/glfw3.h>
+
+Input::Input() :
+	dropped(0),
+	tOldest(-1.0)
+{
+}
+
+void Input::push(int key, int action)
+{
+	if (!valid(key) || action == GLFW_REPEAT){
+		return;
+	}
+
+	InputEvent e;
+	e.time = glfwGetTime();
+	e.key = key;
+	e.action = action;
+	if (!ring.push(e)){
+		dropped.fetch_add(1, std::memory_order_relaxed);
+	}
+}
+
+void Input::drain()
+{
+	down = held;
+	released.reset();
+	tOldest = -1.0;
+
+	InputEvent e;
+	while (ring.pop(e)){
+		if (tOldest < 0.0){
+			tOldest = e.time;
+		}
+
+		if (e.action == GLFW_PRESS){
+			held.set(e.key);
+			down.set(e.key);
+		}
+		else if (e.action == GLFW_RELEASE){
+			held.reset(e.key);
+			released.set(e.key);
+		}
+	}
+}
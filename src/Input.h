@@ -0,0 +1,59 @@
+#pragma once
+#ifndef INPUT_H
+#define INPUT_H
+
+#include <atomic>
+#include <bitset>
+
+#include "SpscRing.h"
+
+#define INPUT_NUM_KEYS 512
+#define INPUT_RING_SIZE 256
+
+struct InputEvent {
+	double time; // glfwGetTime() when the callback ran
+	int key;
+	int action;  // GLFW_PRESS or GLFW_RELEASE
+};
+
+/**
+ * Keyboard state for the simulation thread.
+ * The GLFW key callback pushes timestamped events into a lock-free ring; once per tick the
+ * simulation calls drain(), which replays them in order and rebuilds the key bitsets.
+ * A key that was pressed and released between two ticks still counts as down for one tick,
+ * so quick taps are not lost.
+ */
+class Input
+{
+public:
+	Input();
+
+	// Producer side (GLFW callback thread)
+	void push(int key, int action);
+
+	// Consumer side (simulation thread)
+	void drain();
+	// Held at some point since the last drain()
+	bool isDown(int key) const { return valid(key) && down[key]; }
+	// Released since the last drain()
+	bool wasReleased(int key) const { return valid(key) && released[key]; }
+	// Time of the oldest event in the last drain(), or -1 if there were none
+	double getOldestEventTime() const { return tOldest; }
+	const std::bitset<INPUT_NUM_KEYS> &getDown() const { return down; }
+
+	// Events lost because the simulation fell behind and the ring filled up
+	int getDroppedEvents() const { return dropped.load(std::memory_order_relaxed); }
+
+private:
+	static bool valid(int key) { return key >= 0 && key < INPUT_NUM_KEYS; }
+
+	SpscRing<InputEvent, INPUT_RING_SIZE> ring;
+	std::atomic<int> dropped;
+
+	std::bitset<INPUT_NUM_KEYS> held;     // Current physical state
+	std::bitset<INPUT_NUM_KEYS> down;     // held, plus keys tapped during the last tick
+	std::bitset<INPUT_NUM_KEYS> released;
+	double tOldest;
+};
+
+#endif
@@ -0,0 +1,77 @@
+#include "LatencyTracker.h"
+
+#include <algorithm>
+
+#include "Stats.h"
+
+LatencyTracker::LatencyTracker() :
+	hasNext(false),
+	frameInput(-1.0),
+	numInFlight(0)
+{
+}
+
+void LatencyTracker::stampInput(unsigned long tick, double tInput)
+{
+	LatencyStamp s;
+	s.tick = tick;
+	s.tInput = tInput;
+	// If the render thread stalls long enough to fill the ring, the newest stamps are lost
+	stamps.push(s);
+}
+
+void LatencyTracker::beginFrame(unsigned long tick)
+{
+	frameInput = -1.0;
+	while(hasNext || stamps.pop(next)) {
+		if(next.tick > tick) {
+			hasNext = true;
+			return;
+		}
+		hasNext = false;
+		if(frameInput < 0.0 || next.tInput < frameInput) {
+			frameInput = next.tInput;
+		}
+	}
+}
+
+void LatencyTracker::present(double tPresent)
+{
+	if(frameInput >= 0.0) {
+		record(frameInput, tPresent);
+		frameInput = -1.0;
+	}
+}
+
+void LatencyTracker::fence()
+{
+	if(frameInput < 0.0 || numInFlight == LATENCY_MAX_IN_FLIGHT) {
+		return;
+	}
+	inFlight[numInFlight].sync = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+	inFlight[numInFlight].tInput = frameInput;
+	numInFlight++;
+	frameInput = -1.0;
+}
+
+void LatencyTracker::poll(double t)
+{
+	// Fences signal in order, so stop at the first one that hasn't
+	int done = 0;
+	while(done < numInFlight) {
+		GLenum status = glClientWaitSync(inFlight[done].sync, 0, 0);
+		if(status != GL_ALREADY_SIGNALED && status != GL_CONDITION_SATISFIED) {
+			break;
+		}
+		record(inFlight[done].tInput, t);
+		glDeleteSync(inFlight[done].sync);
+		done++;
+	}
+	std::copy(inFlight + done, inFlight + numInFlight, inFlight);
+	numInFlight -= done;
+}
+
+void LatencyTracker::record(double tInput, double tPresent)
+{
+	Stats::record(STAT_INPUT_LATENCY, tPresent - tInput);
+}
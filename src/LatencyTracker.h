@@ -0,0 +1,59 @@
+#pragma once
+#ifndef LATENCY_TRACKER_H
+#define LATENCY_TRACKER_H
+
+#define GLEW_STATIC
+#include <GL/glew.h>
+
+#include "SpscRing.h"
+
+#define LATENCY_STAMP_RING 64     // Ticks with input the render thread hasn't shown yet
+#define LATENCY_MAX_IN_FLIGHT 4   // Frames waiting on their fence
+
+// Input that was consumed by a simulation tick
+struct LatencyStamp {
+	unsigned long tick;
+	double tInput; // Oldest key event the tick consumed
+};
+
+/**
+ * Measures input-to-photon latency: the time from a key event to the end of the GPU work for the
+ * first frame that shows the tick which consumed it.
+ * The simulation thread stamps ticks that consumed input. The render thread calls beginFrame()
+ * with the tick it is about to draw and, after swapping, either present() once glFinish()
+ * returned or fence() to drop a sync object that is checked by poll() on later frames.
+ * A signaled fence is only noticed on the next poll(), so fenced samples can read up to one
+ * frame long. Samples go to the STAT_INPUT_LATENCY histogram.
+ * Fences still in flight at exit are left to die with the context.
+ */
+class LatencyTracker
+{
+public:
+	LatencyTracker();
+
+	// Simulation thread
+	void stampInput(unsigned long tick, double tInput);
+
+	// Render thread
+	void beginFrame(unsigned long tick);
+	void present(double tPresent);
+	void fence();
+	void poll(double t);
+
+private:
+	void record(double tInput, double tPresent);
+
+	SpscRing<LatencyStamp, LATENCY_STAMP_RING> stamps;
+	LatencyStamp next;     // Popped, but its tick hasn't been drawn yet
+	bool hasNext;
+	double frameInput;     // Oldest input shown for the first time in the current frame, or -1
+
+	struct InFlight {
+		GLsync sync;
+		double tInput;
+	};
+	InFlight inFlight[LATENCY_MAX_IN_FLIGHT];
+	int numInFlight;
+};
+
+#endif
@@ -0,0 +1,300 @@
+#include "LineRenderer.h"
+
+#include "GLSL.h"
+#include "Program.h"
+#include "GLState.h"
+#include "Star.h"
+#include "Projectiles.h"
+
+#include <algorithm>
+#include <cstddef>
+
+#include <glm/gtc/type_ptr.hpp>
+
+using namespace std;
+
+LineRenderer::LineRenderer() :
+	staticBufID(0),
+	beamBufID(0),
+	staticVaoID(0),
+	beamVaoID(0),
+	projBufID(0),
+	projVaoID(0),
+	projBufCapacity(0),
+	maxLineWidth(1.0f),
+	projectiles(NULL),
+	numProjectiles(0),
+	projectileDt(0.0f)
+{
+}
+
+LineRenderer::~LineRenderer()
+{
+}
+
+void LineRenderer::pushVertex(vector<float> &buf, const glm::vec3 &p, const glm::vec3 &c, float size)
+{
+	buf.push_back(p.x);
+	buf.push_back(p.y);
+	buf.push_back(p.z);
+	buf.push_back(c.r);
+	buf.push_back(c.g);
+	buf.push_back(c.b);
+	buf.push_back(size);
+}
+
+// Records the interleaved attribute layout of a buffer in a vertex array object
+GLuint LineRenderer::createVAO(GLuint bufID)
+{
+	GLuint vaoID;
+	GLsizei stride = LINE_VERTEX_SIZE * sizeof(float);
+
+	glGenVertexArrays(1, &vaoID);
+	GLState::bindVertexArray(vaoID);
+	GLState::bindArrayBuffer(bufID);
+	glEnableVertexAttribArray(ATTRIB_POS);
+	glVertexAttribPointer(ATTRIB_POS, 3, GL_FLOAT, GL_FALSE, stride, (const void *)0);
+	glEnableVertexAttribArray(ATTRIB_COL);
+	glVertexAttribPointer(ATTRIB_COL, 3, GL_FLOAT, GL_FALSE, stride, (const void *)(3*sizeof(float)));
+	glEnableVertexAttribArray(ATTRIB_SCA);
+	glVertexAttribPointer(ATTRIB_SCA, 1, GL_FLOAT, GL_FALSE, stride, (const void *)(6*sizeof(float)));
+	GLState::bindVertexArray(0);
+
+	return vaoID;
+}
+
+void LineRenderer::init(const string &SHADER_DIR, const vector<shared_ptr<Star> > &stars)
+{
+	prog = make_shared<LineProgram>();
+	prog->setShaderNames(SHADER_DIR + "line_vert.glsl", SHADER_DIR + "line_frag.glsl");
+	prog->setVerbose(true);
+	prog->init();
+	prog->addAttribute("aPos");
+	prog->addAttribute("aCol");
+	prog->addAttribute("aSca");
+	prog->setVerbose(false);
+
+	vector<float> buf;
+
+	// Stars are points with their own size. The old immediate-mode path translated by the
+	// star's position and then emitted the vertex at that position, so the sphere of stars
+	// was twice STAR_RADIUS. We keep that look here.
+	starRange.first = buf.size() / LINE_VERTEX_SIZE;
+	for (auto s = stars.begin(); s != stars.end(); ++s){
+		pushVertex(buf, 2.0f * (*s)->pos, glm::vec3(1.0f, 1.0f, 1.0f), (*s)->size);
+	}
+	starRange.count = buf.size() / LINE_VERTEX_SIZE - starRange.first;
+
+	// Grid lines
+	glm::vec3 gridCol(0.1f, 0.5f, 0.1f);
+	gridRange.first = buf.size() / LINE_VERTEX_SIZE;
+	for(int i = 0; i < GRID_NX+1; ++i) {
+		float alpha = i / (float)GRID_NX;
+		float x = (1.0f - alpha) * (-GRID_SIZE_HALF) + alpha * GRID_SIZE_HALF;
+		pushVertex(buf, glm::vec3(x, GRID_OFFSET, -GRID_SIZE_HALF), gridCol, 1.0f);
+		pushVertex(buf, glm::vec3(x, GRID_OFFSET,  GRID_SIZE_HALF), gridCol, 1.0f);
+	}
+	for(int i = 0; i < GRID_NZ+1; ++i) {
+		float alpha = i / (float)GRID_NZ;
+		float z = (1.0f - alpha) * (-GRID_SIZE_HALF) + alpha * GRID_SIZE_HALF;
+		pushVertex(buf, glm::vec3(-GRID_SIZE_HALF, GRID_OFFSET, z), gridCol, 1.0f);
+		pushVertex(buf, glm::vec3( GRID_SIZE_HALF, GRID_OFFSET, z), gridCol, 1.0f);
+	}
+	gridRange.count = buf.size() / LINE_VERTEX_SIZE - gridRange.first;
+
+	// Axis frame
+	axisRange.first = buf.size() / LINE_VERTEX_SIZE;
+	for (int i = 0; i < 3; i++){
+		glm::vec3 axis(0.0f);
+		axis[i] = 1.0f;
+		pushVertex(buf, glm::vec3(0.0f), axis, 1.0f);
+		pushVertex(buf, axis, axis, 1.0f);
+	}
+	axisRange.count = buf.size() / LINE_VERTEX_SIZE - axisRange.first;
+
+	// Send the static geometry to the GPU
+	glGenBuffers(1, &staticBufID);
+	GLState::bindArrayBuffer(staticBufID);
+	glBufferData(GL_ARRAY_BUFFER, buf.size()*sizeof(float), &buf[0], GL_STATIC_DRAW);
+
+	// The beam buffer holds two vertices per beam and is refilled every frame
+	beamBuf.reserve(2 * PROJECTILE_BUFFER_MIN * LINE_VERTEX_SIZE);
+	glGenBuffers(1, &beamBufID);
+	GLState::bindArrayBuffer(beamBufID);
+	glBufferData(GL_ARRAY_BUFFER, beamBuf.capacity()*sizeof(float), NULL, GL_DYNAMIC_DRAW);
+
+	if (coreProfile){
+		staticVaoID = createVAO(staticBufID);
+		beamVaoID = createVAO(beamBufID);
+
+		projProg = make_shared<ProjectileProgram>();
+		projProg->setShaderNames(SHADER_DIR + "projectile_vert.glsl", SHADER_DIR + "line_frag.glsl");
+		projProg->setVerbose(true);
+		projProg->init();
+		projProg->addAttribute("aPos");
+		projProg->addAttribute("aNor");
+		projProg->addAttribute("aSca");
+		projProg->setVerbose(false);
+		projProg->bind();
+		projProg->u.beamSpeed.set(BEAM_SPEED);
+		projProg->u.beamLength.set(BEAM_LENGTH);
+		projProg->u.beamLife.set((float)BEAM_LIFE);
+		projProg->unbind();
+
+		// One ProjectileInstance per instance, straight out of the snapshot
+		projBufCapacity = PROJECTILE_BUFFER_MIN;
+		glGenBuffers(1, &projBufID);
+		GLState::bindArrayBuffer(projBufID);
+		glBufferData(GL_ARRAY_BUFFER, projBufCapacity*sizeof(ProjectileInstance), NULL, GL_DYNAMIC_DRAW);
+
+		GLsizei stride = sizeof(ProjectileInstance);
+		glGenVertexArrays(1, &projVaoID);
+		GLState::bindVertexArray(projVaoID);
+		GLState::bindArrayBuffer(projBufID);
+		glEnableVertexAttribArray(ATTRIB_POS);
+		glVertexAttribPointer(ATTRIB_POS, 3, GL_FLOAT, GL_FALSE, stride, (const void *)offsetof(ProjectileInstance, start));
+		glVertexAttribDivisor(ATTRIB_POS, 1);
+		glEnableVertexAttribArray(ATTRIB_NOR);
+		glVertexAttribPointer(ATTRIB_NOR, 3, GL_FLOAT, GL_FALSE, stride, (const void *)offsetof(ProjectileInstance, dir));
+		glVertexAttribDivisor(ATTRIB_NOR, 1);
+		glEnableVertexAttribArray(ATTRIB_SCA);
+		glVertexAttribPointer(ATTRIB_SCA, 1, GL_FLOAT, GL_FALSE, stride, (const void *)offsetof(ProjectileInstance, age));
+		glVertexAttribDivisor(ATTRIB_SCA, 1);
+		GLState::bindVertexArray(0);
+	}
+
+	GLState::bindArrayBuffer(0);
+
+	// Forward-compatible contexts only allow a line width of 1
+	GLfloat range[2] = {1.0f, 1.0f};
+	glGetFloatv(GL_ALIASED_LINE_WIDTH_RANGE, range);
+	maxLineWidth = range[1];
+
+	GLSL::checkError(GET_FILE_LINE);
+}
+
+void LineRenderer::addBeam(const glm::vec3 &start, const glm::vec3 &end, const glm::vec3 &col)
+{
+	pushVertex(beamBuf, start, col, 1.0f);
+	pushVertex(beamBuf, end, col, 1.0f);
+}
+
+void LineRenderer::setProjectiles(const vector<ProjectileInstance> &p, float dt)
+{
+	if (projProg){
+		projectiles = p.empty() ? NULL : &p[0];
+		numProjectiles = p.size();
+		projectileDt = dt;
+		return;
+	}
+
+	// The same placement as projectile_vert.glsl
+	for (auto b = p.begin(); b != p.end(); ++b){
+		float age = std::max(b->age + dt, 0.0f);
+		glm::vec3 start = b->start + (age - b->age) * BEAM_SPEED * b->dir;
+		glm::vec3 col(1.0f - age / (float)BEAM_LIFE, 0.0f, 0.0f);
+		addBeam(start, start + BEAM_LENGTH * b->dir, col);
+	}
+}
+
+void LineRenderer::setLineWidth(float w) const
+{
+	glLineWidth(std::min(w, maxLineWidth));
+}
+
+void LineRenderer::drawRange(GLuint bufID, GLuint vaoID, GLenum mode, const Range &r)
+{
+	if (r.count == 0){ return; }
+
+	if (vaoID != 0){
+		GLState::bindVertexArray(vaoID);
+		glDrawArrays(mode, r.first, r.count);
+		return;
+	}
+
+	GLint h_pos = prog->getAttribute(ATTRIB_POS);
+	GLint h_col = prog->getAttribute(ATTRIB_COL);
+	GLint h_sca = prog->getAttribute(ATTRIB_SCA);
+	GLsizei stride = LINE_VERTEX_SIZE * sizeof(float);
+
+	unsigned mask = (1u << h_pos) | (1u << h_col);
+	if (h_sca != -1){
+		mask |= 1u << h_sca;
+	}
+	GLState::setAttribArrays(mask);
+
+	GLState::bindArrayBuffer(bufID);
+	glVertexAttribPointer(h_pos, 3, GL_FLOAT, GL_FALSE, stride, (const void *)0);
+	glVertexAttribPointer(h_col, 3, GL_FLOAT, GL_FALSE, stride, (const void *)(3*sizeof(float)));
+	if (h_sca != -1){
+		glVertexAttribPointer(h_sca, 1, GL_FLOAT, GL_FALSE, stride, (const void *)(6*sizeof(float)));
+	}
+
+	glDrawArrays(mode, r.first, r.count);
+}
+
+void LineRenderer::draw(const glm::mat4 &P, const glm::mat4 &MV, bool drawGrid, bool drawAxisFrame)
+{
+	prog->bind();
+	GLState::disable(GL_BLEND);
+	GLState::depthMask(GL_TRUE);
+	prog->u.P.set(P);
+	prog->u.MV.set(MV);
+
+	// Draw the stars
+	drawRange(staticBufID, staticVaoID, GL_POINTS, starRange);
+
+	// Draw the beams. Orphan the old storage so the driver doesn't have to wait on the last frame.
+	if (!beamBuf.empty()){
+		GLState::bindArrayBuffer(beamBufID);
+		glBufferData(GL_ARRAY_BUFFER, beamBuf.capacity()*sizeof(float), NULL, GL_DYNAMIC_DRAW);
+		glBufferSubData(GL_ARRAY_BUFFER, 0, beamBuf.size()*sizeof(float), &beamBuf[0]);
+
+		Range beamRange;
+		beamRange.count = beamBuf.size() / LINE_VERTEX_SIZE;
+		setLineWidth(BEAM_THICKNESS);
+		drawRange(beamBufID, beamVaoID, GL_LINES, beamRange);
+		beamBuf.clear();
+	}
+
+	// Draw frame
+	if (drawAxisFrame){
+		setLineWidth(2.0f);
+		drawRange(staticBufID, staticVaoID, GL_LINES, axisRange);
+	}
+
+	// Draw grid
+	if (drawGrid){
+		setLineWidth(1.0f);
+		drawRange(staticBufID, staticVaoID, GL_LINES, gridRange);
+	}
+
+	if (numProjectiles > 0){
+		drawProjectiles(MV);
+	}
+
+	setLineWidth(1.0f);
+
+	GLSL::checkError(GET_FILE_LINE);
+}
+
+void LineRenderer::drawProjectiles(const glm::mat4 &MV)
+{
+	// Grow by doubling, otherwise orphan the old storage like the beam buffer
+	GLState::bindArrayBuffer(projBufID);
+	if (numProjectiles > projBufCapacity){
+		projBufCapacity = std::max(numProjectiles, 2 * projBufCapacity);
+	}
+	glBufferData(GL_ARRAY_BUFFER, projBufCapacity*sizeof(ProjectileInstance), NULL, GL_DYNAMIC_DRAW);
+	glBufferSubData(GL_ARRAY_BUFFER, 0, numProjectiles*sizeof(ProjectileInstance), projectiles);
+
+	projProg->bind();
+	projProg->u.MV.set(MV);
+	projProg->u.dt.set(projectileDt);
+	setLineWidth(BEAM_THICKNESS);
+	GLState::bindVertexArray(projVaoID);
+	glDrawArraysInstanced(GL_LINES, 0, 2, (GLsizei)numProjectiles);
+
+	projectiles = NULL;
+	numProjectiles = 0;
+}
@@ -0,0 +1,93 @@
+#pragma once
+#ifndef LINE_RENDERER_H
+#define LINE_RENDERER_H
+
+#include <memory>
+#include <string>
+#include <vector>
+
+#define GLEW_STATIC
+#include <GL/glew.h>
+
+#define GLM_FORCE_RADIANS
+#include <glm/glm.hpp>
+
+#include "Uniforms.h"
+
+struct Star;
+struct ProjectileInstance;
+
+// Floats per vertex: position (3), color (3), point size (1)
+#define LINE_VERTEX_SIZE 7
+#define PROJECTILE_BUFFER_MIN 1024 // Beams the instance buffer starts out with room for
+
+#define GRID_SIZE_HALF 115.0f
+#define GRID_OFFSET -5.0f
+#define GRID_NX 20
+#define GRID_NZ 20
+
+/**
+ * Draws the stars, beams, grid and axis frame through a GLSL program instead of glBegin/glEnd.
+ * - The stars, grid and axis frame never change, so they share one static VBO.
+ * - On a core profile the snapshot's projectiles are uploaded as they are, one instance each, and
+ *   the vertex shader moves them to the frame's time. The compatibility path has no instancing,
+ *   so it works out their segments here and draws them with the addBeam() lines.
+ * - Other lines are collected with addBeam() and uploaded into one dynamic VBO per frame.
+ * Each group is drawn with a single draw call.
+ */
+class LineRenderer
+{
+public:
+	LineRenderer();
+	virtual ~LineRenderer();
+
+	void init(const std::string &SHADER_DIR, const std::vector<std::shared_ptr<Star> > &stars);
+
+	// Queues a beam segment to be drawn by the next call to draw()
+	void addBeam(const glm::vec3 &start, const glm::vec3 &end, const glm::vec3 &col);
+	// Draws these projectiles, dt seconds after their snapshot, in the next call to draw().
+	// They aren't copied, so they have to stay put until then.
+	void setProjectiles(const std::vector<ProjectileInstance> &projectiles, float dt);
+
+	std::shared_ptr<LineProgram> getProgram() { return prog; }
+	// Null on the compatibility path
+	std::shared_ptr<ProjectileProgram> getProjectileProgram() { return projProg; }
+
+	void draw(const glm::mat4 &P, const glm::mat4 &MV, bool drawGrid, bool drawAxisFrame);
+
+private:
+	struct Range {
+		GLint first = 0;
+		GLsizei count = 0;
+	};
+
+	static void pushVertex(std::vector<float> &buf, const glm::vec3 &p, const glm::vec3 &c, float size);
+	static GLuint createVAO(GLuint bufID);
+	void setLineWidth(float w) const;
+	void drawRange(GLuint bufID, GLuint vaoID, GLenum mode, const Range &r);
+	void drawProjectiles(const glm::mat4 &MV);
+
+	std::shared_ptr<LineProgram> prog;
+	std::shared_ptr<ProjectileProgram> projProg;
+
+	GLuint staticBufID;
+	GLuint beamBufID;
+	GLuint staticVaoID; // Only used on a core profile
+	GLuint beamVaoID;
+	GLuint projBufID;
+	GLuint projVaoID;
+	size_t projBufCapacity; // In projectiles
+	float maxLineWidth;
+
+	Range starRange;
+	Range gridRange;
+	Range axisRange;
+
+	std::vector<float> beamBuf;
+
+	const ProjectileInstance *projectiles;
+	size_t numProjectiles;
+	float projectileDt;
+};
+
+#endif
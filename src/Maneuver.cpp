@@ -0,0 +1,221 @@
+#include "Maneuver.h"
+#include "Ship.h"
+#include "ShipKeyframe.h"
+#include "SplineMatrix.h"
+
+#include <algorithm>
+#include <cassert>
+#include <cmath>
+#include <vector>
+
+#define GLM_FORCE_RADIANS
+#include <glm/gtc/quaternion.hpp>
+
+namespace Maneuvers {
+
+	struct Sample
+	{
+		glm::vec3 p; // Offset from where the maneuver started, for a unit of 1
+		glm::quat q;
+	};
+
+	// Stored as separate arrays so batched lookups read contiguous floats
+	struct Table
+	{
+		float px[MANEUVER_SAMPLES], py[MANEUVER_SAMPLES], pz[MANEUVER_SAMPLES];
+		float qx[MANEUVER_SAMPLES], qy[MANEUVER_SAMPLES], qz[MANEUVER_SAMPLES], qw[MANEUVER_SAMPLES];
+	};
+
+	// Indexed by animation, starting from SOMERSAULT
+	static Table tables[3];
+	static bool baked = false;
+
+	static Table &getTable(int anim)
+	{
+		assert(anim == SOMERSAULT || anim == LEFT_ROLL || anim == RIGHT_ROLL);
+		return tables[anim - SOMERSAULT];
+	}
+
+	// The control points of a maneuver, for a unit of 1
+	static std::vector<ShipKeyframe> createKeyframes(int anim)
+	{
+		glm::vec3 xAxis = glm::vec3(1, 0, 0);
+		glm::vec3 zAxis = glm::vec3(0, 0, 1);
+		float unit = 1.0f;
+		std::vector<ShipKeyframe> k(MANEUVER_SEGMENTS + 3);
+
+		switch(anim){
+			case(SOMERSAULT):{
+				// Control point behind the current position. Same orientation
+				k[0] = ShipKeyframe(glm::vec3(0, 0, 0), glm::angleAxis(0.0f, xAxis));
+				// Control point that is the current position. Same orientation
+				k[1] = ShipKeyframe(glm::vec3(0, 0, 0), glm::angleAxis(0.0f, xAxis));
+				// Control point that is one unit on top and one unit in front. (Ship facing upward)
+				k[2] = ShipKeyframe(glm::vec3(0.0f, unit / 2.0f, unit / 2.0f), glm::angleAxis(-(float)M_PI_2, xAxis));
+				// Control point at the top (Upside down orientation)
+				k[3] = ShipKeyframe(glm::vec3(0.0f, unit, 0.0f), glm::angleAxis(-(float)M_PI, xAxis));
+				// Control point that is one unit on top and one unit behind. (Ship facing downward)
+				k[4] = ShipKeyframe(glm::vec3(0.0f, unit / 2.0f, -unit / 2.0f), glm::angleAxis(-(float)M_PI -(float)M_PI_2, xAxis));
+				// Control point that is the current position. Same orientation
+				k[5] = ShipKeyframe(glm::vec3(0, 0, 0), glm::angleAxis(0.0f, xAxis));
+				// Control point in front of the current position. Same orientation
+				k[6] = ShipKeyframe(glm::vec3(0, 0, 0), glm::angleAxis(0.0f, xAxis));
+				break;
+			}
+
+			case(LEFT_ROLL):
+			case(RIGHT_ROLL):{
+				// A right roll mirrors the left one
+				float side = (anim == LEFT_ROLL) ? 1.0f : -1.0f;
+				float quarter = (anim == LEFT_ROLL) ? 5.0f * (float)M_PI_4 : (float)M_PI_4;
+				float threeQuarters = (anim == LEFT_ROLL) ? (float)M_PI_4 : 5.0f * (float)M_PI_4;
+
+				// Two control frames at the original position of the ship
+				k[0] = ShipKeyframe(glm::vec3(0, 0, 0), glm::angleAxis(0.0f, zAxis));
+				k[1] = ShipKeyframe(glm::vec3(0, 0, 0), glm::angleAxis(0.0f, zAxis));
+				// Control frames 1/4, 2/4 and 3/4 of the way there, rotating about the Z axis
+				k[2] = ShipKeyframe(glm::vec3(side * ROLL_FACTOR * unit / 4.0f, 0, 0), glm::angleAxis(quarter, zAxis));
+				k[3] = ShipKeyframe(glm::vec3(side * ROLL_FACTOR * unit / 2.0f, 0, 0), glm::angleAxis((float)M_PI, zAxis));
+				k[4] = ShipKeyframe(glm::vec3(side * ROLL_FACTOR * 3.0f * unit / 4.0f, 0, 0), glm::angleAxis(threeQuarters, zAxis));
+				// Two control frames at the position of the ship translated by ROLL_FACTOR units in the x axis
+				k[5] = ShipKeyframe(glm::vec3(side * ROLL_FACTOR * unit, 0, 0), glm::angleAxis(0.0f, zAxis));
+				k[6] = ShipKeyframe(glm::vec3(side * ROLL_FACTOR * unit, 0, 0), glm::angleAxis(0.0f, zAxis));
+				break;
+			}
+		}
+
+		// Make sure adjacent quaternions will not do the 'twirl' between each other
+		for (size_t i = 0; i + 1 < k.size(); i++){
+			if (glm::dot(k[i].getQuat(), k[i + 1].getQuat()) <= 0.0f){
+				k[i + 1].setQuat(-1.0f * k[i + 1].getQuat());
+			}
+		}
+
+		return k;
+	}
+
+	// Evaluates the Catmull-Rom spline through the keyframes at u (0 to MANEUVER_SEGMENTS)
+	static Sample evaluateSpline(std::vector<ShipKeyframe> &k, float u)
+	{
+		int i = std::min((int)u, MANEUVER_SEGMENTS - 1);
+		float u_hat = u - i;
+		const glm::mat4 &B = createCatmull();
+		glm::vec4 uVec(1.0f, u_hat, u_hat * u_hat, u_hat * u_hat * u_hat);
+		glm::vec4 Bu = B * uVec;
+
+		glm::mat4 G(0);
+		for (int c = 0; c < 4; c++){
+			glm::quat q = k[i + c].getQuat();
+			G[c] = glm::vec4(q.x, q.y, q.z, q.w);
+		}
+		glm::vec4 qVec = G * Bu;
+
+		for (int c = 0; c < 4; c++){
+			G[c] = glm::vec4(k[i + c].getPos(), 0.0f);
+		}
+
+		Sample s;
+		s.p = glm::vec3(G * Bu);
+		s.q = glm::normalize(glm::quat(qVec[3], qVec[0], qVec[1], qVec[2])); // Constructor argument order: (w, x, y, z)
+		return s;
+	}
+
+	static void bakeManeuver(int anim)
+	{
+		std::vector<ShipKeyframe> k = createKeyframes(anim);
+		Table &table = getTable(anim);
+
+		// A dense table of (u, s) pairs, s being the arc length travelled by u
+		const int steps = MANEUVER_SEGMENTS * MANEUVER_ARC_STEPS;
+		std::vector<float> us(steps + 1);
+		std::vector<float> ss(steps + 1);
+		glm::vec3 prev = evaluateSpline(k, 0.0f).p;
+		us[0] = ss[0] = 0.0f;
+		for (int i = 1; i <= steps; i++){
+			us[i] = (float)MANEUVER_SEGMENTS * i / steps;
+			glm::vec3 p = evaluateSpline(k, us[i]).p;
+			ss[i] = ss[i - 1] + glm::length(p - prev);
+			prev = p;
+		}
+		float smax = ss[steps];
+
+		// Invert it at equally spaced arc lengths
+		int j = 0;
+		glm::quat qPrev;
+		for (int i = 0; i < MANEUVER_SAMPLES; i++){
+			float s = smax * i / (MANEUVER_SAMPLES - 1);
+			while (j < steps - 1 && ss[j + 1] < s){
+				j++;
+			}
+			float ds = ss[j + 1] - ss[j];
+			float a = (ds > 0.0f) ? glm::clamp((s - ss[j]) / ds, 0.0f, 1.0f) : 0.0f;
+			Sample sample = evaluateSpline(k, us[j] + a * (us[j + 1] - us[j]));
+
+			// Keep neighbouring samples in the same hemisphere so that blending takes the short way
+			if (i > 0 && glm::dot(qPrev, sample.q) < 0.0f){
+				sample.q = -1.0f * sample.q;
+			}
+			qPrev = sample.q;
+
+			table.px[i] = sample.p.x;
+			table.py[i] = sample.p.y;
+			table.pz[i] = sample.p.z;
+			table.qx[i] = sample.q.x;
+			table.qy[i] = sample.q.y;
+			table.qz[i] = sample.q.z;
+			table.qw[i] = sample.q.w;
+		}
+	}
+
+	// Blends samples i and i + 1. They are so close together that a normalized lerp matches slerp.
+	static glm::mat4 blend(const Table &table, int i, float a, float unit)
+	{
+		glm::quat q(
+			table.qw[i] + a * (table.qw[i + 1] - table.qw[i]),
+			table.qx[i] + a * (table.qx[i + 1] - table.qx[i]),
+			table.qy[i] + a * (table.qy[i + 1] - table.qy[i]),
+			table.qz[i] + a * (table.qz[i + 1] - table.qz[i]));
+
+		glm::mat4 E = glm::mat4_cast(glm::normalize(q));
+		E[3] = glm::vec4(
+			unit * (table.px[i] + a * (table.px[i + 1] - table.px[i])),
+			unit * (table.py[i] + a * (table.py[i + 1] - table.py[i])),
+			unit * (table.pz[i] + a * (table.pz[i + 1] - table.pz[i])),
+			1.0f);
+		return E;
+	}
+
+	void bake()
+	{
+		bakeManeuver(SOMERSAULT);
+		bakeManeuver(LEFT_ROLL);
+		bakeManeuver(RIGHT_ROLL);
+		baked = true;
+	}
+
+	glm::mat4 evaluate(int anim, float progress, float unit)
+	{
+		assert(baked);
+		float x = glm::clamp(progress, 0.0f, 1.0f) * (MANEUVER_SAMPLES - 1);
+		int i = std::min((int)x, MANEUVER_SAMPLES - 2);
+		return blend(getTable(anim), i, x - i, unit);
+	}
+
+	void evaluate(int n, const int *anim, const float *progress, const float *unit, int *index, float *weight, glm::mat4 *E)
+	{
+		assert(baked);
+
+		// Straight-line float math over the whole batch first, so the compiler can vectorize it
+		for (int k = 0; k < n; k++){
+			float x = std::min(std::max(progress[k], 0.0f), 1.0f) * (MANEUVER_SAMPLES - 1);
+			int i = std::min((int)x, MANEUVER_SAMPLES - 2);
+			index[k] = i;
+			weight[k] = x - i;
+		}
+
+		for (int k = 0; k < n; k++){
+			E[k] = blend(getTable(anim[k]), index[k], weight[k], unit[k]);
+		}
+	}
+
+}
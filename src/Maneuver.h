@@ -0,0 +1,36 @@
+#pragma once
+#ifndef MANEUVER_H
+#define MANEUVER_H
+
+#define GLM_FORCE_RADIANS
+#include <glm/glm.hpp>
+
+// The higher the factor, the more distance the rolls will cover (in units)
+#define ROLL_FACTOR 3.0f
+// Catmull-Rom segments in each maneuver. A maneuver plays out after MANEUVER_SEGMENTS spline units.
+#define MANEUVER_SEGMENTS 4
+// Samples per segment when measuring arc length
+#define MANEUVER_ARC_STEPS 64
+// Constant-speed samples kept for each maneuver
+#define MANEUVER_SAMPLES 256
+
+/**
+ * The ship's keyframed maneuvers (SOMERSAULT, LEFT_ROLL and RIGHT_ROLL), baked once at startup.
+ * Each is sampled at equal arc lengths along its Catmull-Rom path, so the ship moves at a
+ * constant speed through it. Positions are baked for a unit of 1 and scaled on lookup, since
+ * every control point is a multiple of the ship's unit.
+ */
+namespace Maneuvers {
+
+	// Must run before the first evaluate(), and before the sim thread starts
+	void bake();
+
+	// The maneuver transform at progress (0 to 1), as a rotation with the offset in the last column
+	glm::mat4 evaluate(int anim, float progress, float unit);
+
+	// Evaluates n maneuvers at once into E. index and weight are scratch space for n entries each.
+	void evaluate(int n, const int *anim, const float *progress, const float *unit, int *index, float *weight, glm::mat4 *E);
+
+}
+
+#endif
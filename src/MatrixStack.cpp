@@ -1,8 +1,6 @@
 #include "MatrixStack.h"
 
 #include <stdio.h>
-#include <cassert>
-#include <vector>
 
 #define GLM_FORCE_RADIANS
 #include <glm/glm.hpp>
@@ -10,84 +8,9 @@
 
 using namespace std;
 
-MatrixStack::MatrixStack()
+void MatrixStack::rotateGeneral(float angle, const glm::vec3 &axis)
 {
-	mstack = make_shared< stack<glm::mat4> >();
-	mstack->push(glm::mat4(1.0));
-}
-
-MatrixStack::~MatrixStack()
-{
-}
-
-void MatrixStack::pushMatrix()
-{
-	const glm::mat4 &top = mstack->top();
-	mstack->push(top);
-	assert(mstack->size() < 100);
-}
-
-void MatrixStack::popMatrix()
-{
-	assert(!mstack->empty());
-	mstack->pop();
-	// There should always be one matrix left.
-	assert(!mstack->empty());
-}
-
-void MatrixStack::loadIdentity()
-{
-	glm::mat4 &top = mstack->top();
-	top = glm::mat4(1.0);
-}
-
-void MatrixStack::translate(const glm::vec3 &t)
-{
-	glm::mat4 &top = mstack->top();
-	top *= glm::translate(glm::mat4(1.0f), t);
-}
-
-void MatrixStack::translate(float x, float y, float z)
-{
-	translate(glm::vec3(x, y, z));
-}
-
-void MatrixStack::scale(const glm::vec3 &s)
-{
-	glm::mat4 &top = mstack->top();
-	top *= glm::scale(glm::mat4(1.0f), s);
-}
-
-void MatrixStack::scale(float x, float y, float z)
-{
-	scale(glm::vec3(x, y, z));
-}
-
-void MatrixStack::scale(float s)
-{
-	scale(glm::vec3(s, s, s));
-}
-
-void MatrixStack::rotate(float angle, const glm::vec3 &axis)
-{
-	glm::mat4 &top = mstack->top();
-	top *= glm::rotate(glm::mat4(1.0f), angle, axis);
-}
-
-void MatrixStack::rotate(float angle, float x, float y, float z)
-{
-	rotate(angle, glm::vec3(x, y, z));
-}
-
-void MatrixStack::multMatrix(const glm::mat4 &matrix)
-{
-	glm::mat4 &top = mstack->top();
-	top *= matrix;
-}
-
-const glm::mat4 &MatrixStack::topMatrix() const
-{
-	return mstack->top();
+	top() *= glm::rotate(glm::mat4(1.0f), angle, axis);
 }
 
 void MatrixStack::print(const glm::mat4 &mat, const char *name)
@@ -110,5 +33,5 @@ void MatrixStack::print(const glm::mat4 &mat, const char *name)
 
 void MatrixStack::print(const char *name) const
 {
-	print(mstack->top(), name);
+	print(mstack[count - 1], name);
 }
@@ -2,49 +2,118 @@
 #ifndef MatrixStack_H
 #define MatrixStack_H
 
-#include <stack>
+#include <cassert>
+#include <cmath>
 #include <memory>
-#include <glm/fwd.hpp>
 
+#define GLM_FORCE_RADIANS
+#include <glm/glm.hpp>
+
+// Deepest nesting of pushMatrix() calls. The matrices live inline, so a stack never allocates.
+#define MATRIX_STACK_DEPTH 16
+
+/**
+ * The transforms below right multiply the top matrix like the old fixed-function calls did,
+ * but they only touch the columns that change: a translation updates the last column, a scale
+ * scales the first three, and a rotation about x, y or z mixes two of them. Only rotations about
+ * other axes and multMatrix() do a full 4x4 multiply.
+ */
 class MatrixStack
 {
 public:
-	MatrixStack();
-	virtual ~MatrixStack();
-	
+	MatrixStack() : count(1) { mstack[0] = glm::mat4(1.0f); }
+	virtual ~MatrixStack() {}
+
 	// glPushMatrix(): Copies the current matrix and adds it to the top of the stack
-	void pushMatrix();
+	void pushMatrix()
+	{
+		assert(count < MATRIX_STACK_DEPTH);
+		mstack[count] = mstack[count - 1];
+		count++;
+	}
 	// glPopMatrix(): Removes the top of the stack and sets the current matrix to be the matrix that is now on top
-	void popMatrix();
-	
+	void popMatrix()
+	{
+		// There should always be one matrix left.
+		assert(count > 1);
+		count--;
+	}
+
 	// glLoadIdentity(): Sets the top matrix to be the identity
-	void loadIdentity();
+	void loadIdentity() { top() = glm::mat4(1.0f); }
 	// glMultMatrix(): Right multiplies the top matrix
-	void multMatrix(const glm::mat4 &matrix);
-	
+	void multMatrix(const glm::mat4 &matrix) { top() *= matrix; }
+
 	// glTranslate(): Right multiplies the top matrix by a translation matrix
-	void translate(const glm::vec3 &trans);
-	void translate(float x, float y, float z);
+	void translate(const glm::vec3 &t)
+	{
+		glm::mat4 &M = top();
+		M[3] += M[0] * t.x + M[1] * t.y + M[2] * t.z;
+	}
+	void translate(float x, float y, float z) { translate(glm::vec3(x, y, z)); }
 	// glScale(): Right multiplies the top matrix by a scaling matrix
-	void scale(const glm::vec3 &scale);
-	void scale(float x, float y, float z);
+	void scale(const glm::vec3 &s)
+	{
+		glm::mat4 &M = top();
+		M[0] *= s.x;
+		M[1] *= s.y;
+		M[2] *= s.z;
+	}
+	void scale(float x, float y, float z) { scale(glm::vec3(x, y, z)); }
 	// glScale(): Right multiplies the top matrix by a scaling matrix
-	void scale(float size);
+	void scale(float size) { scale(glm::vec3(size, size, size)); }
 	// glRotate(): Right multiplies the top matrix by a rotation matrix (angle in radians)
-	void rotate(float angle, const glm::vec3 &axis);
-	void rotate(float angle, float x, float y, float z);
-	
+	void rotate(float angle, const glm::vec3 &axis)
+	{
+		if(axis.y == 0.0f && axis.z == 0.0f && axis.x != 0.0f) {
+			rotateColumns(1, 2, axis.x > 0.0f ? angle : -angle);
+		}
+		else if(axis.x == 0.0f && axis.z == 0.0f && axis.y != 0.0f) {
+			rotateColumns(2, 0, axis.y > 0.0f ? angle : -angle);
+		}
+		else if(axis.x == 0.0f && axis.y == 0.0f && axis.z != 0.0f) {
+			rotateColumns(0, 1, axis.z > 0.0f ? angle : -angle);
+		}
+		else {
+			rotateGeneral(angle, axis);
+		}
+	}
+	void rotate(float angle, float x, float y, float z) { rotate(angle, glm::vec3(x, y, z)); }
+
 	// glGet(GL_MODELVIEW_MATRIX): Gets the top matrix
-	const glm::mat4 &topMatrix() const;
-	
+	const glm::mat4 &topMatrix() const { return mstack[count - 1]; }
+
 	// Prints out the specified matrix
 	static void print(const glm::mat4 &mat, const char *name = 0);
 	// Prints out the top matrix
 	void print(const char *name = 0) const;
-	
+
+	// Drops everything but an identity matrix, so a stack can be reused every frame
+	void reset()
+	{
+		count = 1;
+		mstack[0] = glm::mat4(1.0f);
+	}
+
 private:
-	std::shared_ptr< std::stack<glm::mat4> > mstack;
-	
+	glm::mat4 &top() { return mstack[count - 1]; }
+
+	// Right multiplies by a rotation in the plane of columns a and b, from a towards b
+	void rotateColumns(int a, int b, float angle)
+	{
+		glm::mat4 &M = top();
+		float c = std::cos(angle);
+		float s = std::sin(angle);
+		glm::vec4 ca = M[a];
+		glm::vec4 cb = M[b];
+		M[a] = ca * c + cb * s;
+		M[b] = cb * c - ca * s;
+	}
+	void rotateGeneral(float angle, const glm::vec3 &axis);
+
+	glm::mat4 mstack[MATRIX_STACK_DEPTH];
+	int count;
+
 };
 
 #endif
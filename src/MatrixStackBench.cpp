@@ -0,0 +1,101 @@
+#include "Benchmark.h"
+#include "MatrixStack.h"
+
+#include <algorithm>
+#include <cmath>
+#include <iostream>
+#include <stack>
+
+#define GLM_FORCE_RADIANS
+#include <glm/glm.hpp>
+#include <glm/gtc/matrix_transform.hpp>
+
+#define MATRIX_BENCH_ITERATIONS 1000000
+
+// The MatrixStack this replaced: a heap std::stack and a full 4x4 multiply for every transform
+class LegacyMatrixStack
+{
+public:
+	LegacyMatrixStack() : mstack(std::make_shared< std::stack<glm::mat4> >()) { mstack->push(glm::mat4(1.0f)); }
+
+	void pushMatrix() { mstack->push(mstack->top()); }
+	void popMatrix() { mstack->pop(); }
+	void translate(const glm::vec3 &t) { mstack->top() *= glm::translate(glm::mat4(1.0f), t); }
+	void scale(const glm::vec3 &s) { mstack->top() *= glm::scale(glm::mat4(1.0f), s); }
+	void rotate(float angle, const glm::vec3 &axis) { mstack->top() *= glm::rotate(glm::mat4(1.0f), angle, axis); }
+	const glm::mat4 &topMatrix() const { return mstack->top(); }
+
+private:
+	std::shared_ptr< std::stack<glm::mat4> > mstack;
+};
+
+// What Asteroid::applyMVTransforms and Ship::getModelMatrix do, on a fresh stack
+template <typename Stack>
+static glm::mat4 modelTransform(float t)
+{
+	Stack M;
+	M.pushMatrix();
+	M.translate(glm::vec3(t, 0.0f, -t));
+	M.translate(glm::vec3(0.0f, 0.0f, -7.0f));
+	M.scale(glm::vec3(0.01f, 0.01f, 0.01f));
+	M.rotate(t, glm::vec3(0.0f, 1.0f, 0.0f));
+	M.rotate(-t, glm::vec3(0.0f, 0.0f, 1.0f));
+	M.rotate(0.5f * t, glm::vec3(1.0f, 0.0f, 0.0f));
+	glm::mat4 R = M.topMatrix();
+	M.popMatrix();
+	return R;
+}
+
+// The same nested transforms, on a stack that lives for the whole frame
+template <typename Stack>
+static void nestedTransforms(Stack &MV, float t)
+{
+	MV.pushMatrix();
+	MV.translate(glm::vec3(t, 0.0f, 1.0f));
+	MV.rotate(t, glm::vec3(0.0f, 1.0f, 0.0f));
+	MV.pushMatrix();
+	MV.scale(glm::vec3(2.0f, 2.0f, 2.0f));
+	MV.rotate(t, glm::vec3(0.3f, 0.7f, 0.1f));
+	Benchmark::keep(MV.topMatrix());
+	MV.popMatrix();
+	MV.popMatrix();
+}
+
+BENCHMARK_SUITE(matrixstack)
+{
+	// Both must agree before their timings mean anything
+	float maxErr = 0.0f;
+	for (int i = 0; i < 100; i++){
+		glm::mat4 a = modelTransform<MatrixStack>(0.1f * i);
+		glm::mat4 b = modelTransform<LegacyMatrixStack>(0.1f * i);
+		for (int c = 0; c < 4; c++){
+			for (int r = 0; r < 4; r++){
+				maxErr = std::max(maxErr, std::abs(a[c][r] - b[c][r]));
+			}
+		}
+	}
+	std::cout << "  max difference from legacy: " << maxErr << std::endl;
+
+	float t = 0.0f;
+	Benchmark::time("legacy: model transform (new stack)", MATRIX_BENCH_ITERATIONS, [&](){
+		glm::mat4 M = modelTransform<LegacyMatrixStack>(t);
+		Benchmark::keep(M);
+		t += 1e-6f;
+	});
+	Benchmark::time("inline: model transform (new stack)", MATRIX_BENCH_ITERATIONS, [&](){
+		glm::mat4 M = modelTransform<MatrixStack>(t);
+		Benchmark::keep(M);
+		t += 1e-6f;
+	});
+
+	LegacyMatrixStack legacy;
+	MatrixStack inlined;
+	Benchmark::time("legacy: nested push/transform/pop", MATRIX_BENCH_ITERATIONS, [&](){
+		nestedTransforms(legacy, t);
+		t += 1e-6f;
+	});
+	Benchmark::time("inline: nested push/transform/pop", MATRIX_BENCH_ITERATIONS, [&](){
+		nestedTransforms(inlined, t);
+		t += 1e-6f;
+	});
+}
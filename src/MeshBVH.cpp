@@ -0,0 +1,375 @@
+#include "MeshBVH.h"
+
+#include <algorithm>
+#include <cmath>
+#include <utility>
+
+#define BVH_MAX_DEPTH 48 // Deeper ranges are left as big leaves, so traversals fit a fixed stack
+
+namespace {
+
+	float halfArea(const glm::vec3 &lo, const glm::vec3 &hi)
+	{
+		glm::vec3 d = hi - lo;
+		return d.x * d.y + d.y * d.z + d.z * d.x;
+	}
+
+	// Where the ray enters the box, if it does before maxT
+	bool rayBox(const glm::vec3 &o, const glm::vec3 &invD, const glm::vec3 &lo, const glm::vec3 &hi, float maxT, float &t)
+	{
+		glm::vec3 t0 = (lo - o) * invD, t1 = (hi - o) * invD;
+		glm::vec3 tNear = glm::min(t0, t1), tFar = glm::max(t0, t1);
+		float enter = std::max(std::max(tNear.x, tNear.y), std::max(tNear.z, 0.0f));
+		float exit = std::min(std::min(tFar.x, tFar.y), std::min(tFar.z, maxT));
+		t = enter;
+		return enter <= exit;
+	}
+
+	// Whether the projections of two triangles onto axis are apart
+	bool separates(const glm::vec3 &axis, const glm::vec3 *a, const glm::vec3 *b)
+	{
+		float a0 = glm::dot(axis, a[0]), a1 = glm::dot(axis, a[1]), a2 = glm::dot(axis, a[2]);
+		float b0 = glm::dot(axis, b[0]), b1 = glm::dot(axis, b[1]), b2 = glm::dot(axis, b[2]);
+		return std::max(a0, std::max(a1, a2)) < std::min(b0, std::min(b1, b2)) ||
+			std::max(b0, std::max(b1, b2)) < std::min(a0, std::min(a1, a2));
+	}
+
+}
+
+MeshBVH::MeshBVH()
+{
+}
+
+// Möller-Trumbore
+bool MeshBVH::rayTriangle(const glm::vec3 &o, const glm::vec3 &d, const glm::vec3 *v, float &t)
+{
+	glm::vec3 e1 = v[1] - v[0], e2 = v[2] - v[0];
+	glm::vec3 p = glm::cross(d, e2);
+	float det = glm::dot(e1, p);
+	if(det == 0.0f) {
+		return false;
+	}
+	float inv = 1.0f / det;
+	glm::vec3 s = o - v[0];
+	float u = glm::dot(s, p) * inv;
+	if(u < 0.0f || u > 1.0f) {
+		return false;
+	}
+	glm::vec3 q = glm::cross(s, e1);
+	float w = glm::dot(d, q) * inv;
+	if(w < 0.0f || u + w > 1.0f) {
+		return false;
+	}
+	t = glm::dot(e2, q) * inv;
+	return t >= 0.0f;
+}
+
+// Separating axis test: both normals, every pair of edges, and each edge's normal within its
+// own triangle's plane for when the two are coplanar
+bool MeshBVH::trianglesTouch(const glm::vec3 *a, const glm::vec3 *b)
+{
+	glm::vec3 ea[3] = {a[1] - a[0], a[2] - a[1], a[0] - a[2]};
+	glm::vec3 eb[3] = {b[1] - b[0], b[2] - b[1], b[0] - b[2]};
+	glm::vec3 na = glm::cross(ea[0], ea[1]), nb = glm::cross(eb[0], eb[1]);
+	if(separates(na, a, b) || separates(nb, a, b)) {
+		return false;
+	}
+	for(int i = 0; i < 3; i++) {
+		for(int j = 0; j < 3; j++) {
+			if(separates(glm::cross(ea[i], eb[j]), a, b)) {
+				return false;
+			}
+		}
+	}
+	for(int i = 0; i < 3; i++) {
+		if(separates(glm::cross(na, ea[i]), a, b) || separates(glm::cross(nb, eb[i]), a, b)) {
+			return false;
+		}
+	}
+	return true;
+}
+
+glm::vec3 MeshBVH::getMin() const
+{
+	return nodes.empty() ? glm::vec3(0.0f) : nodes[0].lo;
+}
+
+glm::vec3 MeshBVH::getMax() const
+{
+	return nodes.empty() ? glm::vec3(0.0f) : nodes[0].hi;
+}
+
+void MeshBVH::build(const std::vector<float> &posBuf)
+{
+	nodes.clear();
+	verts.clear();
+	int n = (int)posBuf.size() / 9;
+	if(n == 0) {
+		return;
+	}
+
+	std::vector<glm::vec3> tris(3 * n);
+	std::vector<glm::vec3> centroids(n);
+	std::vector<int> order(n);
+	Node root;
+	root.lo = glm::vec3(INFINITY);
+	root.hi = glm::vec3(-INFINITY);
+	for(int i = 0; i < n; i++) {
+		for(int v = 0; v < 3; v++) {
+			tris[3 * i + v] = glm::vec3(posBuf[9 * i + 3 * v], posBuf[9 * i + 3 * v + 1], posBuf[9 * i + 3 * v + 2]);
+			root.lo = glm::min(root.lo, tris[3 * i + v]);
+			root.hi = glm::max(root.hi, tris[3 * i + v]);
+		}
+		centroids[i] = (tris[3 * i] + tris[3 * i + 1] + tris[3 * i + 2]) / 3.0f;
+		order[i] = i;
+	}
+	root.first = 0;
+	root.count = n;
+	nodes.reserve(2 * n);
+	nodes.push_back(root);
+
+	// Split depth first, keeping track of how deep each node is
+	std::vector<std::pair<int, int> > todo; // Node and its depth
+	todo.push_back(std::make_pair(0, 0));
+	while(!todo.empty()) {
+		int node = todo.back().first, depth = todo.back().second;
+		todo.pop_back();
+		if(depth + 1 >= BVH_MAX_DEPTH) {
+			continue;
+		}
+		split(node, order, centroids, tris);
+		if(nodes[node].count == 0) {
+			todo.push_back(std::make_pair(nodes[node].first + 1, depth + 1));
+			todo.push_back(std::make_pair(nodes[node].first, depth + 1));
+		}
+	}
+
+	verts.resize(3 * n);
+	for(int i = 0; i < n; i++) {
+		for(int v = 0; v < 3; v++) {
+			verts[3 * i + v] = tris[3 * order[i] + v];
+		}
+	}
+}
+
+void MeshBVH::split(int n, std::vector<int> &order, const std::vector<glm::vec3> &centroids, const std::vector<glm::vec3> &tris)
+{
+	int first = nodes[n].first, count = nodes[n].count;
+	if(count <= BVH_LEAF_TRIS) {
+		return;
+	}
+
+	glm::vec3 cLo(INFINITY), cHi(-INFINITY);
+	for(int i = first; i < first + count; i++) {
+		cLo = glm::min(cLo, centroids[order[i]]);
+		cHi = glm::max(cHi, centroids[order[i]]);
+	}
+
+	// Bin the centroids along each axis and cost every split between bins by the surface area
+	// heuristic
+	float bestCost = INFINITY;
+	int bestAxis = -1, bestBin = 0;
+	for(int axis = 0; axis < 3; axis++) {
+		float extent = cHi[axis] - cLo[axis];
+		if(extent <= 0.0f) {
+			continue;
+		}
+		int binCount[BVH_BINS] = {0};
+		glm::vec3 binLo[BVH_BINS], binHi[BVH_BINS];
+		for(int b = 0; b < BVH_BINS; b++) {
+			binLo[b] = glm::vec3(INFINITY);
+			binHi[b] = glm::vec3(-INFINITY);
+		}
+		for(int i = first; i < first + count; i++) {
+			int t = order[i];
+			int b = std::min(BVH_BINS - 1, (int)((centroids[t][axis] - cLo[axis]) / extent * BVH_BINS));
+			binCount[b]++;
+			for(int v = 0; v < 3; v++) {
+				binLo[b] = glm::min(binLo[b], tris[3 * t + v]);
+				binHi[b] = glm::max(binHi[b], tris[3 * t + v]);
+			}
+		}
+
+		// Area and count of everything above each split, then sweep up from below
+		float aboveArea[BVH_BINS];
+		int aboveCount[BVH_BINS];
+		glm::vec3 lo(INFINITY), hi(-INFINITY);
+		int c = 0;
+		for(int b = BVH_BINS - 1; b > 0; b--) {
+			lo = glm::min(lo, binLo[b]);
+			hi = glm::max(hi, binHi[b]);
+			c += binCount[b];
+			aboveArea[b] = c > 0 ? halfArea(lo, hi) : 0.0f;
+			aboveCount[b] = c;
+		}
+		lo = glm::vec3(INFINITY);
+		hi = glm::vec3(-INFINITY);
+		c = 0;
+		for(int b = 0; b < BVH_BINS - 1; b++) {
+			lo = glm::min(lo, binLo[b]);
+			hi = glm::max(hi, binHi[b]);
+			c += binCount[b];
+			if(c == 0 || aboveCount[b + 1] == 0) {
+				continue;
+			}
+			float cost = halfArea(lo, hi) * c + aboveArea[b + 1] * aboveCount[b + 1];
+			if(cost < bestCost) {
+				bestCost = cost;
+				bestAxis = axis;
+				bestBin = b;
+			}
+		}
+	}
+	// Every centroid in the same place
+	if(bestAxis == -1) {
+		return;
+	}
+
+	float extent = cHi[bestAxis] - cLo[bestAxis];
+	int *mid = std::partition(&order[first], &order[first] + count, [&](int t){
+		return std::min(BVH_BINS - 1, (int)((centroids[t][bestAxis] - cLo[bestAxis]) / extent * BVH_BINS)) <= bestBin;
+	});
+	int leftCount = (int)(mid - &order[first]);
+
+	int left = (int)nodes.size();
+	for(int side = 0; side < 2; side++) {
+		Node child;
+		child.first = side == 0 ? first : first + leftCount;
+		child.count = side == 0 ? leftCount : count - leftCount;
+		child.lo = glm::vec3(INFINITY);
+		child.hi = glm::vec3(-INFINITY);
+		for(int i = child.first; i < child.first + child.count; i++) {
+			for(int v = 0; v < 3; v++) {
+				child.lo = glm::min(child.lo, tris[3 * order[i] + v]);
+				child.hi = glm::max(child.hi, tris[3 * order[i] + v]);
+			}
+		}
+		nodes.push_back(child);
+	}
+	nodes[n].first = left;
+	nodes[n].count = 0;
+}
+
+bool MeshBVH::raycast(const glm::vec3 &origin, const glm::vec3 &dir, float maxT, float &t) const
+{
+	if(nodes.empty()) {
+		return false;
+	}
+	glm::vec3 invD(1.0f / dir.x, 1.0f / dir.y, 1.0f / dir.z);
+	float best = maxT;
+	bool hit = false;
+
+	int stack[BVH_MAX_DEPTH + 1];
+	int top = 0;
+	float enter;
+	if(!rayBox(origin, invD, nodes[0].lo, nodes[0].hi, best, enter)) {
+		return false;
+	}
+	stack[top++] = 0;
+	while(top > 0) {
+		const Node &node = nodes[stack[--top]];
+		if(node.count > 0) {
+			for(int i = node.first; i < node.first + node.count; i++) {
+				float ti;
+				if(rayTriangle(origin, dir, &verts[3 * i], ti) && ti <= best) {
+					best = ti;
+					hit = true;
+				}
+			}
+			continue;
+		}
+
+		// Nearer child on top, and neither if the ray misses it or a hit is already closer
+		int l = node.first, r = node.first + 1;
+		float tl, tr;
+		bool hitL = rayBox(origin, invD, nodes[l].lo, nodes[l].hi, best, tl);
+		bool hitR = rayBox(origin, invD, nodes[r].lo, nodes[r].hi, best, tr);
+		if(hitL && hitR) {
+			if(tl > tr) {
+				std::swap(l, r);
+			}
+			stack[top++] = r;
+			stack[top++] = l;
+		}
+		else if(hitL) {
+			stack[top++] = l;
+		}
+		else if(hitR) {
+			stack[top++] = r;
+		}
+	}
+	if(hit) {
+		t = best;
+	}
+	return hit;
+}
+
+bool MeshBVH::overlap(const MeshBVH &a, const MeshBVH &b, const glm::mat4 &bToA)
+{
+	if(a.nodes.empty() || b.nodes.empty()) {
+		return false;
+	}
+	glm::mat3 R(bToA);
+	glm::vec3 T(bToA[3]);
+	// b's face normals in a's space
+	glm::vec3 N[3] = {glm::cross(R[1], R[2]), glm::cross(R[2], R[0]), glm::cross(R[0], R[1])};
+
+	// Boxes are tested along a's axes and b's face normals. The edge-edge axes are left out, so
+	// some boxes that are apart get looked into anyway; the triangles decide.
+	auto boxesTouch = [&](const Node &na, const Node &nb){
+		glm::vec3 ca = 0.5f * (na.lo + na.hi), ea = 0.5f * (na.hi - na.lo);
+		glm::vec3 eb = 0.5f * (nb.hi - nb.lo);
+		glm::vec3 d = R * (0.5f * (nb.lo + nb.hi)) + T - ca;
+		for(int k = 0; k < 3; k++) {
+			float rb = eb.x * std::abs(R[0][k]) + eb.y * std::abs(R[1][k]) + eb.z * std::abs(R[2][k]);
+			if(std::abs(d[k]) > ea[k] + rb) {
+				return false;
+			}
+		}
+		for(int i = 0; i < 3; i++) {
+			float ra = ea.x * std::abs(N[i].x) + ea.y * std::abs(N[i].y) + ea.z * std::abs(N[i].z);
+			float rb = eb[i] * std::abs(glm::dot(N[i], R[i]));
+			if(std::abs(glm::dot(N[i], d)) > ra + rb) {
+				return false;
+			}
+		}
+		return true;
+	};
+
+	std::pair<int, int> stack[2 * BVH_MAX_DEPTH + 1];
+	int top = 0;
+	stack[top++] = std::make_pair(0, 0);
+	while(top > 0) {
+		int i = stack[top - 1].first, j = stack[top - 1].second;
+		top--;
+		const Node &na = a.nodes[i], &nb = b.nodes[j];
+		if(!boxesTouch(na, nb)) {
+			continue;
+		}
+
+		if(na.count > 0 && nb.count > 0) {
+			for(int u = nb.first; u < nb.first + nb.count; u++) {
+				glm::vec3 tb[3] = {R * b.verts[3 * u] + T, R * b.verts[3 * u + 1] + T, R * b.verts[3 * u + 2] + T};
+				for(int s = na.first; s < na.first + na.count; s++) {
+					if(trianglesTouch(&a.verts[3 * s], tb)) {
+						return true;
+					}
+				}
+			}
+			continue;
+		}
+
+		// Open up the bigger of the two, unless it is a leaf
+		float sizeA = glm::length(na.hi - na.lo);
+		float sizeB = glm::length(R * (nb.hi - nb.lo));
+		if(nb.count > 0 || (na.count == 0 && sizeA >= sizeB)) {
+			stack[top++] = std::make_pair(na.first, j);
+			stack[top++] = std::make_pair(na.first + 1, j);
+		}
+		else {
+			stack[top++] = std::make_pair(i, nb.first);
+			stack[top++] = std::make_pair(i, nb.first + 1);
+		}
+	}
+	return false;
+}
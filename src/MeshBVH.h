@@ -0,0 +1,59 @@
+#pragma once
+#ifndef MESH_BVH_H
+#define MESH_BVH_H
+
+#include <vector>
+
+#define GLM_FORCE_RADIANS
+#include <glm/glm.hpp>
+
+#define BVH_LEAF_TRIS 4 // Most triangles a leaf holds
+#define BVH_BINS 12     // Candidate splits tried along each axis
+
+/**
+ * A bounding volume hierarchy over a mesh's triangles, for telling whether something that got
+ * past a bounding sphere really touches the mesh. Built once from a Shape's posBuf (three vertices
+ * per triangle) and read-only afterwards, so any number of threads may query it.
+ * Nodes are boxes in the mesh's own space, split where the surface area heuristic says, and the
+ * triangles are copied out in leaf order so a leaf's are next to each other.
+ */
+class MeshBVH
+{
+public:
+	MeshBVH();
+
+	void build(const std::vector<float> &posBuf);
+	bool empty() const { return nodes.empty(); }
+	int getNumTris() const { return (int)verts.size() / 3; }
+	int getNumNodes() const { return (int)nodes.size(); }
+	// Bounds of the whole mesh
+	glm::vec3 getMin() const;
+	glm::vec3 getMax() const;
+
+	// The first triangle the segment origin + t * dir, 0 <= t <= maxT, touches, in the mesh's
+	// own space. dir doesn't have to be unit length; t is in multiples of it.
+	bool raycast(const glm::vec3 &origin, const glm::vec3 &dir, float maxT, float &t) const;
+
+	// Whether any triangle of a touches any triangle of b, with b placed in a's space by bToA
+	static bool overlap(const MeshBVH &a, const MeshBVH &b, const glm::mat4 &bToA);
+
+	// The exact tests the hierarchy narrows things down to, on triangles of three vertices each
+	static bool rayTriangle(const glm::vec3 &origin, const glm::vec3 &dir, const glm::vec3 *tri, float &t);
+	static bool trianglesTouch(const glm::vec3 *a, const glm::vec3 *b);
+
+private:
+	struct Node {
+		glm::vec3 lo;
+		int first; // First triangle of a leaf, or the left child (the right one follows it)
+		glm::vec3 hi;
+		int count; // Triangles in a leaf, 0 for an inner node
+	};
+
+	// Splits nodes[n], which covers the triangles [first, first + count) of order
+	void split(int n, std::vector<int> &order, const std::vector<glm::vec3> &centroids, const std::vector<glm::vec3> &tris);
+
+	std::vector<Node> nodes;
+	std::vector<glm::vec3> verts; // Three per triangle, in leaf order
+};
+
+#endif
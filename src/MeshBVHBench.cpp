@@ -0,0 +1,241 @@
+#include "Benchmark.h"
+#include "BoundingBox.h"
+#include "MeshBVH.h"
+#include "AsteroidMesh.h"
+#include "Projectiles.h"
+#include "SpatialGrid.h"
+
+#include <cmath>
+#include <cstdlib>
+#include <iostream>
+#include <vector>
+
+#define MESH_BENCH_RAYS 100000
+#define MESH_BENCH_PAIRS 20000
+#define MESH_BENCH_CHECKED 200     // Queries also checked against every triangle
+#define MESH_BENCH_SHIP_SCALE 0.2f // About a ship next to an average asteroid, in the asteroid's space
+#define MESH_BENCH_ASTEROIDS 1000
+#define MESH_BENCH_BEAMS 4000
+#define MESH_BENCH_FIELD 440.0f // Half the width of the area, four times the map's
+
+// The hand-tuned bounding sphere asteroids used to have, in the model's space
+#define MESH_BENCH_OLD_RADIUS 750
+
+static float randomIn(float a, float b)
+{
+	return a + (b - a) * (float)std::rand() / RAND_MAX;
+}
+
+static glm::vec3 randomUnit()
+{
+	for(;;) {
+		glm::vec3 v(randomIn(-1.0f, 1.0f), randomIn(-1.0f, 1.0f), randomIn(-1.0f, 1.0f));
+		float l = glm::length(v);
+		if(l > 0.01f && l <= 1.0f) {
+			return v / l;
+		}
+	}
+}
+
+// Scales by s and turns by a random angle about a random axis (Rodrigues), then moves to t
+static glm::mat4 randomPlacement(float s, const glm::vec3 &t)
+{
+	glm::vec3 k = randomUnit();
+	float a = randomIn(0.0f, 2.0f * (float)M_PI), c = std::cos(a), sn = std::sin(a);
+	glm::mat4 M(1.0f);
+	for(int col = 0; col < 3; col++) {
+		glm::vec3 e(col == 0, col == 1, col == 2);
+		glm::vec3 r = e * c + glm::cross(k, e) * sn + k * glm::dot(k, e) * (1.0f - c);
+		M[col] = glm::vec4(s * r, 0.0f);
+	}
+	M[3] = glm::vec4(t, 1.0f);
+	return M;
+}
+
+static void toTriangles(const std::vector<float> &pos, std::vector<glm::vec3> &tris)
+{
+	tris.resize(pos.size() / 3);
+	for(size_t i = 0; i < tris.size(); i++) {
+		tris[i] = glm::vec3(pos[3 * i], pos[3 * i + 1], pos[3 * i + 2]);
+	}
+}
+
+// What raycast() and overlap() have to agree with
+static bool bruteRay(const std::vector<glm::vec3> &tris, const glm::vec3 &o, const glm::vec3 &d, float maxT, float &t)
+{
+	bool hit = false;
+	t = maxT;
+	for(size_t i = 0; i < tris.size(); i += 3) {
+		float ti;
+		if(MeshBVH::rayTriangle(o, d, &tris[i], ti) && ti <= t) {
+			t = ti;
+			hit = true;
+		}
+	}
+	return hit;
+}
+
+static bool bruteOverlap(const std::vector<glm::vec3> &a, const std::vector<glm::vec3> &b, const glm::mat4 &bToA)
+{
+	for(size_t j = 0; j < b.size(); j += 3) {
+		glm::vec3 tb[3];
+		for(int v = 0; v < 3; v++) {
+			tb[v] = glm::vec3(bToA * glm::vec4(b[j + v], 1.0f));
+		}
+		for(size_t i = 0; i < a.size(); i += 3) {
+			if(MeshBVH::trianglesTouch(&a[i], tb)) {
+				return true;
+			}
+		}
+	}
+	return false;
+}
+
+BENCHMARK_SUITE(meshes)
+{
+	AsteroidMeshData asteroid, ship;
+	generateAsteroidMesh(1, asteroid);
+	generateAsteroidMesh(2, ship);
+	// A coarse asteroid flattened to about the ship's proportions stands in for it
+	std::vector<float> &shipPos = ship.pos[ASTEROID_LODS - 1];
+	for(size_t i = 1; i < shipPos.size(); i += 3) {
+		shipPos[i] *= 0.3f;
+	}
+
+	MeshBVH bvh, shipBVH;
+	std::cout << "  -- asteroid of " << asteroid.pos[0].size() / 9 << " triangles, ship of " << shipPos.size() / 9 << std::endl;
+	Benchmark::time("build", 20, [&](){
+		bvh.build(asteroid.pos[0]);
+	});
+	shipBVH.build(shipPos);
+	std::cout << "  " << bvh.getNumNodes() << " nodes" << std::endl;
+	std::vector<glm::vec3> tris, shipTris;
+	toTriangles(asteroid.pos[0], tris);
+	toTriangles(shipPos, shipTris);
+
+	// What Shape works out for every mesh it loads
+	BoundingSphere sphere, shipSphere;
+	OBB box, shipBox;
+	Benchmark::time("bounding sphere and boxes", 20, [&](){
+		sphere = BoundingSphere::enclosing(tris);
+		box = OBB::enclosing(tris);
+	});
+	shipSphere = BoundingSphere::enclosing(shipTris);
+	shipBox = OBB::enclosing(shipTris);
+	glm::vec3 center = sphere.center;
+	float radius = sphere.radius;
+
+	// Rays at anything near the asteroid: what each sphere lets through, and what really hits
+	std::srand(1);
+	BoundingSphere old(MESH_BENCH_OLD_RADIUS, glm::vec3(0.0f, 0.0f, ASTEROID_MESH_CENTER_Z));
+	int oldCandidates = 0, newCandidates = 0, meshHits = 0, missed = 0;
+	for(int i = 0; i < MESH_BENCH_RAYS; i++) {
+		glm::vec3 o = center + 2.0f * radius * randomUnit();
+		glm::vec3 target = center + 1.5f * radius * glm::vec3(randomIn(-1.0f, 1.0f), randomIn(-1.0f, 1.0f), randomIn(-1.0f, 1.0f));
+		glm::vec3 d = glm::normalize(target - o);
+		float t;
+		bool inOld = old.intersect(o, d, 4.0f * radius, t);
+		newCandidates += sphere.intersect(o, d, 4.0f * radius, t);
+		oldCandidates += inOld;
+		if(bvh.raycast(o, d, 4.0f * radius, t)) {
+			meshHits++;
+			missed += !inOld;
+		}
+	}
+	std::cout << "  radius " << (int)radius << " (was " << MESH_BENCH_OLD_RADIUS << "): " << newCandidates << " rays through the sphere (were "
+		<< oldCandidates << ") for " << meshHits << " that hit the mesh, " << missed << " of them missed by the old sphere" << std::endl;
+
+	// Rays through the bounding sphere from outside it, so each is a pair the sphere lets through
+	std::vector<glm::vec3> origins(MESH_BENCH_RAYS), dirs(MESH_BENCH_RAYS);
+	for(int i = 0; i < MESH_BENCH_RAYS; i++) {
+		origins[i] = center + 2.0f * radius * randomUnit();
+		glm::vec3 target = center + randomIn(0.0f, radius) * randomUnit();
+		dirs[i] = glm::normalize(target - origins[i]);
+	}
+	int r = 0, hits = 0;
+	double ns = Benchmark::time("raycast", MESH_BENCH_RAYS, [&](){
+		float t;
+		hits += bvh.raycast(origins[r], dirs[r], 4.0f * radius, t);
+		r = (r + 1) % MESH_BENCH_RAYS;
+	});
+	int wrong = 0;
+	double bruteNs = Benchmark::time("raycast every triangle", MESH_BENCH_CHECKED / BENCH_REPEATS, [&](){
+		float t0 = 0.0f, t1 = 0.0f;
+		bool a = bvh.raycast(origins[r], dirs[r], 4.0f * radius, t0);
+		bool b = bruteRay(tris, origins[r], dirs[r], 4.0f * radius, t1);
+		wrong += a != b || (a && std::abs(t0 - t1) > 1e-3f * t1);
+		r = (r + 1) % MESH_BENCH_RAYS;
+	});
+	long rays = (MESH_BENCH_RAYS / 10 + 1) + BENCH_REPEATS * (long)MESH_BENCH_RAYS;
+	std::cout << "  " << (int)(bruteNs / ns) << "x faster than every triangle, " << wrong << " different; "
+		<< (int)(100 * (rays - hits) / rays) << "% of the rays through the sphere miss the mesh" << std::endl;
+
+	// Ships placed where their sphere overlaps the asteroid's, at random angles
+	float shipRadius = MESH_BENCH_SHIP_SCALE * shipSphere.radius;
+	std::vector<glm::mat4> placements(MESH_BENCH_PAIRS);
+	int boxesApart = 0;
+	for(int i = 0; i < MESH_BENCH_PAIRS; i++) {
+		glm::mat4 &M = placements[i];
+		M = randomPlacement(MESH_BENCH_SHIP_SCALE, glm::vec3(0.0f));
+		glm::vec3 t = center + randomIn(0.0f, radius + shipRadius) * randomUnit();
+		M[3] = glm::vec4(t - glm::vec3(M * glm::vec4(shipSphere.center, 1.0f)), 1.0f);
+		boxesApart += !shipBox.transformed(M).overlaps(sphere);
+	}
+	int p = 0, touching = 0;
+	Benchmark::time("ship box against sphere", MESH_BENCH_PAIRS, [&](){
+		touching += shipBox.transformed(placements[p]).overlaps(sphere);
+		p = (p + 1) % MESH_BENCH_PAIRS;
+	});
+	std::cout << "  " << (int)(100 * boxesApart / MESH_BENCH_PAIRS) << "% of the overlapping spheres are clear of the ship's box" << std::endl;
+	touching = 0;
+	ns = Benchmark::time("overlap", MESH_BENCH_PAIRS, [&](){
+		touching += MeshBVH::overlap(bvh, shipBVH, placements[p]);
+		p = (p + 1) % MESH_BENCH_PAIRS;
+	});
+	wrong = 0;
+	bruteNs = Benchmark::time("overlap every triangle pair", MESH_BENCH_CHECKED / BENCH_REPEATS, [&](){
+		wrong += MeshBVH::overlap(bvh, shipBVH, placements[p]) != bruteOverlap(tris, shipTris, placements[p]);
+		p = (p + 1) % MESH_BENCH_PAIRS;
+	});
+	long pairs = (MESH_BENCH_PAIRS / 10 + 1) + BENCH_REPEATS * (long)MESH_BENCH_PAIRS;
+	std::cout << "  " << (int)(bruteNs / ns) << "x faster than every pair, " << wrong << " different; "
+		<< (int)(100 * (pairs - touching) / pairs) << "% of the overlapping spheres don't touch" << std::endl;
+
+	// A field of asteroids and beams: the narrowphase only runs on the pairs the spheres let through
+	std::cout << "  -- " << MESH_BENCH_BEAMS << " beams, " << MESH_BENCH_ASTEROIDS << " asteroids" << std::endl;
+	std::srand(2);
+	std::vector<BoundingSphere> spheres(MESH_BENCH_ASTEROIDS);
+	std::vector<glm::mat4> models(MESH_BENCH_ASTEROIDS);
+	for(int j = 0; j < MESH_BENCH_ASTEROIDS; j++) {
+		float size = randomIn(0.005f, 0.015f);
+		glm::vec3 c(randomIn(-MESH_BENCH_FIELD, MESH_BENCH_FIELD), 0.0f, randomIn(-MESH_BENCH_FIELD, MESH_BENCH_FIELD));
+		spheres[j] = BoundingSphere(radius * size, c);
+		models[j] = glm::mat4(size);
+		models[j][3] = glm::vec4(c - size * center, 1.0f);
+	}
+	SpatialGrid grid;
+	grid.build(spheres);
+	ProjectilePool pool(MESH_BENCH_BEAMS);
+	for(int i = 0; i < MESH_BENCH_BEAMS; i++) {
+		glm::vec3 o(randomIn(-MESH_BENCH_FIELD, MESH_BENCH_FIELD), 0.0f, randomIn(-MESH_BENCH_FIELD, MESH_BENCH_FIELD));
+		pool.spawn(o, glm::normalize(glm::vec3(randomIn(-1.0f, 1.0f), 0.0f, randomIn(-1.0f, 1.0f)) + glm::vec3(1e-3f, 0.0f, 0.0f)), 0.0);
+	}
+	pool.update(1.0 / 60.0);
+
+	std::vector<ProjectileHit> beamHits;
+	long candidates = 0;
+	double sphereNs = Benchmark::time("collide, spheres only", 100, [&](){
+		pool.collide(grid, beamHits);
+	});
+	int sphereHits = (int)beamHits.size();
+	double meshNs = Benchmark::time("collide, meshes too", 100, [&](){
+		pool.collide(grid, beamHits, [&](int j, const glm::vec3 &o, const glm::vec3 &d, float len, float &t){
+			candidates++;
+			glm::mat4 Minv = glm::inverse(models[j]);
+			return bvh.raycast(glm::vec3(Minv * glm::vec4(o, 1.0f)), glm::vec3(Minv * glm::vec4(d, 0.0f)), len, t);
+		});
+	});
+	long calls = 100 / 10 + 1 + BENCH_REPEATS * 100;
+	std::cout << "  " << candidates / calls << " meshes tested per call, " << sphereHits << " beams hit a sphere and "
+		<< beamHits.size() << " a mesh; " << (long)((meshNs - sphereNs) / std::max(1L, candidates / calls)) << " ns per mesh tested" << std::endl;
+}
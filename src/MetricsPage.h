@@ -0,0 +1,64 @@
+#pragma once
+#ifndef METRICS_PAGE_H
+#define METRICS_PAGE_H
+
+#include <atomic>
+#include <cstdint>
+
+// Shared by the game and tools/metrics_reader.cpp, so only standard headers here
+#define METRICS_MAGIC 0x4D455452u   // "METR"
+#define METRICS_VERSION 3
+#define METRICS_SHM_PREFIX "/final-metrics-" // Followed by the game's pid
+#define METRICS_MAX_PHASES 16
+#define METRICS_NAME_LENGTH 16
+
+struct MetricsPhase {
+	char name[METRICS_NAME_LENGTH];
+	float p50Ms;
+	float p99Ms;
+	float maxMs;
+	float meanMs;
+	float allocsPerCall;
+	uint32_t maxAllocs;
+};
+
+// Everything the game reports. Plain data, so a reader can copy it out in one go.
+struct MetricsData {
+	double uptime;           // Seconds since the game started
+	double fps;              // Over the last publishing interval
+	uint64_t frames;
+	uint64_t ticks;
+
+	uint32_t asteroids;
+	uint32_t beams;          // Live ones
+	uint32_t explosions;
+	uint32_t particles;
+	int32_t lives;
+	int32_t score;
+
+	uint64_t allocs;         // Heap allocations since start, all threads
+	double allocsPerSecond;  // Over the last publishing interval
+	uint64_t simArenaHighWater; // Most bytes of the simulation's FrameArena a tick has used
+	uint64_t simArenaOverflows; // Its allocations that didn't fit and went to the heap
+
+	uint32_t numPhases;
+	uint32_t pad;
+	MetricsPhase phases[METRICS_MAX_PHASES];
+};
+
+/**
+ * The fixed layout of the shared-memory page a game publishes with --metrics.
+ * data is guarded by a seqlock: the game makes seq odd, writes data, then makes seq even again.
+ * A reader copies data and keeps the copy only if seq was the same even number before and after.
+ */
+struct MetricsPage {
+	uint32_t magic;
+	uint32_t version;
+	uint32_t pid;
+	std::atomic<uint32_t> seq;
+	MetricsData data;
+};
+
+static_assert(std::atomic<uint32_t>::is_always_lock_free, "The seqlock counter must be lock-free to live in shared memory");
+
+#endif
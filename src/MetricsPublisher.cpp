@@ -0,0 +1,74 @@
+#include "MetricsPublisher.h"
+
+#include <cstdio>
+#include <new>
+
+#ifndef _WIN32
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <unistd.h>
+#endif
+
+MetricsPublisher::MetricsPublisher() :
+	page(nullptr)
+{
+	name[0] = '\0';
+}
+
+MetricsPublisher::~MetricsPublisher()
+{
+#ifndef _WIN32
+	if(page) {
+		munmap(page, sizeof(MetricsPage));
+		shm_unlink(name);
+	}
+#endif
+}
+
+bool MetricsPublisher::open()
+{
+#ifdef _WIN32
+	return false;
+#else
+	snprintf(name, sizeof(name), "%s%d", METRICS_SHM_PREFIX, (int)getpid());
+	int fd = shm_open(name, O_CREAT | O_RDWR, 0644);
+	if(fd < 0) {
+		return false;
+	}
+	if(ftruncate(fd, sizeof(MetricsPage)) != 0) {
+		close(fd);
+		shm_unlink(name);
+		return false;
+	}
+	void *mem = mmap(nullptr, sizeof(MetricsPage), PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+	close(fd);
+	if(mem == MAP_FAILED) {
+		shm_unlink(name);
+		return false;
+	}
+
+	page = new (mem) MetricsPage();
+	page->version = METRICS_VERSION;
+	page->pid = (uint32_t)getpid();
+	page->seq.store(0, std::memory_order_relaxed);
+	// Readers ignore the page until the magic shows up
+	std::atomic_thread_fence(std::memory_order_release);
+	page->magic = METRICS_MAGIC;
+	return true;
+#endif
+}
+
+MetricsData &MetricsPublisher::beginWrite()
+{
+	uint32_t s = page->seq.load(std::memory_order_relaxed);
+	page->seq.store(s + 1, std::memory_order_relaxed);
+	// Keep the data writes below from being seen before seq goes odd
+	std::atomic_thread_fence(std::memory_order_release);
+	return page->data;
+}
+
+void MetricsPublisher::endWrite()
+{
+	uint32_t s = page->seq.load(std::memory_order_relaxed);
+	page->seq.store(s + 1, std::memory_order_release);
+}
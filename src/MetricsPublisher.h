@@ -0,0 +1,30 @@
+#pragma once
+#ifndef METRICS_PUBLISHER_H
+#define METRICS_PUBLISHER_H
+
+#include "MetricsPage.h"
+
+/**
+ * Owns the shared-memory MetricsPage named METRICS_SHM_PREFIX + pid.
+ * Writing never blocks: readers retry instead of the writer waiting for them.
+ * Only available on POSIX systems; open() fails elsewhere.
+ */
+class MetricsPublisher
+{
+public:
+	MetricsPublisher();
+	~MetricsPublisher();
+
+	bool open();
+	const char *getName() const { return name; }
+
+	// Only one thread may write. Fill in the returned data between the two calls.
+	MetricsData &beginWrite();
+	void endWrite();
+
+private:
+	MetricsPage *page;
+	char name[64];
+};
+
+#endif
@@ -3,6 +3,7 @@
 #include <iostream>
 
 #include "GLSL.h"
+#include "GLState.h"
 #include "MatrixStack.h"
 #include "Program.h"
 #include "Texture.h"
@@ -27,11 +28,11 @@ Particle::Particle(int index, GLuint colBufID, GLuint scaBufID, std::vector<floa
 	lifespan = randFloat(MIN_PARTICLE_LIFESPAN, MAX_PARTICLE_LIFESPAN);
 	
 	// Send color data to GPU
-	glBindBuffer(GL_ARRAY_BUFFER, colBufID);
+	GLState::bindArrayBuffer(colBufID);
 	glBufferSubData(GL_ARRAY_BUFFER, 3*index*sizeof(float), 3*sizeof(float), color.data());
 	
 	// Send scale data to GPU
-	glBindBuffer(GL_ARRAY_BUFFER, scaBufID);
+	GLState::bindArrayBuffer(scaBufID);
 	glBufferSubData(GL_ARRAY_BUFFER, index*sizeof(float), sizeof(float), &scale);
 }
 
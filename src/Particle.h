@@ -23,7 +23,7 @@
 #define MIN_PARTICLE_SIZE 3.0f
 #define MAX_PARTICLE_SIZE 5.0f
 
-extern double tGlobal;
+extern thread_local double tGlobal;
 
 class MatrixStack;
 class Program;
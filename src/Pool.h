@@ -0,0 +1,39 @@
+#pragma once
+#ifndef POOL_H
+#define POOL_H
+
+#include <memory>
+#include <vector>
+
+/**
+ * A free list of objects that are expensive to make, so that dying entities can be reused instead
+ * of freed. acquire() returns nullptr when the pool is empty; the caller then makes a new object,
+ * and it is up to the caller to reinitialize a recycled one.
+ * Not thread-safe.
+ */
+template <typename T>
+class Pool
+{
+public:
+	// Makes room for n released objects, so release() doesn't allocate until more than n are out
+	void reserve(size_t n) { free.reserve(n); }
+
+	std::shared_ptr<T> acquire()
+	{
+		if(free.empty()) {
+			return nullptr;
+		}
+		std::shared_ptr<T> p = std::move(free.back());
+		free.pop_back();
+		return p;
+	}
+
+	void release(std::shared_ptr<T> p) { free.push_back(std::move(p)); }
+
+	size_t getNumFree() const { return free.size(); }
+
+private:
+	std::vector< std::shared_ptr<T> > free;
+};
+
+#endif
@@ -4,9 +4,13 @@
 #include <cassert>
 
 #include "GLSL.h"
+#include "GLState.h"
 
 using namespace std;
 
+// Names of the standard attributes, indexed by ATTRIB_LOCATIONS
+static const char *ATTRIB_NAMES[NUM_ATTRIBS] = { "aPos", "aNor", "aTex", "aCol", "aAlp", "aSca" };
+
 Program::Program() :
 	name(""),
 	vShaderName(""),
@@ -14,7 +18,9 @@ Program::Program() :
 	pid(0),
 	verbose(true)
 {
-	
+	for(int i = 0; i < NUM_ATTRIBS; i++) {
+		attribSlots[i] = -1;
+	}
 }
 
 Program::~Program()
@@ -84,17 +90,22 @@ bool Program::init()
 
 void Program::bind()
 {
-	glUseProgram(pid);
+	GLState::useProgram(pid);
 }
 
 void Program::unbind()
 {
-	glUseProgram(0);
+	GLState::useProgram(0);
 }
 
 void Program::addAttribute(const string &name)
 {
 	attributes[name] = glGetAttribLocation(pid, name.c_str());
+	for(int i = 0; i < NUM_ATTRIBS; i++) {
+		if(name == ATTRIB_NAMES[i]) {
+			attribSlots[i] = attributes[name];
+		}
+	}
 }
 
 void Program::addUniform(const string &name)
@@ -102,6 +113,18 @@ void Program::addUniform(const string &name)
 	uniforms[name] = glGetUniformLocation(pid, name.c_str());
 }
 
+void Program::addUniformBlock(const string &name, GLuint binding)
+{
+	GLuint index = glGetUniformBlockIndex(pid, name.c_str());
+	if(index == GL_INVALID_INDEX) {
+		if(isVerbose()) {
+			cout << name << " is not a uniform block" << endl;
+		}
+		return;
+	}
+	glUniformBlockBinding(pid, index, binding);
+}
+
 GLint Program::getAttribute(const string &name) const
 {
 	map<string,GLint>::const_iterator attribute = attributes.find(name.c_str());
@@ -8,6 +8,21 @@
 #define GLEW_STATIC
 #include <GL/glew.h>
 
+// True when running on an OpenGL 3.3 core profile context (see --gl-compat in main.cpp)
+extern bool coreProfile;
+
+// Attribute locations fixed with layout(location = N) in the GLSL 330 shaders.
+// Vertex array objects are set up against these, so they work with any program.
+enum ATTRIB_LOCATIONS {
+	ATTRIB_POS = 0,
+	ATTRIB_NOR = 1,
+	ATTRIB_TEX = 2,
+	ATTRIB_COL = 3,
+	ATTRIB_ALP = 4,
+	ATTRIB_SCA = 5,
+	NUM_ATTRIBS
+};
+
 /**
  * An OpenGL Program (vertex and fragment shaders)
  */
@@ -27,8 +42,13 @@ public:
 
 	void addAttribute(const std::string &name);
 	void addUniform(const std::string &name);
+	// Connects the named uniform block to a uniform buffer binding point
+	void addUniformBlock(const std::string &name, GLuint binding);
 	GLint getAttribute(const std::string &name) const;
 	GLint getUniform(const std::string &name) const;
+	// No lookup: the standard attributes (aPos, aNor, ...) are cached by addAttribute()
+	GLint getAttribute(ATTRIB_LOCATIONS a) const { return attribSlots[a]; }
+	GLuint getPID() const { return pid; }
 	
 protected:
 	std::string name;
@@ -39,6 +59,7 @@ private:
 	GLuint pid;
 	std::map<std::string,GLint> attributes;
 	std::map<std::string,GLint> uniforms;
+	GLint attribSlots[NUM_ATTRIBS];
 	bool verbose;
 };
 
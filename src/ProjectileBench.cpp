@@ -0,0 +1,150 @@
+#include "Benchmark.h"
+#include "CollisionEvents.h"
+#include "Projectiles.h"
+#include "SpatialGrid.h"
+
+#include <cstdlib>
+#include <iostream>
+#include <string>
+#include <vector>
+
+#define PROJECTILE_BENCH_ASTEROIDS 1000
+#define PROJECTILE_BENCH_FIELD 440.0f // Half the width of the area, four times the map's
+#define PROJECTILE_BENCH_DT (1.0 / 60.0)
+#define PROJECTILE_BENCH_THREADS 4 // Most threads the event queue is timed on
+
+static float randomIn(float a, float b)
+{
+	return a + (b - a) * (float)std::rand() / RAND_MAX;
+}
+
+// n beams fired from all over the map in random directions on the x-z plane, at t = 0
+static void fill(ProjectilePool &pool, int n)
+{
+	pool.clear();
+	for(int i = 0; i < n; i++) {
+		glm::vec3 origin(randomIn(-PROJECTILE_BENCH_FIELD, PROJECTILE_BENCH_FIELD), 0.0f, randomIn(-PROJECTILE_BENCH_FIELD, PROJECTILE_BENCH_FIELD));
+		glm::vec3 dir(randomIn(-1.0f, 1.0f), 0.0f, randomIn(-1.0f, 1.0f));
+		pool.spawn(origin, dir + glm::vec3(1e-3f, 0.0f, 0.0f), 0.0);
+	}
+}
+
+// The first sphere each beam touches, by testing every pair: what collide() has to agree with
+static void bruteForce(const ProjectilePool &pool, const std::vector<BoundingSphere> &spheres, std::vector<int> &target)
+{
+	target.assign(pool.size(), -1);
+	for(int i = 0; i < pool.size(); i++) {
+		glm::vec3 d = pool.getDir(i);
+		glm::vec3 head = pool.getStart(i) + BEAM_LENGTH * d;
+		glm::vec3 p = pool.getStart(i) - BEAM_SPEED * (float)PROJECTILE_BENCH_DT * d; // Tail one tick ago
+		float len = glm::dot(head - p, d);
+		float best = INFINITY;
+		for(int j = 0; j < (int)spheres.size(); j++) {
+			float t;
+			if(spheres[j].intersect(p, d, len, t) && t < best) {
+				best = t;
+				target[i] = j;
+			}
+		}
+	}
+}
+
+static void benchSize(int n, const std::vector<BoundingSphere> &spheres, SpatialGrid &grid)
+{
+	std::cout << "  -- " << n << " projectiles, " << spheres.size() << " asteroids" << std::endl;
+	ProjectilePool pool(n);
+	std::vector<ProjectileHit> hits;
+
+	std::srand(1);
+	double ns = Benchmark::time("spawn + despawn all", 10, [&](){
+		fill(pool, n);
+		while(pool.size() > 0) {
+			pool.despawn(pool.size() - 1);
+		}
+	});
+	Benchmark::report("  per projectile", ns / n);
+
+	// One tick in, so every beam has a swept segment
+	fill(pool, n);
+	pool.update(PROJECTILE_BENCH_DT);
+	double t = PROJECTILE_BENCH_DT;
+	ns = Benchmark::time("update", 100, [&](){
+		// Kept under BEAM_LIFE, as though the timers were despawning them
+		t = t < 1.0 ? t + 1e-6 : PROJECTILE_BENCH_DT;
+		pool.update(t);
+	});
+	Benchmark::report("  per projectile", ns / n);
+
+	fill(pool, n);
+	pool.update(PROJECTILE_BENCH_DT);
+	grid.build(spheres);
+	Benchmark::time("grid build", 100, [&](){
+		grid.build(spheres);
+	});
+	ns = Benchmark::time("swept collide", 20, [&](){
+		pool.collide(grid, hits);
+	});
+	Benchmark::report("  per projectile", ns / n);
+
+	// The same through the event queue on several threads: it has to come out in the same order
+	// however the beams are split up
+	CollisionEventQueue queue;
+	std::vector<std::vector<ProjectileHit> > threadHits(PROJECTILE_BENCH_THREADS);
+	auto detect = [&](int numThreads){
+		queue.clear();
+		queue.detect(pool.size(), [&](int thread, int begin, int end, std::vector<CollisionEvent> &out){
+			std::vector<ProjectileHit> &h = threadHits[thread];
+			h.clear();
+			pool.collide(grid, begin, end, h, [](int, const glm::vec3 &, const glm::vec3 &, float, float &){ return true; });
+			for(auto e = h.begin(); e != h.end(); ++e) {
+				out.push_back(CollisionEvent(COLLISION_BEAM_ASTEROID, e->projectile, e->target, e->t));
+			}
+		}, numThreads);
+		return queue.gather();
+	};
+	for(int threads = 1; threads <= PROJECTILE_BENCH_THREADS; threads *= 2) {
+		std::string name = "collide into events, " + std::to_string(threads) + " thread" + (threads > 1 ? "s" : "");
+		Benchmark::time(name.c_str(), 20, [&](){
+			Benchmark::keep(detect(threads).size());
+		});
+	}
+	pool.collide(grid, hits);
+	const std::vector<CollisionEvent> &events = detect(PROJECTILE_BENCH_THREADS);
+	int moved = events.size() != hits.size();
+	for(size_t i = 0; !moved && i < hits.size(); i++) {
+		moved += events[i].source != hits[i].projectile || events[i].target != hits[i].target;
+	}
+	std::cout << "  " << events.size() << " events, " << (moved ? "not " : "") << "the same as one thread's hits" << std::endl;
+
+	// Only the smaller size is checked and timed against all pairs, which takes a while at 100k
+	if(n <= 10000) {
+		std::vector<int> expected;
+		ns = Benchmark::time("all pairs", 1, [&](){
+			bruteForce(pool, spheres, expected);
+		});
+		Benchmark::report("  per projectile", ns / n);
+		pool.collide(grid, hits);
+		int wrong = 0, numExpected = 0;
+		size_t h = 0;
+		for(int i = 0; i < pool.size(); i++) {
+			int got = (h < hits.size() && hits[h].projectile == i) ? hits[h++].target : -1;
+			numExpected += expected[i] != -1;
+			wrong += got != expected[i];
+		}
+		std::cout << "  " << numExpected << " hits, " << wrong << " different from all pairs" << std::endl;
+	}
+}
+
+BENCHMARK_SUITE(projectiles)
+{
+	std::srand(1);
+	std::vector<BoundingSphere> spheres;
+	for(int i = 0; i < PROJECTILE_BENCH_ASTEROIDS; i++) {
+		glm::vec3 c(randomIn(-PROJECTILE_BENCH_FIELD, PROJECTILE_BENCH_FIELD), 0.0f, randomIn(-PROJECTILE_BENCH_FIELD, PROJECTILE_BENCH_FIELD));
+		spheres.push_back(BoundingSphere(randomIn(3.75f, 11.25f), c)); // The range of asteroid radii
+	}
+
+	SpatialGrid grid;
+	benchSize(10000, spheres, grid);
+	benchSize(100000, spheres, grid);
+}
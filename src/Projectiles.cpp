@@ -0,0 +1,161 @@
+#include "Projectiles.h"
+
+#include <algorithm>
+
+ProjectilePool::ProjectilePool(int capacity) :
+	count(0),
+	ids(capacity),
+	slotIndex(capacity),
+	slotReuses(capacity, 0),
+	ox(capacity), oy(capacity), oz(capacity),
+	tCreated(capacity),
+	dx(capacity), dy(capacity), dz(capacity),
+	sx(capacity), sy(capacity), sz(capacity),
+	px(capacity), py(capacity), pz(capacity)
+{
+	clear();
+}
+
+void ProjectilePool::clear()
+{
+	// So ids handed out before don't match whatever gets the slots next
+	for(int i = 0; i < count; i++) {
+		slotReuses[ids[i] & ((1u << PROJECTILE_SLOT_BITS) - 1)]++;
+	}
+	count = 0;
+	// Handed out lowest first
+	freeSlots.resize(capacity());
+	for(int i = 0; i < capacity(); i++) {
+		freeSlots[i] = capacity() - 1 - i;
+	}
+}
+
+int ProjectilePool::spawn(const glm::vec3 &origin, const glm::vec3 &dir, double t)
+{
+	if(count == capacity()) {
+		return -1;
+	}
+	int i = count++;
+	uint32_t slot = freeSlots.back();
+	freeSlots.pop_back();
+	slotIndex[slot] = i;
+	ids[i] = slot | (slotReuses[slot] << PROJECTILE_SLOT_BITS);
+
+	glm::vec3 d = glm::normalize(dir);
+	ox[i] = sx[i] = px[i] = origin.x;
+	oy[i] = sy[i] = py[i] = origin.y;
+	oz[i] = sz[i] = pz[i] = origin.z;
+	dx[i] = d.x;
+	dy[i] = d.y;
+	dz[i] = d.z;
+	tCreated[i] = t;
+	return i;
+}
+
+void ProjectilePool::despawn(int i)
+{
+	uint32_t slot = ids[i] & ((1u << PROJECTILE_SLOT_BITS) - 1);
+	slotReuses[slot]++;
+	freeSlots.push_back(slot);
+
+	int last = --count;
+	if(i == last) {
+		return;
+	}
+	ids[i] = ids[last];
+	slotIndex[ids[i] & ((1u << PROJECTILE_SLOT_BITS) - 1)] = i;
+	ox[i] = ox[last]; oy[i] = oy[last]; oz[i] = oz[last];
+	tCreated[i] = tCreated[last];
+	dx[i] = dx[last]; dy[i] = dy[last]; dz[i] = dz[last];
+	sx[i] = sx[last]; sy[i] = sy[last]; sz[i] = sz[last];
+	px[i] = px[last]; py[i] = py[last]; pz[i] = pz[last];
+}
+
+bool ProjectilePool::despawnID(uint32_t id)
+{
+	uint32_t slot = id & ((1u << PROJECTILE_SLOT_BITS) - 1);
+	uint32_t reuses = id >> PROJECTILE_SLOT_BITS;
+	if(slot >= slotReuses.size() || (slotReuses[slot] & (0xffffffffu >> PROJECTILE_SLOT_BITS)) != reuses) {
+		return false;
+	}
+	despawn(slotIndex[slot]);
+	return true;
+}
+
+void ProjectilePool::update(double t)
+{
+	for(int i = 0; i < count; i++) {
+		float dist = BEAM_SPEED * (float)(t - tCreated[i]);
+		px[i] = sx[i];
+		py[i] = sy[i];
+		pz[i] = sz[i];
+		sx[i] = ox[i] + dist * dx[i];
+		sy[i] = oy[i] + dist * dy[i];
+		sz[i] = oz[i] + dist * dz[i];
+	}
+}
+
+void ProjectilePool::collide(const SpatialGrid &grid, std::vector<ProjectileHit> &hits) const
+{
+	hits.clear();
+	for(int i = 0; i < count; i++) {
+		glm::vec3 p, d;
+		float len;
+		getSegment(i, p, d, len);
+		glm::vec3 head = p + len * d;
+
+		ProjectileHit hit;
+		hit.projectile = i;
+		hit.target = -1;
+		hit.t = INFINITY;
+		grid.forEachNear(glm::min(p, head), glm::max(p, head), [&](int j, const BoundingSphere &s){
+			float t;
+			// Ties go to the lower index, so the result doesn't depend on the grid's order
+			if(s.intersect(p, d, len, t) && (t < hit.t || (t == hit.t && j < hit.target))) {
+				hit.t = t;
+				hit.target = j;
+			}
+		});
+		if(hit.target != -1) {
+			hits.push_back(hit);
+		}
+	}
+}
+
+void ProjectilePool::despawnHits(const std::vector<ProjectileHit> &hits)
+{
+	// Highest index first, so a despawn only ever moves a projectile that is staying
+	for(auto h = hits.rbegin(); h != hits.rend(); ++h) {
+		despawn(h->projectile);
+	}
+}
+
+void ProjectilePool::shift(const glm::vec3 &d)
+{
+	for(int i = 0; i < count; i++) {
+		ox[i] += d.x; oy[i] += d.y; oz[i] += d.z;
+		sx[i] += d.x; sy[i] += d.y; sz[i] += d.z;
+		px[i] += d.x; py[i] += d.y; pz[i] += d.z;
+	}
+}
+
+void ProjectilePool::getBounds(std::vector<BoundingSphere> &bounds) const
+{
+	bounds.resize(count);
+	for(int i = 0; i < count; i++) {
+		glm::vec3 d(dx[i], dy[i], dz[i]);
+		bounds[i] = BoundingSphere(0.5f * BEAM_LENGTH, glm::vec3(sx[i], sy[i], sz[i]) + 0.5f * BEAM_LENGTH * d);
+	}
+}
+
+void ProjectilePool::getInstances(std::vector<ProjectileInstance> &out, double t) const
+{
+	size_t first = out.size();
+	out.resize(first + count);
+	for(int i = 0; i < count; i++) {
+		ProjectileInstance &p = out[first + i];
+		p.start = glm::vec3(sx[i], sy[i], sz[i]);
+		p.age = (float)(t - tCreated[i]);
+		p.dir = glm::vec3(dx[i], dy[i], dz[i]);
+	}
+}
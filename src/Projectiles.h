@@ -0,0 +1,159 @@
+#pragma once
+#ifndef PROJECTILES_H
+#define PROJECTILES_H
+
+#include <algorithm>
+#include <vector>
+
+#define GLM_FORCE_RADIANS
+#include <glm/glm.hpp>
+
+#include "SpatialGrid.h"
+#include "WorldSnapshot.h"
+
+#define MAX_PROJECTILES 65536
+#define BEAM_LIFE 2.0 // Maximum time a beam will live (in seconds)
+#define BEAM_SPEED 250.0f
+#define BEAM_THICKNESS 3.0f
+#define BEAM_LENGTH 10.0f
+#define PROJECTILE_SLOT_BITS 20 // Low bits of an id; the rest count how often the slot was reused
+
+// A projectile that hit a sphere this tick
+struct ProjectileHit {
+	int projectile; // Index into the pool, valid until the next spawn or despawn
+	int target;     // Index of the sphere in the grid
+	float t;        // How far along the projectile's swept segment it hit
+};
+
+/**
+ * Every live beam, stored as parallel arrays and packed into [0, size()), so updates and
+ * collision tests stream through memory. spawn() appends and despawn() moves the last
+ * projectile into the hole, so both are O(1) and nothing is allocated after construction.
+ * Because indices move, each projectile also gets an id from a free list of slots that follow
+ * it around, so a timer can expire it later whatever index it has by then.
+ * A beam flies in a straight line at BEAM_SPEED from where it was fired, so its position is
+ * worked out from the time rather than integrated.
+ */
+class ProjectilePool
+{
+public:
+	ProjectilePool(int capacity = MAX_PROJECTILES);
+
+	// Returns the new projectile's index, or -1 if the pool is full
+	int spawn(const glm::vec3 &origin, const glm::vec3 &dir, double t);
+	void despawn(int i);
+	// Despawns the projectile with this id, if it hasn't been already. Returns whether it had to.
+	bool despawnID(uint32_t id);
+	void clear();
+
+	// Moves everything to where it is at time t. Nothing expires here: whoever spawns a
+	// projectile schedules its despawnID() BEAM_LIFE later.
+	void update(double t);
+
+	// Sweeps each projectile over the ground it covered in the last update() (tail then, to head
+	// now) and finds the first sphere in grid it touches. hits is cleared and gets at most one hit
+	// per projectile, in index order.
+	void collide(const SpatialGrid &grid, std::vector<ProjectileHit> &hits) const;
+	// The same, but a sphere is only hit if narrowphase(j, p, d, len, t) agrees that the segment
+	// from p along the unit direction d for len units touches what sphere j bounds. t comes in as
+	// where the segment enters the sphere and goes out as where it hits. The spheres a projectile
+	// touches are tried nearest first, and only as long as they could still be hit first.
+	template <typename Narrowphase>
+	void collide(const SpatialGrid &grid, std::vector<ProjectileHit> &hits, Narrowphase narrowphase) const;
+	// Just the projectiles [begin, end), with their hits appended to hits, so several threads can
+	// each take a range if narrowphase is safe to call from all of them
+	template <typename Narrowphase>
+	void collide(const SpatialGrid &grid, int begin, int end, std::vector<ProjectileHit> &hits, Narrowphase narrowphase) const;
+	// Despawns the projectile of every hit. hits must be in index order, like collide() leaves them.
+	void despawnHits(const std::vector<ProjectileHit> &hits);
+
+	// Moves everything by d, for the open world's floating origin
+	void shift(const glm::vec3 &d);
+
+	// Replaces bounds with a sphere around each projectile's beam, in index order
+	void getBounds(std::vector<BoundingSphere> &bounds) const;
+
+	// Appends every projectile as of time t (normally the time of the last update())
+	void getInstances(std::vector<ProjectileInstance> &out, double t) const;
+
+	int size() const { return count; }
+	int capacity() const { return (int)tCreated.size(); }
+	uint32_t getID(int i) const { return ids[i]; }
+	glm::vec3 getStart(int i) const { return glm::vec3(sx[i], sy[i], sz[i]); }
+	glm::vec3 getDir(int i) const { return glm::vec3(dx[i], dy[i], dz[i]); }
+
+private:
+	// The ground projectile i covered in the last update(), tail then to head now
+	void getSegment(int i, glm::vec3 &p, glm::vec3 &d, float &len) const
+	{
+		p = glm::vec3(px[i], py[i], pz[i]);
+		d = glm::vec3(dx[i], dy[i], dz[i]);
+		glm::vec3 head = glm::vec3(sx[i], sy[i], sz[i]) + BEAM_LENGTH * d;
+		len = glm::dot(head - p, d);
+	}
+
+	int count;
+
+	std::vector<uint32_t> ids;       // Of the projectile at each index
+	std::vector<uint32_t> slotIndex; // Where the projectile in each slot is now
+	std::vector<uint32_t> slotReuses;
+	std::vector<uint32_t> freeSlots;
+
+	// Where each was fired from, and when
+	std::vector<float> ox, oy, oz;
+	std::vector<double> tCreated;
+	// Unit direction
+	std::vector<float> dx, dy, dz;
+	// Tail of the beam at the last update(), and the one before
+	std::vector<float> sx, sy, sz;
+	std::vector<float> px, py, pz;
+};
+
+template <typename Narrowphase>
+void ProjectilePool::collide(const SpatialGrid &grid, std::vector<ProjectileHit> &hits, Narrowphase narrowphase) const
+{
+	hits.clear();
+	collide(grid, 0, count, hits, narrowphase);
+}
+
+template <typename Narrowphase>
+void ProjectilePool::collide(const SpatialGrid &grid, int begin, int end, std::vector<ProjectileHit> &hits, Narrowphase narrowphase) const
+{
+	for(int i = begin; i < end; i++) {
+		glm::vec3 p, d;
+		float len;
+		getSegment(i, p, d, len);
+
+		// Every sphere the segment touches goes on the end of hits for now, nearest first
+		size_t first = hits.size();
+		grid.forEachNear(glm::min(p, p + len * d), glm::max(p, p + len * d), [&](int j, const BoundingSphere &s){
+			ProjectileHit h;
+			h.projectile = i;
+			h.target = j;
+			if(s.intersect(p, d, len, h.t)) {
+				hits.push_back(h);
+			}
+		});
+		std::sort(hits.begin() + first, hits.end(), [](const ProjectileHit &a, const ProjectileHit &b){
+			return a.t != b.t ? a.t < b.t : a.target < b.target;
+		});
+
+		// Nothing inside a sphere is nearer than where the segment enters it
+		ProjectileHit hit;
+		hit.target = -1;
+		hit.t = INFINITY;
+		for(size_t k = first; k < hits.size() && hits[k].t <= hit.t; k++) {
+			float t = hits[k].t;
+			if(narrowphase(hits[k].target, p, d, len, t) && (t < hit.t || (t == hit.t && hits[k].target < hit.target))) {
+				hit = hits[k];
+				hit.t = t;
+			}
+		}
+		hits.resize(first);
+		if(hit.target != -1) {
+			hits.push_back(hit);
+		}
+	}
+}
+
+#endif
@@ -0,0 +1,141 @@
+#include "Benchmark.h"
+#include "SpatialQuery.h"
+
+#include <algorithm>
+#include <cstdlib>
+#include <iostream>
+#include <thread>
+#include <vector>
+
+#define QUERY_BENCH_ASTEROIDS 100000
+#define QUERY_BENCH_FIELD 2000.0f   // Half the width of the wrapping playfield, about one asteroid per 160 square units
+#define QUERY_BENCH_QUERIES 1000000
+#define QUERY_BENCH_CHECKED 500     // Queries checked against all pairs
+#define QUERY_BENCH_RADIUS 20.0f    // Overlap radius
+#define QUERY_BENCH_RAY 150.0f      // Ray length
+#define QUERY_BENCH_K 4
+
+static float randomIn(float a, float b)
+{
+	return a + (b - a) * (float)std::rand() / RAND_MAX;
+}
+
+// The distance from p to the nearest copy of c on the wrapping playfield
+static float wrappedDistance(const glm::vec3 &c, const glm::vec3 &p)
+{
+	glm::vec3 d = c - p;
+	d.x -= 2.0f * QUERY_BENCH_FIELD * std::floor((d.x + QUERY_BENCH_FIELD) / (2.0f * QUERY_BENCH_FIELD));
+	d.z -= 2.0f * QUERY_BENCH_FIELD * std::floor((d.z + QUERY_BENCH_FIELD) / (2.0f * QUERY_BENCH_FIELD));
+	return glm::length(d);
+}
+
+// Checks a sample of each kind of query against testing every asteroid, and returns how many disagree
+static int check(const SpatialQuery &query, const std::vector<BoundingSphere> &spheres, const std::vector<BoundingSphere> &overlaps,
+	const std::vector<RayQuery> &rays, const std::vector<glm::vec3> &points)
+{
+	std::vector<QueryHit> hits(spheres.size());
+	std::vector<float> dists(spheres.size());
+	int wrong = 0;
+	for(int q = 0; q < QUERY_BENCH_CHECKED; q++) {
+		int expected = 0;
+		for(size_t j = 0; j < spheres.size(); j++) {
+			expected += wrappedDistance(spheres[j].center, overlaps[q].center) - spheres[j].radius <= overlaps[q].radius;
+		}
+		wrong += query.overlap(overlaps[q], QUERY_ALL, hits.data(), (int)hits.size()) != expected;
+
+		// Every copy of every asteroid the ray could reach
+		int first = -1;
+		float best = INFINITY;
+		for(size_t j = 0; j < spheres.size(); j++) {
+			for(int kz = -1; kz <= 1; kz++) {
+				for(int kx = -1; kx <= 1; kx++) {
+					glm::vec3 c = spheres[j].center + glm::vec3(kx, 0, kz) * (2.0f * QUERY_BENCH_FIELD);
+					float t;
+					if(BoundingSphere(spheres[j].radius, c).intersect(rays[q].origin, rays[q].dir, rays[q].length, t) && t < best) {
+						best = t;
+						first = (int)j;
+					}
+				}
+			}
+		}
+		QueryHit hit;
+		query.raycast(rays[q].origin, rays[q].dir, rays[q].length, QUERY_ALL, hit);
+		wrong += hit.index != first;
+
+		for(size_t j = 0; j < spheres.size(); j++) {
+			dists[j] = wrappedDistance(spheres[j].center, points[q]) - spheres[j].radius;
+		}
+		std::partial_sort(dists.begin(), dists.begin() + QUERY_BENCH_K, dists.end());
+		int n = query.nearest(points[q], QUERY_BENCH_K, QUERY_ALL, hits.data());
+		for(int i = 0; i < QUERY_BENCH_K; i++) {
+			if(n != QUERY_BENCH_K || std::abs(hits[i].dist - dists[i]) > 1e-3f) {
+				wrong++;
+				break;
+			}
+		}
+	}
+	return wrong;
+}
+
+BENCHMARK_SUITE(queries)
+{
+	std::srand(1);
+	std::vector<BoundingSphere> spheres;
+	for(int i = 0; i < QUERY_BENCH_ASTEROIDS; i++) {
+		glm::vec3 c(randomIn(-QUERY_BENCH_FIELD, QUERY_BENCH_FIELD), 0.0f, randomIn(-QUERY_BENCH_FIELD, QUERY_BENCH_FIELD));
+		spheres.push_back(BoundingSphere(randomIn(3.75f, 11.25f), c)); // The range of asteroid radii
+	}
+
+	std::vector<BoundingSphere> overlaps(QUERY_BENCH_QUERIES);
+	std::vector<RayQuery> rays(QUERY_BENCH_QUERIES);
+	std::vector<glm::vec3> points(QUERY_BENCH_QUERIES);
+	for(int i = 0; i < QUERY_BENCH_QUERIES; i++) {
+		points[i] = glm::vec3(randomIn(-QUERY_BENCH_FIELD, QUERY_BENCH_FIELD), 0.0f, randomIn(-QUERY_BENCH_FIELD, QUERY_BENCH_FIELD));
+		overlaps[i] = BoundingSphere(QUERY_BENCH_RADIUS, points[i]);
+		float a = randomIn(0.0f, 6.2831853f);
+		rays[i].origin = points[i];
+		rays[i].dir = glm::vec3(std::cos(a), 0.0f, std::sin(a));
+		rays[i].length = QUERY_BENCH_RAY;
+	}
+
+	SpatialQuery query;
+	query.setWrap(QUERY_BENCH_FIELD, QUERY_BENCH_FIELD);
+	std::cout << "  -- " << QUERY_BENCH_ASTEROIDS << " asteroids" << std::endl;
+	Benchmark::time("build", 10, [&](){
+		query.build(QUERY_ASTEROIDS, spheres);
+	});
+
+	std::vector<QueryHit> hits((size_t)QUERY_BENCH_QUERIES * QUERY_BENCH_K);
+	std::vector<int> counts(QUERY_BENCH_QUERIES);
+	int q = 0;
+	Benchmark::time("overlap", 100000, [&](){
+		counts[q] = query.overlap(overlaps[q], QUERY_ALL, hits.data(), QUERY_BENCH_K);
+		q = (q + 1) % QUERY_BENCH_QUERIES;
+	});
+	Benchmark::time("raycast", 100000, [&](){
+		query.raycast(rays[q].origin, rays[q].dir, rays[q].length, QUERY_ALL, hits[0]);
+		q = (q + 1) % QUERY_BENCH_QUERIES;
+	});
+	Benchmark::time("nearest", 100000, [&](){
+		counts[q] = query.nearest(points[q], QUERY_BENCH_K, QUERY_ALL, hits.data());
+		q = (q + 1) % QUERY_BENCH_QUERIES;
+	});
+
+	// A million of each at once, on every core. Under 1000 ns per batch query is over 1M a second.
+	std::cout << "  -- batches of " << QUERY_BENCH_QUERIES << " on " << std::max(1u, std::thread::hardware_concurrency()) << " threads" << std::endl;
+	double ns = Benchmark::time("overlap batch", 1, [&](){
+		query.overlapBatch(overlaps.data(), QUERY_BENCH_QUERIES, QUERY_ALL, hits.data(), QUERY_BENCH_K, counts.data());
+	});
+	Benchmark::report("  per query", ns / QUERY_BENCH_QUERIES);
+	ns = Benchmark::time("raycast batch", 1, [&](){
+		query.raycastBatch(rays.data(), QUERY_BENCH_QUERIES, QUERY_ALL, hits.data());
+	});
+	Benchmark::report("  per query", ns / QUERY_BENCH_QUERIES);
+	ns = Benchmark::time("nearest batch", 1, [&](){
+		query.nearestBatch(points.data(), QUERY_BENCH_QUERIES, QUERY_BENCH_K, QUERY_ALL, hits.data(), counts.data());
+	});
+	Benchmark::report("  per query", ns / QUERY_BENCH_QUERIES);
+
+	int wrong = check(query, spheres, overlaps, rays, points);
+	std::cout << "  " << 3 * QUERY_BENCH_CHECKED << " queries checked against all pairs, " << wrong << " different" << std::endl;
+}
@@ -0,0 +1,188 @@
+#include "RenderQueue.h"
+
+#include <algorithm>
+#include <cassert>
+#include <cstring>
+
+#include "GLSL.h"
+#include "GLState.h"
+#include "Shape.h"
+#include "Explosion.h"
+#include "Texture.h"
+#include "LineRenderer.h"
+#include "FrameUniforms.h"
+
+using namespace std;
+
+RenderQueue::RenderQueue()
+{
+}
+
+RenderQueue::~RenderQueue()
+{
+}
+
+void RenderQueue::init(const shared_ptr<PhongProgram> &phong, const shared_ptr<ParticleProgram> &particle,
+	const shared_ptr<Texture> &alphaTex, const shared_ptr<LineRenderer> &lines,
+	const shared_ptr<FrameUniforms> &frameUniforms)
+{
+	this->phong = phong;
+	this->particle = particle;
+	this->alphaTex = alphaTex;
+	this->lines = lines;
+	this->frameUniforms = frameUniforms;
+}
+
+int RenderQueue::addView(const glm::mat4 &P, int width, int height)
+{
+	assert(views.size() < RQ_MAX_VIEWS);
+	View v;
+	v.P = P;
+	v.screenSize = glm::vec2((float)width, (float)height);
+	views.push_back(v);
+	return views.size() - 1;
+}
+
+uint64_t RenderQueue::makeKey(int layer, unsigned program, int view, unsigned texture, unsigned mesh)
+{
+	return ((uint64_t)layer << RQ_LAYER_SHIFT) |
+		((uint64_t)(program & 0xFF) << RQ_PROGRAM_SHIFT) |
+		((uint64_t)(view & 0xF) << RQ_VIEW_SHIFT) |
+		((uint64_t)(texture & 0xFFFF) << RQ_TEXTURE_SHIFT) |
+		(uint64_t)(mesh & 0xFFFF);
+}
+
+uint64_t RenderQueue::makeDepthKey(float depth, unsigned program, unsigned texture)
+{
+	// The bits of a non-negative float sort like the float itself. Inverting them puts far draws first.
+	depth = std::max(depth, 0.0f);
+	uint32_t bits;
+	memcpy(&bits, &depth, sizeof(bits));
+	return ((uint64_t)LAYER_TRANSPARENT << RQ_LAYER_SHIFT) |
+		((uint64_t)(0xFFFFFFFFu - bits) << RQ_DEPTH_SHIFT) |
+		((uint64_t)(program & 0xFF) << RQ_DEPTH_PROGRAM_SHIFT) |
+		((uint64_t)(texture & 0xFFFF) << RQ_DEPTH_TEXTURE_SHIFT);
+}
+
+void RenderQueue::submitMesh(int view, const Shape *mesh, const glm::mat4 &MV, const glm::vec3 &kd, const glm::vec3 &lightPos)
+{
+	Packet p;
+	p.key = makeKey(LAYER_OPAQUE, phong->getPID(), view, 0, mesh->getMeshID());
+	p.type = PACKET_MESH;
+	p.view = view;
+	p.mesh = mesh;
+	p.particles = NULL;
+	p.MV = MV;
+	p.kd = kd;
+	p.lightPos = lightPos;
+	packets.push_back(p);
+}
+
+void RenderQueue::submitParticles(int view, Explosion *particles, const glm::mat4 &MV, const glm::vec3 &center)
+{
+	// Camera-space z is negative in front of the camera
+	float depth = -(MV * glm::vec4(center, 1.0f)).z;
+
+	Packet p;
+	p.key = makeDepthKey(depth, particle->getPID(), alphaTex->getID());
+	p.type = PACKET_PARTICLES;
+	p.view = view;
+	p.mesh = NULL;
+	p.particles = particles;
+	p.MV = MV;
+	packets.push_back(p);
+}
+
+void RenderQueue::submitLines(int view, const glm::mat4 &MV, bool drawGrid, bool drawAxisFrame)
+{
+	Packet p;
+	p.key = makeKey(LAYER_LINES, 0, view, 0, 0);
+	p.type = PACKET_LINES;
+	p.view = view;
+	p.drawGrid = drawGrid;
+	p.drawAxisFrame = drawAxisFrame;
+	p.mesh = NULL;
+	p.particles = NULL;
+	p.MV = MV;
+	packets.push_back(p);
+}
+
+void RenderQueue::append(RenderQueue &other)
+{
+	packets.insert(packets.end(), other.packets.begin(), other.packets.end());
+	other.packets.clear();
+	other.views.clear();
+}
+
+void RenderQueue::execute()
+{
+	// Sort (key, index) pairs, so packets with equal keys keep their submission order.
+	// Unlike stable_sort this needs no temporary buffer, and it moves 16 bytes per swap instead of a whole packet.
+	order.clear();
+	for (uint32_t i = 0; i < packets.size(); i++){
+		order.push_back(std::make_pair(packets[i].key, i));
+	}
+	sort(order.begin(), order.end());
+
+	int currView = -1;
+	int currType = -1;
+	glm::vec3 currLightPos;
+
+	for (auto o = order.begin(); o != order.end(); ++o){
+		const Packet *p = &packets[o->second];
+		const View &v = views.at(p->view);
+		bool newType = p->type != currType;
+
+		if (p->view != currView){
+			frameUniforms->setProjection(v.P);
+			currView = p->view;
+		}
+
+		switch (p->type){
+			case PACKET_MESH:
+				if (newType){
+					phong->bind();
+					GLState::disable(GL_BLEND);
+					GLState::depthMask(GL_TRUE);
+				}
+				if (newType || p->lightPos != currLightPos){
+					frameUniforms->setLightPos(p->lightPos);
+					currLightPos = p->lightPos;
+				}
+				phong->u.P.set(v.P);
+				phong->u.lightPos.set(p->lightPos);
+				phong->u.MV.set(p->MV);
+				phong->u.kd.set(p->kd);
+				p->mesh->draw(phong);
+				break;
+
+			case PACKET_PARTICLES:
+				if (newType){
+					// Particles blend over the scene without writing depth
+					particle->bind();
+					GLState::enable(GL_BLEND);
+					GLState::depthMask(GL_FALSE);
+					GLState::blendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+					particle->u.alphaTexture.set(alphaTex->getUnit());
+					alphaTex->bind();
+				}
+				particle->u.P.set(v.P);
+				particle->u.MV.set(p->MV);
+				particle->u.screenSize.set(v.screenSize);
+				p->particles->drawParticles(particle);
+				break;
+
+			case PACKET_LINES:
+				// Binds its own program and state
+				lines->draw(v.P, p->MV, p->drawGrid, p->drawAxisFrame);
+				break;
+		}
+
+		currType = p->type;
+	}
+
+	packets.clear();
+	views.clear();
+
+	GLSL::checkError(GET_FILE_LINE);
+}
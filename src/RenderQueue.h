@@ -0,0 +1,112 @@
+#pragma once
+#ifndef RENDER_QUEUE_H
+#define RENDER_QUEUE_H
+
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+#define GLM_FORCE_RADIANS
+#include <glm/glm.hpp>
+
+#include "Uniforms.h"
+
+class Shape;
+class Explosion;
+class Texture;
+class LineRenderer;
+class FrameUniforms;
+
+// Sort key layout, most significant bits first:
+//   opaque and lines: layer (2) | program (8) | view (4) | texture (16) | mesh (16)
+//   transparent:      layer (2) | inverted view depth (32) | program (8) | texture (16)
+#define RQ_LAYER_SHIFT 62
+#define RQ_PROGRAM_SHIFT 54
+#define RQ_VIEW_SHIFT 50
+#define RQ_TEXTURE_SHIFT 34
+#define RQ_DEPTH_SHIFT 30
+#define RQ_DEPTH_PROGRAM_SHIFT 22
+#define RQ_DEPTH_TEXTURE_SHIFT 6
+#define RQ_MAX_VIEWS 16
+
+/**
+ * Collects the frame's draws as small packets (a 64-bit sort key plus what the draw needs),
+ * then sorts them and issues them in one pass.
+ * - Opaque meshes come first, grouped by program, view, texture and mesh, so each switch happens once.
+ * - The stars/beams/grid come next, in one packet per view.
+ * - Blended particles come last, back to front, with depth writes off.
+ * The submit functions don't touch GL. Packets can be recorded into separate queues (e.g. one
+ * per worker thread) and merged with append() before the GL thread calls execute().
+ */
+class RenderQueue
+{
+public:
+	enum LAYERS {
+		LAYER_OPAQUE = 0,
+		LAYER_LINES,
+		LAYER_TRANSPARENT
+	};
+
+	RenderQueue();
+	virtual ~RenderQueue();
+
+	void init(const std::shared_ptr<PhongProgram> &phong, const std::shared_ptr<ParticleProgram> &particle,
+		const std::shared_ptr<Texture> &alphaTex, const std::shared_ptr<LineRenderer> &lines,
+		const std::shared_ptr<FrameUniforms> &frameUniforms);
+
+	// A projection shared by a group of draws. Returns the view index to pass to the submit functions.
+	int addView(const glm::mat4 &P, int width, int height);
+
+	void submitMesh(int view, const Shape *mesh, const glm::mat4 &MV, const glm::vec3 &kd, const glm::vec3 &lightPos);
+	// center is in the object space of MV and is only used to sort the particle systems by depth
+	void submitParticles(int view, Explosion *particles, const glm::mat4 &MV, const glm::vec3 &center);
+	void submitLines(int view, const glm::mat4 &MV, bool drawGrid, bool drawAxisFrame);
+
+	// Moves other's packets into this queue. Both queues must have added the same views.
+	void append(RenderQueue &other);
+
+	// Sorts and draws everything submitted since the last call, then empties the queue
+	void execute();
+
+	size_t size() const { return packets.size(); }
+
+private:
+	enum PACKET_TYPES {
+		PACKET_MESH,
+		PACKET_PARTICLES,
+		PACKET_LINES
+	};
+
+	struct View {
+		glm::mat4 P;
+		glm::vec2 screenSize;
+	};
+
+	struct Packet {
+		uint64_t key;
+		uint8_t type;
+		uint8_t view;
+		bool drawGrid;
+		bool drawAxisFrame;
+		const Shape *mesh;
+		Explosion *particles;
+		glm::mat4 MV;
+		glm::vec3 kd;
+		glm::vec3 lightPos;
+	};
+
+	static uint64_t makeKey(int layer, unsigned program, int view, unsigned texture, unsigned mesh);
+	static uint64_t makeDepthKey(float depth, unsigned program, unsigned texture);
+
+	std::shared_ptr<PhongProgram> phong;
+	std::shared_ptr<ParticleProgram> particle;
+	std::shared_ptr<Texture> alphaTex;
+	std::shared_ptr<LineRenderer> lines;
+	std::shared_ptr<FrameUniforms> frameUniforms;
+
+	std::vector<View> views;
+	std::vector<Packet> packets;
+	std::vector<std::pair<uint64_t, uint32_t> > order; // Sort key and packet index, reused every frame
+};
+
+#endif
@@ -0,0 +1,143 @@
+#include "ScalingSweep.h"
+
+#include <algorithm>
+#include <cmath>
+#include <fstream>
+#include <iomanip>
+#include <sstream>
+
+namespace ScalingSweep {
+
+	static const char *names[SWEEP_NUM_SUBSYSTEMS] = {
+		"frame",
+		"collision",
+		"movement",
+		"particles",
+		"submission",
+		"execute"
+	};
+
+	const char *getName(int subsystem)
+	{
+		return names[subsystem];
+	}
+
+	static bool usable(double x, double y)
+	{
+		return x > 0.0 && y >= SWEEP_MIN_MS;
+	}
+
+	double fitExponent(const std::vector<double> &x, const std::vector<double> &y)
+	{
+		double sx = 0.0, sy = 0.0, sxx = 0.0, sxy = 0.0;
+		int n = 0;
+		for(size_t i = 0; i < x.size() && i < y.size(); i++) {
+			if(!usable(x[i], y[i])) {
+				continue;
+			}
+			double lx = std::log(x[i]);
+			double ly = std::log(y[i]);
+			sx += lx;
+			sy += ly;
+			sxx += lx * lx;
+			sxy += lx * ly;
+			n++;
+		}
+		double d = n * sxx - sx * sx;
+		if(n < 2 || d <= 0.0) {
+			return NAN;
+		}
+		return (n * sxy - sx * sy) / d;
+	}
+
+	void readMemory(double &rssMB, double &peakMB)
+	{
+		rssMB = peakMB = 0.0;
+		std::ifstream in("/proc/self/status");
+		std::string line;
+		while(std::getline(in, line)) {
+			std::istringstream fields(line);
+			std::string key;
+			double kB = 0.0;
+			fields >> key >> kB;
+			if(key == "VmRSS:") {
+				rssMB = kB / 1024.0;
+			}
+			else if(key == "VmHWM:") {
+				peakMB = kB / 1024.0;
+			}
+		}
+	}
+
+	// Prints the fitted exponent of y against x, and where the slope between neighbouring points
+	// first goes over SWEEP_SUPERLINEAR
+	static void writeFit(std::ostream &out, const char *name, const std::vector<double> &x, const std::vector<double> &y)
+	{
+		out << "    " << std::left << std::setw(12) << name << std::right;
+		double k = fitExponent(x, y);
+		if(std::isnan(k)) {
+			out << "  too fast to fit" << std::endl;
+			return;
+		}
+		out << "  O(n^" << std::setprecision(2) << k << ")";
+
+		int from = -1;
+		double worst = 0.0;
+		for(size_t i = 1; i < x.size(); i++) {
+			if(!usable(x[i - 1], y[i - 1]) || !usable(x[i], y[i]) || x[i] <= x[i - 1]) {
+				continue;
+			}
+			double local = std::log(y[i] / y[i - 1]) / std::log(x[i] / x[i - 1]);
+			if(local > SWEEP_SUPERLINEAR && from < 0) {
+				from = (int)i - 1;
+			}
+			worst = std::max(worst, local);
+		}
+		if(k > SWEEP_SUPERLINEAR || from >= 0) {
+			out << "  SUPERLINEAR";
+			if(from >= 0) {
+				out << " from n = " << std::setprecision(0) << x[from] << " (steepest step n^" << std::setprecision(2) << worst << ")";
+			}
+		}
+		out << std::endl;
+	}
+
+	void writeTable(std::ostream &out, const std::string &title, const std::string &xName,
+		const std::vector<double> &x, const std::vector<SweepPoint> &points)
+	{
+		out << std::fixed;
+		out << "== " << title << " ==" << std::endl;
+		out << std::setw(10) << "start" << std::setw(11) << "explosions" << std::setw(10) << "asteroids" << std::setw(10) << "particles";
+		for(int s = 0; s < SWEEP_NUM_SUBSYSTEMS; s++) {
+			out << std::setw(12) << names[s];
+		}
+		out << std::setw(12) << "frame p99" << std::setw(14) << "allocs/frame" << std::setw(10) << "rss MB" << std::setw(10) << "peak MB" << std::endl;
+
+		for(size_t i = 0; i < points.size(); i++) {
+			const SweepPoint &p = points[i];
+			out << std::setw(10) << p.asteroids << std::setw(11) << p.explosions;
+			out << std::setprecision(1) << std::setw(10) << p.liveAsteroids << std::setw(10) << p.liveParticles;
+			out << std::setprecision(3);
+			for(int s = 0; s < SWEEP_NUM_SUBSYSTEMS; s++) {
+				out << std::setw(12) << p.meanMs[s];
+			}
+			out << std::setw(12) << p.p99Ms[SWEEP_FRAME];
+			out << std::setprecision(1) << std::setw(14) << p.allocsPerFrame << std::setw(10) << p.rssMB << std::setw(10) << p.peakRssMB << std::endl;
+		}
+
+		out << "  Mean ms per frame; asteroids and particles are the mean live counts. Exponents against live " << xName << ":" << std::endl;
+		std::vector<double> y(points.size());
+		for(int s = 0; s < SWEEP_NUM_SUBSYSTEMS; s++) {
+			for(size_t i = 0; i < points.size(); i++) {
+				y[i] = points[i].meanMs[s];
+			}
+			writeFit(out, names[s], x, y);
+		}
+		for(size_t i = 0; i < points.size(); i++) {
+			y[i] = points[i].allocsPerFrame;
+		}
+		writeFit(out, "allocations", x, y);
+		out << std::defaultfloat << std::endl;
+	}
+
+}
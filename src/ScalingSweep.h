@@ -0,0 +1,64 @@
+#pragma once
+#ifndef SCALING_SWEEP_H
+#define SCALING_SWEEP_H
+
+#include <ostream>
+#include <string>
+#include <vector>
+
+#define SWEEP_SEED 450              // srand() seed at the start of every point, so each run replays the same game
+#define SWEEP_WARMUP_TICKS 60       // Run but not measured, so pools and caches have filled
+#define SWEEP_TICKS 600             // Measured ticks (one frame each) per point
+#define SWEEP_MIN_ASTEROIDS 25
+#define SWEEP_MAX_ASTEROIDS 800     // Doubled from the minimum
+#define SWEEP_BASE_EXPLOSIONS 2     // Kept alive while the asteroid count is swept
+#define SWEEP_MAX_EXPLOSIONS 32     // Doubled from 1 while the density is swept
+#define SWEEP_SUPERLINEAR 1.2       // A log-log slope above this counts as superlinear
+#define SWEEP_MIN_MS 0.005          // Means below this are mostly timer noise and are left out of fits
+
+enum SWEEP_SUBSYSTEMS {
+	SWEEP_FRAME,
+	SWEEP_COLLISION,  // sim_collisions
+	SWEEP_MOVEMENT,   // sim_move
+	SWEEP_PARTICLES,  // Stepping and submitting explosions and flames
+	SWEEP_SUBMISSION, // Filling the render queue, less the particles
+	SWEEP_EXECUTE,    // Sorting and issuing the render queue
+	SWEEP_NUM_SUBSYSTEMS
+};
+
+// What one run of the scripted workload measured
+struct SweepPoint {
+	int asteroids = 0;           // Asteroids at the start
+	int explosions = 0;          // Explosions kept alive
+	double liveAsteroids = 0.0;  // Mean over the measured ticks (they split when shot)
+	double liveParticles = 0.0;
+	double meanMs[SWEEP_NUM_SUBSYSTEMS] = {};
+	double p99Ms[SWEEP_NUM_SUBSYSTEMS] = {};
+	double allocsPerFrame = 0.0;
+	double rssMB = 0.0;
+	double peakRssMB = 0.0;
+};
+
+/**
+ * The report side of --scaling-sweep. main.cpp runs the workload at each point; this fits how
+ * every subsystem's cost grows with the swept variable and writes the tables.
+ */
+namespace ScalingSweep {
+
+	const char *getName(int subsystem);
+
+	// Least-squares slope of log(y) against log(x), skipping points where either is too small to
+	// mean anything. Returns NAN with fewer than two usable points.
+	double fitExponent(const std::vector<double> &x, const std::vector<double> &y);
+
+	// Resident and peak resident memory of this process in MB, from /proc (0 where there is none)
+	void readMemory(double &rssMB, double &peakMB);
+
+	// One table of the points, then each subsystem's exponent against x (named xName) and the
+	// first point where it turns superlinear
+	void writeTable(std::ostream &out, const std::string &title, const std::string &xName,
+		const std::vector<double> &x, const std::vector<SweepPoint> &points);
+
+}
+
+#endif
@@ -4,6 +4,7 @@
 
 #include "GLSL.h"
 #include "Program.h"
+#include "GLState.h"
 
 #define GLM_FORCE_RADIANS
 #include <glm/glm.hpp>
@@ -16,7 +17,8 @@ using namespace std;
 Shape::Shape() :
 	posBufID(0),
 	norBufID(0),
-	texBufID(0)
+	texBufID(0),
+	vaoID(0)
 {
 }
 
@@ -68,6 +70,15 @@ void Shape::loadMesh(const string &meshName)
 			}
 		}
 	}
+	updateBounds();
+}
+
+void Shape::setMesh(std::vector<float> &pos, std::vector<float> &nor)
+{
+	posBuf.swap(pos);
+	norBuf.swap(nor);
+	texBuf.clear();
+	updateBounds();
 }
 
 void Shape::fitToUnitBox()
@@ -95,72 +106,121 @@ void Shape::fitToUnitBox()
 		posBuf[i+1] = (posBuf[i+1] - center.y) * scale;
 		posBuf[i+2] = (posBuf[i+2] - center.z) * scale;
 	}
+	updateBounds();
+}
+
+void Shape::updateBounds()
+{
+	bvh.build(posBuf);
+
+	// Each vertex once, since posBuf repeats them for every triangle they are in
+	std::vector<glm::vec3> points(posBuf.size() / 3);
+	for(size_t i = 0; i < points.size(); i++) {
+		points[i] = glm::vec3(posBuf[3*i], posBuf[3*i+1], posBuf[3*i+2]);
+	}
+	std::sort(points.begin(), points.end(), [](const glm::vec3 &a, const glm::vec3 &b){
+		return a.x != b.x ? a.x < b.x : (a.y != b.y ? a.y < b.y : a.z < b.z);
+	});
+	points.erase(std::unique(points.begin(), points.end()), points.end());
+
+	sphere = BoundingSphere::enclosing(points);
+	box = AABB::enclosing(points);
+	orientedBox = OBB::enclosing(points);
 }
 
 void Shape::init()
 {
 	// Send the position array to the GPU
 	glGenBuffers(1, &posBufID);
-	glBindBuffer(GL_ARRAY_BUFFER, posBufID);
+	GLState::bindArrayBuffer(posBufID);
 	glBufferData(GL_ARRAY_BUFFER, posBuf.size()*sizeof(float), &posBuf[0], GL_STATIC_DRAW);
 	
 	// Send the normal array to the GPU
 	if(!norBuf.empty()) {
 		glGenBuffers(1, &norBufID);
-		glBindBuffer(GL_ARRAY_BUFFER, norBufID);
+		GLState::bindArrayBuffer(norBufID);
 		glBufferData(GL_ARRAY_BUFFER, norBuf.size()*sizeof(float), &norBuf[0], GL_STATIC_DRAW);
 	}
 	
 	// Send the texture array to the GPU
 	if(!texBuf.empty()) {
 		glGenBuffers(1, &texBufID);
-		glBindBuffer(GL_ARRAY_BUFFER, texBufID);
+		GLState::bindArrayBuffer(texBufID);
 		glBufferData(GL_ARRAY_BUFFER, texBuf.size()*sizeof(float), &texBuf[0], GL_STATIC_DRAW);
 	}
 	
+	// On a core profile, record the attribute setup once in a vertex array object.
+	// The GLSL 330 shaders use fixed attribute locations, so this works with any program.
+	if(coreProfile) {
+		glGenVertexArrays(1, &vaoID);
+		GLState::bindVertexArray(vaoID);
+		glEnableVertexAttribArray(ATTRIB_POS);
+		GLState::bindArrayBuffer(posBufID);
+		glVertexAttribPointer(ATTRIB_POS, 3, GL_FLOAT, GL_FALSE, 0, (const void *)0);
+		if(norBufID != 0) {
+			glEnableVertexAttribArray(ATTRIB_NOR);
+			GLState::bindArrayBuffer(norBufID);
+			glVertexAttribPointer(ATTRIB_NOR, 3, GL_FLOAT, GL_FALSE, 0, (const void *)0);
+		}
+		if(texBufID != 0) {
+			glEnableVertexAttribArray(ATTRIB_TEX);
+			GLState::bindArrayBuffer(texBufID);
+			glVertexAttribPointer(ATTRIB_TEX, 2, GL_FLOAT, GL_FALSE, 0, (const void *)0);
+		}
+		GLState::bindVertexArray(0);
+	}
+	
 	// Unbind the arrays
-	glBindBuffer(GL_ARRAY_BUFFER, 0);
+	GLState::bindArrayBuffer(0);
 	
 	GLSL::checkError(GET_FILE_LINE);
 }
 
 void Shape::draw(const shared_ptr<Program> prog) const
 {
+	int count = (int)posBuf.size()/3; // number of indices to be rendered
+	
+	if(vaoID != 0) {
+		GLState::bindVertexArray(vaoID);
+		glDrawArrays(GL_TRIANGLES, 0, count);
+		GLSL::checkError(GET_FILE_LINE);
+		return;
+	}
+	
+	int h_pos = prog->getAttribute(ATTRIB_POS);
+	int h_nor = prog->getAttribute(ATTRIB_NOR);
+	int h_tex = prog->getAttribute(ATTRIB_TEX);
+	bool useNor = h_nor != -1 && norBufID != 0;
+	bool useTex = h_tex != -1 && texBufID != 0;
+	
+	// Enable exactly the arrays this draw reads
+	unsigned mask = 1u << h_pos;
+	if(useNor) {
+		mask |= 1u << h_nor;
+	}
+	if(useTex) {
+		mask |= 1u << h_tex;
+	}
+	GLState::setAttribArrays(mask);
+	
 	// Bind position buffer
-	int h_pos = prog->getAttribute("aPos");
-	glEnableVertexAttribArray(h_pos);
-	glBindBuffer(GL_ARRAY_BUFFER, posBufID);
+	GLState::bindArrayBuffer(posBufID);
 	glVertexAttribPointer(h_pos, 3, GL_FLOAT, GL_FALSE, 0, (const void *)0);
 	
 	// Bind normal buffer
-	int h_nor = prog->getAttribute("aNor");
-	if(h_nor != -1 && norBufID != 0) {
-		glEnableVertexAttribArray(h_nor);
-		glBindBuffer(GL_ARRAY_BUFFER, norBufID);
+	if(useNor) {
+		GLState::bindArrayBuffer(norBufID);
 		glVertexAttribPointer(h_nor, 3, GL_FLOAT, GL_FALSE, 0, (const void *)0);
 	}
 	
 	// Bind texcoords buffer
-	int h_tex = prog->getAttribute("aTex");
-	if(h_tex != -1 && texBufID != 0) {
-		glEnableVertexAttribArray(h_tex);
-		glBindBuffer(GL_ARRAY_BUFFER, texBufID);
+	if(useTex) {
+		GLState::bindArrayBuffer(texBufID);
 		glVertexAttribPointer(h_tex, 2, GL_FLOAT, GL_FALSE, 0, (const void *)0);
 	}
 	
 	// Draw
-	int count = (int)posBuf.size()/3; // number of indices to be rendered
 	glDrawArrays(GL_TRIANGLES, 0, count);
 	
-	// Disable and unbind
-	if(h_tex != -1) {
-		glDisableVertexAttribArray(h_tex);
-	}
-	if(h_nor != -1) {
-		glDisableVertexAttribArray(h_nor);
-	}
-	glDisableVertexAttribArray(h_pos);
-	glBindBuffer(GL_ARRAY_BUFFER, 0);
-	
 	GLSL::checkError(GET_FILE_LINE);
 }
@@ -6,6 +6,10 @@
 #include <vector>
 #include <memory>
 
+#include "BoundingBox.h"
+#include "BoundingSphere.h"
+#include "MeshBVH.h"
+
 class Program;
 
 /**
@@ -14,6 +18,9 @@ class Program;
  * - norBuf should be of length 3*ntris (if normals are available)
  * - texBuf should be of length 2*ntris (if texture coords are available)
  * posBufID, norBufID, and texBufID are OpenGL buffer identifiers.
+ * vaoID is only created on a core profile context, where it replaces the per-draw attribute setup.
+ * The bounding volumes and bvh are rebuilt whenever posBuf changes. They are in the mesh's own
+ * space; instances take them into the world with their model matrices.
  */
 class Shape
 {
@@ -21,18 +28,37 @@ public:
 	Shape();
 	virtual ~Shape();
 	void loadMesh(const std::string &meshName);
+	// Takes generated triangles instead of loading them (swaps the vectors in)
+	void setMesh(std::vector<float> &pos, std::vector<float> &nor);
 	void fitToUnitBox();
 	void init();
 	virtual void draw(const std::shared_ptr<Program> prog) const;
 	std::vector<float>* getPosBuf(){ return &posBuf; }
+	const MeshBVH &getBVH() const { return bvh; }
+	// The smallest sphere, the box along the axes and the box along the principal axes around
+	// the vertices
+	const BoundingSphere &getMeshSphere() const { return sphere; }
+	const AABB &getMeshAABB() const { return box; }
+	const OBB &getMeshOBB() const { return orientedBox; }
+	// Identifies the vertex data for draw sorting
+	unsigned getMeshID() const { return posBufID; }
+	// The mesh to draw at this distance. Only generated asteroids have more than one level of detail.
+	virtual const Shape *getLOD(float distance) const { return this; }
 	
 protected:
+	void updateBounds();
+
 	std::vector<float> posBuf;
 	std::vector<float> norBuf;
 	std::vector<float> texBuf;
 	unsigned posBufID;
 	unsigned norBufID;
 	unsigned texBufID;
+	unsigned vaoID;
+	MeshBVH bvh;
+	BoundingSphere sphere;
+	AABB box;
+	OBB orientedBox;
 };
 
 #endif
@@ -6,6 +6,10 @@
 #include "Shape.h"
 #include "MatrixStack.h"
 #include "ExhaustFire.h"
+#include "RenderQueue.h"
+#include "WorldSnapshot.h"
+#include "Input.h"
+#include "TimerWheel.h"
 
 #define GLM_FORCE_RADIANS
 #include <glm/glm.hpp>
@@ -17,9 +21,8 @@
 #define MAX_DIR_VEL 0.8f
 #define MAX_ROLL M_PI_4
 
-extern int camType;
-extern double tGlobal;
-extern double score;
+extern thread_local double tGlobal;
+extern TimerWheel simTimers;
 extern bool drawBoundingBox;
 
 enum ANIMATIONS{
@@ -34,20 +37,24 @@ class Ship: public Shape
 {
     public:
         Ship(){}
-        ~Ship(){}
+        ~Ship();
         
         void loadMesh(const std::string &meshName);
         void initExhaust(const std::string RESOURCE_DIR);
         
-        void drawShip(const std::shared_ptr<Program> prog, std::shared_ptr<MatrixStack> &MV);
-        void drawFlames(std::shared_ptr<MatrixStack> &P, std::shared_ptr<MatrixStack> &MV, int width, int height, 
-            std::shared_ptr<Texture> &alphaTex, std::shared_ptr<Program> &prog);
+        void updateAnimation();
+        void getSnapshot(ShipSnapshot &s);
+        void submitFlames(RenderQueue &queue, int view, std::shared_ptr<MatrixStack> &MV, const ShipSnapshot &s);
         
         void performBarrelRoll(char direction);
         void performSomersault();
         int getCurrAnim();
 
         void boundShip();
+        // Moves the ship by d in world space, for the open world's floating origin
+        void rebase(const glm::vec3 &d);
+        // Moves the flames' world-space particles by d. Render thread only.
+        void shiftFlames(const glm::vec3 &d);
         
         glm::vec3 getPos();
         glm::vec3 getVel();
@@ -56,34 +63,61 @@ class Ship: public Shape
         float getRoll() { return this->roll; }
         float getYaw() { return this->yaw; }
 
-        void moveShip(bool keyPresses[256]);
-        void applyMVTransforms(std::shared_ptr<MatrixStack> &MV);
-        MatrixStack getModelMatrix();
+        void moveShip(const std::bitset<INPUT_NUM_KEYS> &keyPresses);
+        void applyMVTransforms(MatrixStack &MV);
+        const glm::mat4 &getModelMatrix();
+        // Where the mesh is drawn (and collides), roll and maneuver included
+        const glm::mat4 &getDrawMatrix();
+        const glm::mat4 &getEMatrix();
         void updatePrevPos();
         void setInvincible();
         bool isInvincible();
 
-        std::shared_ptr<BoundingSphere> getBoundingSphere();
+        // The mesh's bounding volumes where it is drawn
+        BoundingSphere getBoundingSphere();
+        OBB getOBB();
 
-        void gameOver(std::string RESOURCE_DIR);
-
-        void drawExplosion(std::shared_ptr<MatrixStack> &P, std::shared_ptr<MatrixStack> &MV, int width, int height, 
-            std::shared_ptr<Texture> &alphaTex, std::shared_ptr<Program> &prog);
-        glm::mat4 generateEMatrix();
+        void gameOver();
+        // Puts the ship back at the origin, at rest and out of any maneuver, for a fresh run
+        void respawn();
+        double getTimeGameOver() { return timeGameOver; }
 
     private:
-        glm::vec3 p_prev; // The previous position of the ship
-        glm::vec3 p; // The position of the ship in space
-        glm::vec3 v; // The velocity of the ship
+        glm::vec3 p_prev = glm::vec3(0.0f); // The previous position of the ship
+        glm::vec3 p = glm::vec3(0.0f); // The position of the ship in space
+        glm::vec3 v = glm::vec3(0.0f); // The velocity of the ship
         float roll = 0.0f;
         float yaw = 0.0f;
         int currAnim = NONE;
+
+        // The current maneuver: when it started and ends, and its size (which scales with speed)
+        double tStart = 0.0;
+        double tEnd = 0.0;
+        float unit = 0.0f;
+
+        double timeHit = -1.0; // When the ship last collided with an asteroid
+        bool invincible = false;
+        TimerHandle invincibleTimer = 0; // Ends the invincibility
+        static void endInvincibility(void *ship, uint64_t);
+        bool wPressed = false, aPressed = false, dPressed = false, sPressed = false;
         
-        void processKeys(bool keyPresses[256]);
-        void setKeyframes(glm::vec3 p, int animType);
+        void processKeys(const std::bitset<INPUT_NUM_KEYS> &keyPresses);
+        void startManeuver(int animType);
+        float getAnimParam();
+
+        // Everything below is derived from p, p_prev, yaw, roll and the animation parameter.
+        // updateTransforms() rebuilds it only when the ship has moved since the last call or
+        // a maneuver has advanced, so the several callers in a tick share one evaluation.
+        void updateTransforms();
+        bool transformsDirty = true;
+        float cachedAnimParam = -1.0f;
+        glm::mat4 cachedM; // Model matrix the camera follows
+        glm::mat4 cachedE; // Maneuver transform, identity outside of one
+        glm::mat4 cachedDrawM; // Model matrix with the roll or maneuver applied
+        glm::vec3 cachedPos;
+        glm::vec3 cachedForward;
 
         double timeGameOver = INFINITY;
-        std::shared_ptr<Explosion> e;
         std::vector<std::shared_ptr<ExhaustFire> > flames;
 };
 
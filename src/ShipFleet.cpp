@@ -0,0 +1,232 @@
+#include "ShipFleet.h"
+#include "Ship.h"
+#include "Maneuver.h"
+#include "MatrixStack.h"
+#include "Particle.h"
+
+#include <algorithm>
+#include <cmath>
+
+void ShipFleet::reserve(int n)
+{
+	x.reserve(n); y.reserve(n); z.reserve(n);
+	xPrev.reserve(n); yPrev.reserve(n); zPrev.reserve(n);
+	yaw.reserve(n);
+	speed.reserve(n);
+	unit.reserve(n);
+	tStart.reserve(n);
+	anim.reserve(n);
+	thrust.reserve(n);
+	M.reserve(n); E.reserve(n); drawM.reserve(n);
+
+	active.reserve(n); activeAnim.reserve(n); activeIndex.reserve(n);
+	activeProgress.reserve(n); activeUnit.reserve(n); activeWeight.reserve(n);
+	activeE.reserve(n);
+
+	int particles = 2 * FLEET_EXHAUST_PARTICLES * n;
+	exPos.reserve(3 * particles); exDir.reserve(3 * particles);
+	exSpeed.reserve(particles); exAlpha.reserve(particles);
+	exEnd.reserve(particles); exLifespan.reserve(particles);
+}
+
+int ShipFleet::add(const glm::vec3 &pos, float angle)
+{
+	x.push_back(pos.x); y.push_back(pos.y); z.push_back(pos.z);
+	xPrev.push_back(pos.x); yPrev.push_back(pos.y); zPrev.push_back(pos.z);
+	yaw.push_back(angle);
+	speed.push_back(0.0f);
+	unit.push_back(0.0f);
+	tStart.push_back(0.0);
+	anim.push_back(NONE);
+	thrust.push_back(false);
+	M.push_back(glm::mat4(1.0f));
+	E.push_back(glm::mat4(1.0f));
+	drawM.push_back(glm::mat4(1.0f));
+
+	// Dead particles, parked at the ship until it thrusts
+	for(int k = 0; k < 2 * FLEET_EXHAUST_PARTICLES; k++) {
+		exPos.push_back(pos.x); exPos.push_back(pos.y); exPos.push_back(pos.z);
+		exDir.push_back(0.0f); exDir.push_back(0.0f); exDir.push_back(0.0f);
+		exSpeed.push_back(0.0f);
+		exAlpha.push_back(0.0f);
+		exEnd.push_back(0.0f);
+		exLifespan.push_back(1.0f);
+	}
+
+	return size() - 1;
+}
+
+void ShipFleet::startManeuver(int i, int animType, double t)
+{
+	if(anim[i] != NONE) {
+		return;
+	}
+
+	// Same sizing as Ship: the faster the ship, the bigger the maneuver
+	unit[i] = (2.0f * std::abs(speed[i]) + 1.0f) * UNIT / 2.0f;
+	tStart[i] = t;
+	anim[i] = animType;
+}
+
+void ShipFleet::step(double t)
+{
+	move();
+	updateAnimations(t);
+	evaluateManeuvers(t);
+	buildMatrices();
+	stepExhaust(t);
+
+	// Ship::updatePrevPos()
+	xPrev = x;
+	yPrev = y;
+	zPrev = z;
+}
+
+// Ship::moveShip(): p += R(yaw) * (0, 0, speed)
+void ShipFleet::move()
+{
+	int n = size();
+	for(int i = 0; i < n; i++) {
+		x[i] += std::sin(yaw[i]) * speed[i];
+		z[i] += std::cos(yaw[i]) * speed[i];
+	}
+}
+
+// Ship::updateAnimation(): ends finished maneuvers, moving rolled ships to where the roll left them
+void ShipFleet::updateAnimations(double t)
+{
+	int n = size();
+	for(int i = 0; i < n; i++) {
+		if(anim[i] == NONE || (t - tStart[i]) * (2.0f + std::abs(speed[i])) <= MANEUVER_SEGMENTS) {
+			continue;
+		}
+
+		float side = 0.0f;
+		if(anim[i] == LEFT_ROLL) {
+			side = ROLL_FACTOR * unit[i];
+		}
+		else if(anim[i] == RIGHT_ROLL) {
+			side = -ROLL_FACTOR * unit[i];
+		}
+
+		// R(yaw) * (side, 0, 0)
+		float dx = std::cos(yaw[i]) * side;
+		float dz = -std::sin(yaw[i]) * side;
+		x[i] += dx; xPrev[i] += dx;
+		z[i] += dz; zPrev[i] += dz;
+
+		anim[i] = NONE;
+	}
+}
+
+void ShipFleet::evaluateManeuvers(double t)
+{
+	int n = size();
+
+	active.clear();
+	activeAnim.clear();
+	activeProgress.clear();
+	activeUnit.clear();
+	for(int i = 0; i < n; i++) {
+		if(anim[i] == NONE) {
+			E[i] = glm::mat4(1.0f);
+			continue;
+		}
+		active.push_back(i);
+		activeAnim.push_back(anim[i]);
+		activeProgress.push_back(std::min((t - tStart[i]) * (2.0f + std::abs(speed[i])) / MANEUVER_SEGMENTS, 1.0));
+		activeUnit.push_back(unit[i]);
+	}
+
+	int m = (int)active.size();
+	activeIndex.resize(m);
+	activeWeight.resize(m);
+	activeE.resize(m);
+	if(m > 0) {
+		Maneuvers::evaluate(m, &activeAnim[0], &activeProgress[0], &activeUnit[0], &activeIndex[0], &activeWeight[0], &activeE[0]);
+	}
+
+	for(int k = 0; k < m; k++) {
+		E[active[k]] = activeE[k];
+	}
+}
+
+// Ship::updateTransforms(), for every ship
+void ShipFleet::buildMatrices()
+{
+	int n = size();
+	for(int i = 0; i < n; i++) {
+		glm::vec3 p(x[i], y[i], z[i]);
+		glm::vec3 pPrev(xPrev[i], yPrev[i], zPrev[i]);
+
+		MatrixStack S;
+		S.translate(0.0f, -0.3f, 0.0f);
+		S.scale(1.25f, 1.25f, 1.25f);
+		S.rotate(M_PI, 0, 1, 0);
+		S.translate(pPrev);
+		S.rotate(yaw[i], 0, 1, 0);
+		S.translate(p - pPrev);
+
+		drawM[i] = S.topMatrix() * E[i];
+
+		if(anim[i] == LEFT_ROLL || anim[i] == RIGHT_ROLL) {
+			S.translate(E[i][3]);
+		}
+		M[i] = S.topMatrix();
+	}
+}
+
+// ExhaustFire::step() for both nozzles of every ship
+void ShipFleet::stepExhaust(double t)
+{
+	float tf = (float)t;
+	int particles = (int)exSpeed.size();
+
+	// Every particle moves, in one pass over contiguous floats
+	for(int k = 0; k < particles; k++) {
+		exSpeed[k] *= PARTICLE_DECELERATION;
+		exPos[3*k+0] += exSpeed[k] * exDir[3*k+0];
+		exPos[3*k+1] += exSpeed[k] * exDir[3*k+1];
+		exPos[3*k+2] += exSpeed[k] * exDir[3*k+2];
+		exAlpha[k] = std::max((exEnd[k] - tf) / exLifespan[k], 0.0f);
+	}
+
+	// Then dead particles of thrusting ships are reborn at their nozzles
+	int n = size();
+	for(int i = 0; i < n; i++) {
+		if(!thrust[i]) {
+			continue;
+		}
+
+		glm::vec3 dirMin = M[i] * worldDirMin;
+		glm::vec3 dirMax = M[i] * worldDirMax;
+
+		for(int nozzle = 0; nozzle < 2; nozzle++) {
+			float side = (nozzle == LEFT) ? -EXHAUST_X_OFFSET : EXHAUST_X_OFFSET;
+			glm::vec3 base = M[i] * glm::vec4(side, EXHAUST_Y_OFFSET, EXHAUST_Z_OFFSET, 1.0f);
+
+			int first = (2 * i + nozzle) * FLEET_EXHAUST_PARTICLES;
+			for(int k = first; k < first + FLEET_EXHAUST_PARTICLES; k++) {
+				if(exAlpha[k] > 0.0f) {
+					continue;
+				}
+
+				glm::vec3 dir = glm::normalize(glm::vec3(
+					Particle::randFloat(dirMin.x, dirMax.x),
+					Particle::randFloat(dirMin.y, dirMax.y),
+					Particle::randFloat(dirMin.z, dirMax.z)));
+
+				exPos[3*k+0] = base.x + Particle::randFloat(-0.1f, 0.1f);
+				exPos[3*k+1] = base.y + Particle::randFloat(-0.1f, 0.1f);
+				exPos[3*k+2] = base.z + Particle::randFloat(-0.1f, 0.1f);
+				exDir[3*k+0] = dir.x;
+				exDir[3*k+1] = dir.y;
+				exDir[3*k+2] = dir.z;
+				exSpeed[k] = Particle::randFloat(speedMin, speedMax);
+				exLifespan[k] = Particle::randFloat(minls, maxls);
+				exEnd[k] = tf + exLifespan[k];
+				exAlpha[k] = 1.0f;
+			}
+		}
+	}
+}
@@ -0,0 +1,76 @@
+#pragma once
+#ifndef SHIP_FLEET_H
+#define SHIP_FLEET_H
+
+#include <vector>
+
+#define GLM_FORCE_RADIANS
+#include <glm/glm.hpp>
+
+// Exhaust particles kept for each of a fleet ship's two nozzles
+#define FLEET_EXHAUST_PARTICLES 32
+
+/**
+ * Many ships flying the same maneuvers as Ship, kept as one array per field. A tick moves every
+ * ship, evaluates all of the running maneuvers in one batch and steps every exhaust particle in
+ * one pass, instead of walking N Ship objects. Fleet ships are steered directly, not by keys,
+ * and fly level outside of maneuvers.
+ */
+class ShipFleet
+{
+public:
+	ShipFleet() {}
+
+	void reserve(int n);
+	// Adds a ship at rest and returns its index
+	int add(const glm::vec3 &pos, float yaw);
+	int size() const { return (int)x.size(); }
+
+	void setSpeed(int i, float s) { speed[i] = s; }
+	void setYaw(int i, float angle) { yaw[i] = angle; }
+	void setThrust(int i, bool on) { thrust[i] = on; }
+	// Starts SOMERSAULT, LEFT_ROLL or RIGHT_ROLL at time t, unless the ship is already in a maneuver
+	void startManeuver(int i, int animType, double t);
+	int getCurrAnim(int i) const { return anim[i]; }
+
+	// Advances every ship and exhaust particle by one tick at time t
+	void step(double t);
+
+	// The same matrices a Ship puts in its ShipSnapshot (M, E and drawM)
+	const glm::mat4 &getModelMatrix(int i) const { return M[i]; }
+	const glm::mat4 &getEMatrix(int i) const { return E[i]; }
+	const glm::mat4 &getDrawMatrix(int i) const { return drawM[i]; }
+
+	// World-space exhaust particles for every ship, laid out to upload as single buffers
+	const std::vector<float> &getExhaustPositions() const { return exPos; }
+	const std::vector<float> &getExhaustAlphas() const { return exAlpha; }
+
+private:
+	void move();
+	void updateAnimations(double t);
+	void evaluateManeuvers(double t);
+	void buildMatrices();
+	void stepExhaust(double t);
+
+	// Per ship
+	std::vector<float> x, y, z;
+	std::vector<float> xPrev, yPrev, zPrev;
+	std::vector<float> yaw;
+	std::vector<float> speed;
+	std::vector<float> unit;
+	std::vector<double> tStart;
+	std::vector<int> anim;
+	std::vector<char> thrust;
+	std::vector<glm::mat4> M, E, drawM;
+
+	// Scratch for the maneuvering ships, reused every tick
+	std::vector<int> active, activeAnim, activeIndex;
+	std::vector<float> activeProgress, activeUnit, activeWeight;
+	std::vector<glm::mat4> activeE;
+
+	// Per exhaust particle, FLEET_EXHAUST_PARTICLES for each nozzle in ship order
+	std::vector<float> exPos, exDir;
+	std::vector<float> exSpeed, exAlpha, exEnd, exLifespan;
+};
+
+#endif
@@ -0,0 +1,111 @@
+#include "Benchmark.h"
+#include "Maneuver.h"
+#include "Ship.h"
+#include "ShipFleet.h"
+
+#include <algorithm>
+#include <bitset>
+#include <cmath>
+#include <iostream>
+#include <memory>
+#include <vector>
+
+#define FLEET_BENCH_SHIPS 1000
+#define FLEET_BENCH_TICKS 200
+#define FLEET_BENCH_DT (1.0 / 60.0)
+
+static float maxDifference(const glm::mat4 &a, const glm::mat4 &b)
+{
+	float d = 0.0f;
+	for (int c = 0; c < 4; c++){
+		for (int r = 0; r < 4; r++){
+			d = std::max(d, std::abs(a[c][r] - b[c][r]));
+		}
+	}
+	return d;
+}
+
+// The key each ship holds down to keep flying maneuvers back to back
+static int maneuverKey(int i)
+{
+	const int keys[3] = { 32, 'q', 'e' };
+	return keys[i % 3];
+}
+
+BENCHMARK_SUITE(fleet)
+{
+	Maneuvers::bake();
+
+	// A fleet ship must fly a roll exactly like a Ship does
+	{
+		tGlobal = 0.0;
+		Ship ship;
+		ShipFleet fleet;
+		fleet.add(glm::vec3(0.0f), 0.0f);
+
+		std::bitset<INPUT_NUM_KEYS> roll;
+		roll[(int)'q'] = true;
+		std::bitset<INPUT_NUM_KEYS> none;
+
+		float maxErr = 0.0f;
+		for (int tick = 0; tick < 150; tick++){
+			tGlobal += FLEET_BENCH_DT;
+			ship.moveShip(tick == 0 ? roll : none);
+			ship.updateAnimation();
+			ShipSnapshot s;
+			ship.getSnapshot(s);
+			ship.updatePrevPos();
+
+			if (tick == 0){
+				fleet.startManeuver(0, LEFT_ROLL, tGlobal);
+			}
+			fleet.step(tGlobal);
+
+			maxErr = std::max(maxErr, maxDifference(s.M, fleet.getModelMatrix(0)));
+			maxErr = std::max(maxErr, maxDifference(s.E, fleet.getEMatrix(0)));
+		}
+		std::cout << "  max difference from Ship: " << maxErr << std::endl;
+	}
+
+	// FLEET_BENCH_SHIPS ships, all of them always in a maneuver
+	tGlobal = 0.0;
+	std::vector<std::shared_ptr<Ship> > ships;
+	std::vector<std::bitset<INPUT_NUM_KEYS> > keys(FLEET_BENCH_SHIPS);
+	ShipFleet fleet;
+	fleet.reserve(FLEET_BENCH_SHIPS);
+	for (int i = 0; i < FLEET_BENCH_SHIPS; i++){
+		ships.push_back(std::make_shared<Ship>());
+		keys[i][maneuverKey(i)] = true;
+		keys[i][(int)'w'] = true;
+
+		fleet.add(glm::vec3(0.0f), 0.01f * i);
+		fleet.setSpeed(i, 0.4f);
+		fleet.setThrust(i, true);
+	}
+	const int fleetAnims[3] = { SOMERSAULT, LEFT_ROLL, RIGHT_ROLL };
+
+	ShipSnapshot s;
+	double perTick = Benchmark::time("Ship objects: one tick", FLEET_BENCH_TICKS, [&](){
+		tGlobal += FLEET_BENCH_DT;
+		for (int i = 0; i < FLEET_BENCH_SHIPS; i++){
+			Ship &ship = *ships[i];
+			ship.moveShip(keys[i]);
+			ship.boundShip();
+			ship.updateAnimation();
+			ship.getSnapshot(s);
+			ship.updatePrevPos();
+			Benchmark::keep(s);
+		}
+	});
+	Benchmark::report("  per ship", perTick / FLEET_BENCH_SHIPS);
+
+	perTick = Benchmark::time("ShipFleet (with exhaust): one tick", FLEET_BENCH_TICKS, [&](){
+		tGlobal += FLEET_BENCH_DT;
+		for (int i = 0; i < FLEET_BENCH_SHIPS; i++){
+			fleet.startManeuver(i, fleetAnims[i % 3], tGlobal);
+		}
+		fleet.step(tGlobal);
+		Benchmark::keep(fleet.getEMatrix(0));
+	});
+	Benchmark::report("  per ship", perTick / FLEET_BENCH_SHIPS);
+}
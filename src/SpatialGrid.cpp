@@ -0,0 +1,57 @@
+#include "SpatialGrid.h"
+
+#include <algorithm>
+
+SpatialGrid::SpatialGrid(float cellSize) :
+	invCellSize(1.0f / cellSize),
+	maxRadius(0.0f),
+	numBuckets(0)
+{
+	resizeTable(GRID_TABLE_BITS);
+}
+
+void SpatialGrid::resizeTable(uint32_t bits)
+{
+	xBits = (bits + 1) / 2;
+	xMask = (1u << xBits) - 1;
+	zMask = (1u << (bits - xBits)) - 1;
+	numBuckets = 1u << bits;
+	bucketStart.resize(numBuckets + 1);
+}
+
+void SpatialGrid::build(const std::vector<BoundingSphere> &s)
+{
+	spheres.assign(s.begin(), s.end());
+	entries.resize(spheres.size());
+	keys.resize(spheres.size());
+	// Grow the table so buckets stay short. It never shrinks, so rebuilding doesn't reallocate.
+	uint32_t bits = GRID_TABLE_BITS;
+	while((1u << bits) < spheres.size()) {
+		bits++;
+	}
+	if((1u << bits) > numBuckets) {
+		resizeTable(bits);
+	}
+	std::fill(bucketStart.begin(), bucketStart.end(), 0);
+	maxRadius = 0.0f;
+
+	// Count the spheres in each bucket, then turn the counts into where each bucket ends
+	for(size_t i = 0; i < spheres.size(); i++) {
+		keys[i] = bucketOf(cellOf(spheres[i].center.x), cellOf(spheres[i].center.z));
+		bucketStart[keys[i]]++;
+		maxRadius = std::max(maxRadius, spheres[i].radius);
+	}
+	for(size_t b = 1; b < numBuckets; b++) {
+		bucketStart[b] += bucketStart[b - 1];
+	}
+	bucketStart[numBuckets] = (uint32_t)spheres.size();
+
+	// Fill each bucket from its end, which leaves bucketStart[b] at its start
+	for(size_t i = spheres.size(); i-- > 0;) {
+		Entry &e = entries[--bucketStart[keys[i]]];
+		e.cx = cellOf(spheres[i].center.x);
+		e.cz = cellOf(spheres[i].center.z);
+		e.index = (int32_t)i;
+		e.sphere = spheres[i];
+	}
+}
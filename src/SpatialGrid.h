@@ -0,0 +1,108 @@
+#pragma once
+#ifndef SPATIAL_GRID_H
+#define SPATIAL_GRID_H
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <vector>
+
+#define GLM_FORCE_RADIANS
+#include <glm/glm.hpp>
+
+#include "BoundingSphere.h"
+
+#define GRID_CELL_SIZE 16.0f    // About an asteroid across. Queries widen by the largest radius, so any size is correct.
+#define GRID_TABLE_BITS 12      // At least a 64 x 64 table of buckets, more for more spheres
+
+/**
+ * A broadphase over spheres: a uniform grid on the x-z plane, folded onto a fixed table of
+ * buckets by taking cell coordinates modulo its size, so it needs no bounds (the open world goes
+ * on forever) and a row of neighbouring cells is contiguous in memory. Rebuilt from scratch every
+ * tick with a counting sort, so after the first few ticks a build doesn't allocate. The table has
+ * a bucket or two per sphere.
+ * Each sphere is filed under the one cell that holds its center, and queries widen their box by
+ * the largest radius instead, so a query sees every sphere at most once and needs no scratch
+ * state. Any number of threads may query a built grid at once.
+ */
+class SpatialGrid
+{
+public:
+	SpatialGrid(float cellSize = GRID_CELL_SIZE);
+
+	void build(const std::vector<BoundingSphere> &spheres);
+
+	// Calls f(i, sphere) for every sphere i whose cell is near enough that it could reach into the
+	// box lo-hi. Callers still have to do their own exact test.
+	template <typename F>
+	void forEachNear(const glm::vec3 &lo, const glm::vec3 &hi, F f) const
+	{
+		forEachInCells(lo - glm::vec3(maxRadius), hi + glm::vec3(maxRadius), f);
+	}
+
+	// Calls f(i, sphere) for every sphere i whose center is in a cell that the box lo-hi overlaps
+	template <typename F>
+	void forEachInCells(const glm::vec3 &lo, const glm::vec3 &hi, F f) const
+	{
+		if(entries.empty()) {
+			return;
+		}
+		int x0 = cellOf(lo.x), x1 = cellOf(hi.x);
+		int z0 = cellOf(lo.z), z1 = cellOf(hi.z);
+		// A box over more cells than there are buckets is cheaper to do as one pass over everything
+		if((int64_t)(x1 - x0 + 1) * (z1 - z0 + 1) > (int64_t)numBuckets) {
+			for(size_t e = 0; e < entries.size(); e++) {
+				if(entries[e].cx >= x0 && entries[e].cx <= x1 && entries[e].cz >= z0 && entries[e].cz <= z1) {
+					f(entries[e].index, entries[e].sphere);
+				}
+			}
+			return;
+		}
+		for(int cz = z0; cz <= z1; cz++) {
+			// A row's buckets are consecutive unless it wraps around the table
+			for(int cx = x0; cx <= x1;) {
+				int run = std::min(x1 - cx, (int)(xMask - ((uint32_t)cx & xMask)));
+				uint32_t b = bucketOf(cx, cz);
+				for(uint32_t e = bucketStart[b]; e < bucketStart[b + run + 1]; e++) {
+					// Other cells can share the buckets
+					if(entries[e].cz == cz && entries[e].cx >= cx && entries[e].cx <= cx + run) {
+						f(entries[e].index, entries[e].sphere);
+					}
+				}
+				cx += run + 1;
+			}
+		}
+	}
+
+	const BoundingSphere &getSphere(int i) const { return spheres[i]; }
+	int size() const { return (int)spheres.size(); }
+	float getMaxRadius() const { return maxRadius; }
+
+private:
+	void resizeTable(uint32_t bits);
+
+	// Keeps a copy of the sphere so a query reads the bucket and nothing else
+	struct Entry {
+		BoundingSphere sphere;
+		int32_t cx;
+		int32_t cz;
+		int32_t index;
+	};
+
+	int cellOf(float v) const { return (int)std::floor(v * invCellSize); }
+	uint32_t bucketOf(int cx, int cz) const
+	{
+		return (((uint32_t)cz & zMask) << xBits) | ((uint32_t)cx & xMask);
+	}
+
+	float invCellSize;
+	float maxRadius;
+	uint32_t numBuckets;
+	uint32_t xBits, xMask, zMask;
+	std::vector<BoundingSphere> spheres;
+	std::vector<uint32_t> bucketStart; // Entries of bucket b are [bucketStart[b], bucketStart[b + 1])
+	std::vector<Entry> entries;
+	std::vector<uint32_t> keys;        // Bucket of each sphere, kept between the two passes of build()
+};
+
+#endif
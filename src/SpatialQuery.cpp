@@ -0,0 +1,284 @@
+#include "SpatialQuery.h"
+
+#include <algorithm>
+#include <atomic>
+#include <thread>
+
+#define QUERY_BATCH_CHUNK 256 // Queries a thread takes at a time
+
+namespace {
+
+	// Nearer first, then by layer and index so equal distances always come out the same way
+	bool closer(const QueryHit &a, const QueryHit &b)
+	{
+		if(a.dist != b.dist) {
+			return a.dist < b.dist;
+		}
+		return a.layer != b.layer ? a.layer < b.layer : a.index < b.index;
+	}
+
+	// Calls f(i) for i in [0, n) on up to numThreads threads, this one included
+	template <typename F>
+	void parallelFor(int n, int numThreads, F f)
+	{
+		if(numThreads <= 0) {
+			numThreads = std::max(1, (int)std::thread::hardware_concurrency());
+		}
+		numThreads = std::min(numThreads, (n + QUERY_BATCH_CHUNK - 1) / QUERY_BATCH_CHUNK);
+
+		std::atomic<int> next(0);
+		auto work = [&](){
+			for(;;) {
+				int begin = next.fetch_add(QUERY_BATCH_CHUNK);
+				if(begin >= n) {
+					return;
+				}
+				int end = std::min(n, begin + QUERY_BATCH_CHUNK);
+				for(int i = begin; i < end; i++) {
+					f(i);
+				}
+			}
+		};
+
+		std::vector<std::thread> threads;
+		for(int i = 1; i < numThreads; i++) {
+			threads.push_back(std::thread(work));
+		}
+		work();
+		for(auto t = threads.begin(); t != threads.end(); ++t) {
+			t->join();
+		}
+	}
+
+}
+
+SpatialQuery::SpatialQuery() :
+	halfX(0.0f),
+	halfZ(0.0f)
+{
+}
+
+void SpatialQuery::setWrap(float halfX, float halfZ)
+{
+	this->halfX = halfX;
+	this->halfZ = halfZ;
+}
+
+void SpatialQuery::build(int layer, const std::vector<BoundingSphere> &spheres)
+{
+	if(halfX <= 0.0f) {
+		grids[layer].build(spheres);
+		return;
+	}
+
+	// Anything off the playfield is moved onto it by whole playfields
+	wrapped.assign(spheres.begin(), spheres.end());
+	for(auto s = wrapped.begin(); s != wrapped.end(); ++s) {
+		if(std::abs(s->center.x) > halfX) {
+			s->center.x -= 2.0f * halfX * std::floor((s->center.x + halfX) / (2.0f * halfX));
+		}
+		if(std::abs(s->center.z) > halfZ) {
+			s->center.z -= 2.0f * halfZ * std::floor((s->center.z + halfZ) / (2.0f * halfZ));
+		}
+	}
+	grids[layer].build(wrapped);
+}
+
+template <typename F>
+void SpatialQuery::forEachCopy(int layer, const glm::vec3 &lo, const glm::vec3 &hi, F f) const
+{
+	const SpatialGrid &grid = grids[layer];
+	if(halfX <= 0.0f) {
+		grid.forEachInCells(lo, hi, [&](int i, const BoundingSphere &s){
+			if(s.center.x >= lo.x && s.center.x <= hi.x && s.center.z >= lo.z && s.center.z <= hi.z) {
+				f(i, s.radius, s.center);
+			}
+		});
+		return;
+	}
+
+	// Cut the box where it crosses the edges of the playfield, and look each piece up where it
+	// wraps around to. The pieces don't overlap, so each copy is found once.
+	float px = 2.0f * halfX, pz = 2.0f * halfZ;
+	int kx0 = (int)std::floor((lo.x + halfX) / px), kx1 = (int)std::floor((hi.x + halfX) / px);
+	int kz0 = (int)std::floor((lo.z + halfZ) / pz), kz1 = (int)std::floor((hi.z + halfZ) / pz);
+	for(int kz = kz0; kz <= kz1; kz++) {
+		for(int kx = kx0; kx <= kx1; kx++) {
+			glm::vec3 offset(kx * px, 0.0f, kz * pz);
+			glm::vec3 pieceLo = glm::max(lo - offset, glm::vec3(-halfX, lo.y, -halfZ));
+			glm::vec3 pieceHi = glm::min(hi - offset, glm::vec3(halfX, hi.y, halfZ));
+			if(pieceLo.x > pieceHi.x || pieceLo.z > pieceHi.z) {
+				continue;
+			}
+			grid.forEachInCells(pieceLo, pieceHi, [&](int i, const BoundingSphere &s){
+				const glm::vec3 &c = s.center;
+				if(c.x >= pieceLo.x && c.x <= pieceHi.x && c.z >= pieceLo.z && c.z <= pieceHi.z) {
+					f(i, s.radius, c + offset);
+				}
+			});
+		}
+	}
+}
+
+bool SpatialQuery::isNearestCopy(const glm::vec3 &center, const glm::vec3 &p) const
+{
+	if(halfX <= 0.0f) {
+		return true;
+	}
+	// Half-open, so when two copies are equally far only one of them counts
+	float dx = center.x - p.x, dz = center.z - p.z;
+	return dx >= -halfX && dx < halfX && dz >= -halfZ && dz < halfZ;
+}
+
+int SpatialQuery::overlap(const BoundingSphere &s, unsigned layers, QueryHit *out, int maxHits) const
+{
+	int n = 0;
+	for(int layer = 0; layer < QUERY_NUM_LAYERS; layer++) {
+		if(!(layers & QUERY_MASK(layer))) {
+			continue;
+		}
+		const SpatialGrid &grid = grids[layer];
+		glm::vec3 reach(s.radius + grid.getMaxRadius());
+		if(halfX > 0.0f) {
+			// Only the nearest copy of anything counts, and that is never more than half a playfield away
+			reach = glm::min(reach, glm::vec3(halfX, reach.y, halfZ));
+		}
+		forEachCopy(layer, s.center - reach, s.center + reach, [&](int i, float radius, const glm::vec3 &c){
+			if(!isNearestCopy(c, s.center)) {
+				return;
+			}
+			float dist = glm::length(c - s.center) - radius;
+			if(dist <= s.radius) {
+				if(n < maxHits) {
+					QueryHit &h = out[n];
+					h.layer = layer;
+					h.index = i;
+					h.dist = dist;
+					h.center = c;
+				}
+				n++;
+			}
+		});
+	}
+	return n;
+}
+
+bool SpatialQuery::raycast(const glm::vec3 &origin, const glm::vec3 &dir, float length, unsigned layers, QueryHit &hit) const
+{
+	hit.layer = 0;
+	hit.index = -1;
+	hit.dist = INFINITY;
+
+	// A piece of the ray at a time, so a long ray that hits something early stops early
+	int numSteps = std::max(1, (int)std::ceil(length / QUERY_RAY_STEP));
+	for(int step = 0; step < numSteps; step++) {
+		float s0 = step * QUERY_RAY_STEP;
+		float s1 = std::min(length, s0 + QUERY_RAY_STEP);
+		glm::vec3 a = origin + s0 * dir, b = origin + s1 * dir;
+		for(int layer = 0; layer < QUERY_NUM_LAYERS; layer++) {
+			if(!(layers & QUERY_MASK(layer))) {
+				continue;
+			}
+			const SpatialGrid &grid = grids[layer];
+			glm::vec3 reach(grid.getMaxRadius());
+			forEachCopy(layer, glm::min(a, b) - reach, glm::max(a, b) + reach, [&](int i, float radius, const glm::vec3 &c){
+				QueryHit h;
+				h.layer = layer;
+				h.index = i;
+				h.center = c;
+				if(BoundingSphere(radius, c).intersect(origin, dir, length, h.dist) && closer(h, hit)) {
+					hit = h;
+				}
+			});
+		}
+		// Anything not seen yet is entered past s1
+		if(hit.index != -1 && hit.dist <= s1) {
+			return true;
+		}
+	}
+	return hit.index != -1;
+}
+
+int SpatialQuery::nearest(const glm::vec3 &p, int k, unsigned layers, QueryHit *out, float maxDist) const
+{
+	int total = 0;
+	float maxRadius = 0.0f;
+	for(int layer = 0; layer < QUERY_NUM_LAYERS; layer++) {
+		if(layers & QUERY_MASK(layer)) {
+			total += grids[layer].size();
+			maxRadius = std::max(maxRadius, grids[layer].getMaxRadius());
+		}
+	}
+	if(k <= 0 || total == 0) {
+		return 0;
+	}
+
+	// Search a box around p, twice as wide each time, until nothing outside it could be nearer
+	// than the k found. out holds a max-heap of the nearest so far.
+	float w = GRID_CELL_SIZE + maxRadius;
+	for(;;) {
+		glm::vec3 reach(w);
+		if(halfX > 0.0f) {
+			reach = glm::min(reach, glm::vec3(halfX, w, halfZ));
+		}
+
+		int n = 0, seen = 0;
+		for(int layer = 0; layer < QUERY_NUM_LAYERS; layer++) {
+			if(!(layers & QUERY_MASK(layer))) {
+				continue;
+			}
+			forEachCopy(layer, p - reach, p + reach, [&](int i, float radius, const glm::vec3 &c){
+				if(!isNearestCopy(c, p)) {
+					return;
+				}
+				seen++;
+				QueryHit h;
+				h.layer = layer;
+				h.index = i;
+				h.dist = glm::length(c - p) - radius;
+				h.center = c;
+				if(h.dist > maxDist) {
+					return;
+				}
+				if(n < k) {
+					out[n++] = h;
+					std::push_heap(out, out + n, closer);
+				}
+				else if(closer(h, out[0])) {
+					std::pop_heap(out, out + k, closer);
+					out[k - 1] = h;
+					std::push_heap(out, out + k, closer);
+				}
+			});
+		}
+
+		// Every center not seen is more than w from p
+		float unseen = w - maxRadius;
+		if(seen == total || unseen >= maxDist || (n == k && out[0].dist <= unseen)) {
+			std::sort_heap(out, out + n, closer);
+			return n;
+		}
+		w *= 2.0f;
+	}
+}
+
+void SpatialQuery::overlapBatch(const BoundingSphere *queries, int n, unsigned layers, QueryHit *out, int maxHits, int *counts, int numThreads) const
+{
+	parallelFor(n, numThreads, [&](int i){
+		counts[i] = overlap(queries[i], layers, out + (size_t)i * maxHits, maxHits);
+	});
+}
+
+void SpatialQuery::raycastBatch(const RayQuery *queries, int n, unsigned layers, QueryHit *out, int numThreads) const
+{
+	parallelFor(n, numThreads, [&](int i){
+		raycast(queries[i].origin, queries[i].dir, queries[i].length, layers, out[i]);
+	});
+}
+
+void SpatialQuery::nearestBatch(const glm::vec3 *points, int n, int k, unsigned layers, QueryHit *out, int *counts, int numThreads) const
+{
+	parallelFor(n, numThreads, [&](int i){
+		counts[i] = nearest(points[i], k, layers, out + (size_t)i * k);
+	});
+}
@@ -0,0 +1,92 @@
+#pragma once
+#ifndef SPATIAL_QUERY_H
+#define SPATIAL_QUERY_H
+
+#include <cmath>
+#include <vector>
+
+#define GLM_FORCE_RADIANS
+#include <glm/glm.hpp>
+
+#include "BoundingSphere.h"
+#include "SpatialGrid.h"
+
+#define QUERY_RAY_STEP (2.0f * GRID_CELL_SIZE) // How much of a ray is searched before checking for an early out
+#define QUERY_ALL ((1u << QUERY_NUM_LAYERS) - 1)
+#define QUERY_MASK(layer) (1u << (layer))
+
+enum QUERY_LAYERS {
+	QUERY_ASTEROIDS,
+	QUERY_SHIPS,
+	QUERY_PROJECTILES,
+	QUERY_NUM_LAYERS
+};
+
+// One thing a query found
+struct QueryHit {
+	int layer;
+	int index;        // Into the spheres the layer was built from, -1 if a ray hit nothing
+	float dist;       // From the query's center to the surface (negative inside), or along a ray
+	glm::vec3 center; // Of the copy of the sphere that was found, which differs from the sphere's
+	                  // own by whole playfields when the query reached across the wraparound edge
+};
+
+struct RayQuery {
+	glm::vec3 origin;
+	glm::vec3 dir; // Unit length
+	float length;
+};
+
+/**
+ * Answers "what is near here" for the world's asteroids, ships and projectiles without scanning
+ * them: sphere overlap, the earliest hit along a ray or segment, and the k nearest. Each layer is a
+ * SpatialGrid rebuilt from its bounding spheres once per tick.
+ * With setWrap(), the playfield is treated as wrapping around the way asteroids do: queries near
+ * an edge also see what is just over the other side, and spheres built outside it are taken
+ * modulo its size. Every overlap and nearest query reports each sphere once, at its copy nearest
+ * the query's center.
+ * Results go into buffers the caller provides, so queries never allocate, and a built query
+ * service is read-only: any number of threads may query it at once, and the *Batch functions
+ * spread a batch of queries over several threads.
+ */
+class SpatialQuery
+{
+public:
+	SpatialQuery();
+
+	// Half the width and depth of the wrapping playfield, or 0 for an unbounded one
+	void setWrap(float halfX, float halfZ);
+	void build(int layer, const std::vector<BoundingSphere> &spheres);
+	const SpatialGrid &getGrid(int layer) const { return grids[layer]; }
+
+	// Fills out with up to maxHits of the spheres that touch s, in no particular order, and
+	// returns how many there were in all
+	int overlap(const BoundingSphere &s, unsigned layers, QueryHit *out, int maxHits) const;
+	// The first sphere the segment from origin along the unit direction dir for length units
+	// touches. Returns false if there is none.
+	bool raycast(const glm::vec3 &origin, const glm::vec3 &dir, float length, unsigned layers, QueryHit &hit) const;
+	// Fills out with the (up to) k spheres whose surfaces are nearest p and no further than
+	// maxDist, nearest first. Returns how many there were.
+	int nearest(const glm::vec3 &p, int k, unsigned layers, QueryHit *out, float maxDist = INFINITY) const;
+
+	// The same for n queries at once on up to numThreads threads (0 for one per core). Query i
+	// writes its hits from out[i * maxHits] (or out[i * k]) and its count to counts[i]; a ray that
+	// misses gets an index of -1.
+	void overlapBatch(const BoundingSphere *queries, int n, unsigned layers, QueryHit *out, int maxHits, int *counts, int numThreads = 0) const;
+	void raycastBatch(const RayQuery *queries, int n, unsigned layers, QueryHit *out, int numThreads = 0) const;
+	void nearestBatch(const glm::vec3 *points, int n, int k, unsigned layers, QueryHit *out, int *counts, int numThreads = 0) const;
+
+private:
+	// Calls f(i, radius, center) for every copy of every sphere in the layer whose center is in
+	// the box lo-hi, which may reach past the edges of a wrapping playfield
+	template <typename F>
+	void forEachCopy(int layer, const glm::vec3 &lo, const glm::vec3 &hi, F f) const;
+	// Whether center is the copy of its sphere nearest p
+	bool isNearestCopy(const glm::vec3 &center, const glm::vec3 &p) const;
+
+	SpatialGrid grids[QUERY_NUM_LAYERS];
+	float halfX, halfZ;
+	std::vector<BoundingSphere> wrapped; // Scratch for build()
+};
+
+#endif
@@ -1,6 +1,8 @@
 #include "SplineMatrix.h"
 
-glm::mat4 createBezier(){
+// The basis matrices never change, so each is built on first use and reused after that
+
+static glm::mat4 buildBezier(){
 	glm::mat4 matBezier;
 	// note: mat[col][row]
 	// bezier curve matrix
@@ -17,7 +19,7 @@ glm::mat4 createBezier(){
 	return matBezier;
 }
 
-glm::mat4 createCatmull(){
+static glm::mat4 buildCatmull(){
 	glm::mat4 matCatmull;
 	// note: mat[col][row]
 	// bezier curve matrix
@@ -36,7 +38,7 @@ glm::mat4 createCatmull(){
 	return matCatmull;
 }
 
-glm::mat4 createBspline(){
+static glm::mat4 buildBspline(){
 	glm::mat4 matBspline;
 
 	// note: mat[col][row]
@@ -54,4 +56,19 @@ glm::mat4 createBspline(){
 	matBspline = 1.0f/6.0f * matBspline;
 
 	return matBspline;
-}
\ No newline at end of file
+}
+
+const glm::mat4 &createBezier(){
+	static const glm::mat4 B = buildBezier();
+	return B;
+}
+
+const glm::mat4 &createCatmull(){
+	static const glm::mat4 B = buildCatmull();
+	return B;
+}
+
+const glm::mat4 &createBspline(){
+	static const glm::mat4 B = buildBspline();
+	return B;
+}
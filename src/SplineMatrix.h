@@ -13,8 +13,9 @@
 #include <glm/gtc/type_ptr.hpp>
 #include <glm/gtc/quaternion.hpp>
 
-glm::mat4 createBezier();
-glm::mat4 createCatmull();
-glm::mat4 createBspline();
+// Each returns a reference to a basis matrix that is built once
+const glm::mat4 &createBezier();
+const glm::mat4 &createCatmull();
+const glm::mat4 &createBspline();
 
 #endif
\ No newline at end of file
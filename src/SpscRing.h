@@ -0,0 +1,53 @@
+#pragma once
+#ifndef SPSC_RING_H
+#define SPSC_RING_H
+
+#include <atomic>
+#include <cstddef>
+
+/**
+ * A fixed-size lock-free queue for exactly one producer thread and one consumer thread.
+ * N must be a power of two. push() fails instead of blocking when the ring is full.
+ */
+template <typename T, size_t N>
+class SpscRing
+{
+	static_assert((N & (N - 1)) == 0, "SpscRing size must be a power of two");
+
+public:
+	SpscRing() : head(0), tail(0) {}
+
+	// Producer side
+	bool push(const T &v)
+	{
+		size_t t = tail.load(std::memory_order_relaxed);
+		if(t - head.load(std::memory_order_acquire) == N) {
+			return false;
+		}
+		slots[t & (N - 1)] = v;
+		tail.store(t + 1, std::memory_order_release);
+		return true;
+	}
+
+	// Consumer side
+	bool pop(T &v)
+	{
+		size_t h = head.load(std::memory_order_relaxed);
+		if(h == tail.load(std::memory_order_acquire)) {
+			return false;
+		}
+		v = slots[h & (N - 1)];
+		head.store(h + 1, std::memory_order_release);
+		return true;
+	}
+
+	bool empty() const { return head.load(std::memory_order_acquire) == tail.load(std::memory_order_acquire); }
+
+private:
+	T slots[N];
+	// On separate cache lines so the two threads don't false-share
+	alignas(64) std::atomic<size_t> head; // Next slot to read, only written by the consumer
+	alignas(64) std::atomic<size_t> tail; // Next slot to write, only written by the producer
+};
+
+#endif
@@ -1,9 +1,7 @@
 #include "Star.h"
 #include "randomFunctions.h"
 
-#define GLEW_STATIC
-#include <GL/glew.h>
-#include <GLFW/glfw3.h>
+#include <cstdlib>
 
 Star::Star(){
     this->pos = glm::vec3(rand(), rand(), rand());
@@ -20,12 +18,3 @@ Star::Star(){
 
     this->size = randomFloat(MIN_STAR_SIZE, MAX_STAR_SIZE);
 }
-
-void Star::draw(){
-    glPointSize(size);
-    glColor3f(1, 1, 1);
-    
-    glBegin(GL_POINTS);
-    glVertex3f(pos.x, pos.y, pos.z);
-    glEnd();
-}
\ No newline at end of file
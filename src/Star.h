@@ -17,7 +17,6 @@ struct Star{
 
     Star();
     ~Star(){}
-    void draw();
 };
 
 #endif
\ No newline at end of file
@@ -0,0 +1,143 @@
+#include "Stats.h"
+
+#include <atomic>
+#include <chrono>
+#include <fstream>
+#include <iomanip>
+
+#include "AllocStats.h"
+
+namespace Stats {
+
+	static Histogram histograms[STAT_NUM_PHASES];
+	// Like the histograms, each is only written by the thread that owns the phase
+	static std::atomic<uint64_t> allocs[STAT_NUM_PHASES];
+	static std::atomic<uint64_t> maxAllocs[STAT_NUM_PHASES];
+
+	static const char *names[STAT_NUM_PHASES] = {
+		"frame",
+		"snapshot",
+		"submit",
+		"particles",
+		"execute",
+		"swap",
+		"poll",
+		"input_latency",
+		"sim_tick",
+		"sim_collisions",
+		"sim_move",
+		"sim_publish"
+	};
+
+	static const double percentiles[] = { 0.5, 0.9, 0.99, 0.999 };
+	static const char *percentileNames[] = { "p50", "p90", "p99", "p99.9" };
+	static const int numPercentiles = 4;
+
+	double now()
+	{
+		return std::chrono::duration<double>(std::chrono::steady_clock::now().time_since_epoch()).count();
+	}
+
+	Mark mark()
+	{
+		Mark m;
+		m.t = now();
+		m.allocs = AllocStats::getThreadCount();
+		return m;
+	}
+
+	void record(int phase, double seconds)
+	{
+		histograms[phase].record(seconds);
+	}
+
+	void record(int phase, const Mark &from, const Mark &to)
+	{
+		histograms[phase].record(to.t - from.t);
+		uint64_t n = to.allocs - from.allocs;
+		allocs[phase].store(allocs[phase].load(std::memory_order_relaxed) + n, std::memory_order_relaxed);
+		if(n > maxAllocs[phase].load(std::memory_order_relaxed)) {
+			maxAllocs[phase].store(n, std::memory_order_relaxed);
+		}
+	}
+
+	const Histogram &get(int phase)
+	{
+		return histograms[phase];
+	}
+
+	const char *getName(int phase)
+	{
+		return names[phase];
+	}
+
+	double getAllocsPerCall(int phase)
+	{
+		uint64_t n = histograms[phase].getCount();
+		return n ? (double)allocs[phase].load(std::memory_order_relaxed) / n : 0.0;
+	}
+
+	uint64_t getMaxAllocs(int phase)
+	{
+		return maxAllocs[phase].load(std::memory_order_relaxed);
+	}
+
+	void reset()
+	{
+		for(int i = 0; i < STAT_NUM_PHASES; i++) {
+			histograms[i].reset();
+			allocs[i].store(0, std::memory_order_relaxed);
+			maxAllocs[i].store(0, std::memory_order_relaxed);
+		}
+	}
+
+	void print(std::ostream &out)
+	{
+		out << std::fixed << std::setprecision(2);
+		out << "  - TIMINGS (ms):" << std::endl;
+		for(int i = 0; i < STAT_NUM_PHASES; i++) {
+			const Histogram &h = histograms[i];
+			if(h.getCount() == 0) {
+				continue;
+			}
+			out << "    " << std::left << std::setw(16) << names[i] << std::right;
+			for(int j = 0; j < numPercentiles; j++) {
+				out << " " << percentileNames[j] << " " << std::setw(7) << 1000.0 * h.getPercentile(percentiles[j]);
+			}
+			out << " max " << std::setw(7) << 1000.0 * h.getMax();
+			out << "  allocs/call " << std::setw(7) << getAllocsPerCall(i) << " max " << std::setw(5) << getMaxAllocs(i);
+			out << "  (" << h.getCount() << ")" << std::endl;
+		}
+		out << std::defaultfloat;
+	}
+
+	bool writeJSON(const std::string &path)
+	{
+		std::ofstream out(path);
+		if(!out) {
+			return false;
+		}
+		out << "{" << std::endl;
+		bool first = true;
+		for(int i = 0; i < STAT_NUM_PHASES; i++) {
+			const Histogram &h = histograms[i];
+			if(h.getCount() == 0) {
+				continue;
+			}
+			if(!first) {
+				out << "," << std::endl;
+			}
+			first = false;
+			out << "  \"" << names[i] << "\": { \"count\": " << h.getCount();
+			out << ", \"mean_ms\": " << 1000.0 * h.getMean();
+			for(int j = 0; j < numPercentiles; j++) {
+				out << ", \"" << percentileNames[j] << "_ms\": " << 1000.0 * h.getPercentile(percentiles[j]);
+			}
+			out << ", \"max_ms\": " << 1000.0 * h.getMax();
+			out << ", \"allocs_per_call\": " << getAllocsPerCall(i) << ", \"max_allocs\": " << getMaxAllocs(i) << " }";
+		}
+		out << std::endl << "}" << std::endl;
+		return (bool)out;
+	}
+
+}
@@ -0,0 +1,73 @@
+#pragma once
+#ifndef STATS_H
+#define STATS_H
+
+#include <cstdint>
+#include <string>
+#include <ostream>
+
+#include "Histogram.h"
+
+// Each phase is only recorded by one thread
+enum STAT_PHASES {
+	// Render thread
+	STAT_FRAME,         // Start of one frame to the start of the next
+	STAT_SNAPSHOT,      // Taking and interpolating the newest snapshot
+	STAT_SUBMIT,        // Filling the render queue
+	STAT_PARTICLES,     // Stepping and submitting the explosions and flames (part of STAT_SUBMIT)
+	STAT_EXECUTE,       // Sorting and issuing the render queue
+	STAT_SWAP,
+	STAT_POLL,          // glfwPollEvents()
+	STAT_INPUT_LATENCY, // Key event to the frame that shows it (see LatencyTracker)
+	// Simulation thread
+	STAT_SIM_TICK,
+	STAT_SIM_COLLISIONS,
+	STAT_SIM_MOVE,
+	STAT_SIM_PUBLISH,
+	STAT_NUM_PHASES
+};
+
+/**
+ * Histograms of how long each phase of a frame or simulation tick takes, and how many heap
+ * allocations it makes. Cheap enough to always record, and safe to read from any thread while recording.
+ */
+namespace Stats {
+
+	// A time plus the calling thread's allocation count
+	struct Mark {
+		double t;
+		uint64_t allocs;
+	};
+
+	double now(); // Monotonic time in seconds
+	Mark mark();
+
+	void record(int phase, double seconds);
+	// Both marks must come from the thread that owns the phase
+	void record(int phase, const Mark &from, const Mark &to);
+	const Histogram &get(int phase);
+	const char *getName(int phase);
+	double getAllocsPerCall(int phase);
+	uint64_t getMaxAllocs(int phase); // Most allocations in a single call
+	// Forgets everything recorded so far. Nothing may be recording meanwhile.
+	void reset();
+
+	// p50/p90/p99/p99.9/max and allocations of every phase that recorded anything
+	void print(std::ostream &out);
+	bool writeJSON(const std::string &path);
+
+}
+
+// Records the time and allocations from construction to destruction into a phase
+class ScopedStat
+{
+public:
+	ScopedStat(int p) : phase(p), m0(Stats::mark()) {}
+	~ScopedStat() { Stats::record(phase, m0, Stats::mark()); }
+
+private:
+	int phase;
+	Stats::Mark m0;
+};
+
+#endif
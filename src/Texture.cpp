@@ -1,4 +1,5 @@
 #include "Texture.h"
+#include "GLState.h"
 #include <stdio.h>
 #include <stdlib.h>
 #include <iostream>
@@ -9,7 +10,8 @@ using namespace std;
 
 Texture::Texture() :
 	filename(""),
-	tid(0)
+	tid(0),
+	unit(0)
 {
 	
 }
@@ -40,10 +42,11 @@ void Texture::init()
 	// Generate a texture buffer object
 	glGenTextures(1, &tid);
 	// Bind the current texture to be the newly generated texture object
-	glBindTexture(GL_TEXTURE_2D, tid);
+	GLState::bindTexture(unit, tid);
 	// Load the actual texture data
-	// Base level is 0, number of channels is 3, and border is 0.
-	glTexImage2D(GL_TEXTURE_2D, 0, ncomps, width, height, 0, GL_RGB, GL_UNSIGNED_BYTE, data);
+	// Base level is 0, internal format is RGB, and border is 0.
+	// (A bare component count is not a valid internal format on a core profile.)
+	glTexImage2D(GL_TEXTURE_2D, 0, GL_RGB, width, height, 0, GL_RGB, GL_UNSIGNED_BYTE, data);
 	// Generate image pyramid
 	glGenerateMipmap(GL_TEXTURE_2D);
 	// Set texture wrap modes for the S and T directions
@@ -53,7 +56,7 @@ void Texture::init()
 	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
 	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR_MIPMAP_LINEAR);
 	// Unbind
-	glBindTexture(GL_TEXTURE_2D, 0);
+	GLState::bindTexture(unit, 0);
 	// Free image, since the data is now on the GPU
 	stbi_image_free(data);
 }
@@ -61,20 +64,23 @@ void Texture::init()
 void Texture::setWrapModes(GLint wrapS, GLint wrapT)
 {
 	// Must be called after init()
-	glBindTexture(GL_TEXTURE_2D, tid);
+	GLState::bindTexture(unit, tid);
 	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, wrapS);
 	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, wrapT);
 }
 
 void Texture::bind(GLint handle)
 {
-	glActiveTexture(GL_TEXTURE0 + unit);
-	glBindTexture(GL_TEXTURE_2D, tid);
+	GLState::bindTexture(unit, tid);
 	glUniform1i(handle, unit);
 }
 
+void Texture::bind()
+{
+	GLState::bindTexture(unit, tid);
+}
+
 void Texture::unbind()
 {
-	glActiveTexture(GL_TEXTURE0 + unit);
-	glBindTexture(GL_TEXTURE_2D, 0);
+	GLState::bindTexture(unit, 0);
 }
@@ -16,7 +16,10 @@ public:
 	void init();
 	void setUnit(GLint u) { unit = u; }
 	GLint getUnit() const { return unit; }
+	GLuint getID() const { return tid; }
 	void bind(GLint handle);
+	// Binds to the texture unit without touching the sampler uniform (set it once instead)
+	void bind();
 	void unbind();
 	void setWrapModes(GLint wrapS, GLint wrapT); // Must be called after init()
 	
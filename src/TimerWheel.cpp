@@ -0,0 +1,153 @@
+#include "TimerWheel.h"
+
+#include <cmath>
+
+#define TIMER_WHEEL_MASK (TIMER_WHEEL_SLOTS - 1)
+#define TIMER_WHEEL_SPAN ((uint64_t)1 << (TIMER_WHEEL_BITS * TIMER_WHEEL_LEVELS)) // Furthest a timer can be placed
+
+TimerWheel::TimerWheel(double tickSeconds) :
+	tickSeconds(tickSeconds),
+	now(0),
+	numPending(0)
+{
+	reset();
+}
+
+void TimerWheel::reset()
+{
+	for(int l = 0; l < TIMER_WHEEL_LEVELS; l++) {
+		for(int s = 0; s < TIMER_WHEEL_SLOTS; s++) {
+			heads[l][s] = TIMER_WHEEL_NONE;
+		}
+	}
+	for(uint32_t i = 0; i < timers.size(); i++) {
+		if(timers[i].pending) {
+			release(i);
+		}
+	}
+	now = 0;
+	numPending = 0;
+}
+
+uint64_t TimerWheel::ticksFor(double seconds) const
+{
+	// A little slack so a lifetime that is a whole number of ticks doesn't round up to one more
+	double ticks = std::ceil(seconds / tickSeconds - 1e-6);
+	return ticks < 1.0 ? 1 : (uint64_t)ticks;
+}
+
+TimerHandle TimerWheel::scheduleIn(double seconds, TimerCallback cb, void *context, uint64_t arg)
+{
+	return scheduleAt(now + ticksFor(seconds), cb, context, arg);
+}
+
+TimerHandle TimerWheel::scheduleAt(uint64_t tick, TimerCallback cb, void *context, uint64_t arg)
+{
+	uint32_t i;
+	if(!freeTimers.empty()) {
+		i = freeTimers.back();
+		freeTimers.pop_back();
+	}
+	else {
+		i = (uint32_t)timers.size();
+		timers.push_back(Timer());
+		timers[i].generation = 1;
+	}
+
+	Timer &t = timers[i];
+	t.due = tick > now ? tick : now + 1;
+	t.cb = cb;
+	t.context = context;
+	t.arg = arg;
+	t.pending = true;
+	link(i);
+	numPending++;
+	return ((uint64_t)t.generation << 32) | i;
+}
+
+bool TimerWheel::cancel(TimerHandle h)
+{
+	uint32_t i = (uint32_t)h;
+	if(i >= timers.size() || timers[i].generation != (uint32_t)(h >> 32) || !timers[i].pending) {
+		return false;
+	}
+	unlink(i);
+	release(i);
+	numPending--;
+	return true;
+}
+
+// Files a timer under the level whose slots are the right size for how far off it is
+void TimerWheel::link(uint32_t i)
+{
+	Timer &t = timers[i];
+	uint64_t delta = t.due - now;
+	uint64_t due = delta < TIMER_WHEEL_SPAN ? t.due : now + TIMER_WHEEL_SPAN - 1; // Too far off: park it at the top
+	int level = 0;
+	while(level < TIMER_WHEEL_LEVELS - 1 && (due - now) >= ((uint64_t)1 << (TIMER_WHEEL_BITS * (level + 1)))) {
+		level++;
+	}
+	t.level = (uint16_t)level;
+	t.slot = (uint16_t)((due >> (TIMER_WHEEL_BITS * level)) & TIMER_WHEEL_MASK);
+
+	uint32_t &head = heads[t.level][t.slot];
+	t.prev = TIMER_WHEEL_NONE;
+	t.next = head;
+	if(head != TIMER_WHEEL_NONE) {
+		timers[head].prev = i;
+	}
+	head = i;
+}
+
+void TimerWheel::unlink(uint32_t i)
+{
+	Timer &t = timers[i];
+	if(t.prev != TIMER_WHEEL_NONE) {
+		timers[t.prev].next = t.next;
+	}
+	else {
+		heads[t.level][t.slot] = t.next;
+	}
+	if(t.next != TIMER_WHEEL_NONE) {
+		timers[t.next].prev = t.prev;
+	}
+}
+
+void TimerWheel::release(uint32_t i)
+{
+	timers[i].pending = false;
+	timers[i].generation++;
+	freeTimers.push_back(i);
+}
+
+void TimerWheel::advance()
+{
+	now++;
+
+	// Where the levels below have just wrapped around, spread the next slot up over them.
+	// Everything in it is due within that level's slot length, so it lands lower down.
+	for(int level = 1; level < TIMER_WHEEL_LEVELS; level++) {
+		if((now & (((uint64_t)1 << (TIMER_WHEEL_BITS * level)) - 1)) != 0) {
+			break;
+		}
+		uint32_t &head = heads[level][(now >> (TIMER_WHEEL_BITS * level)) & TIMER_WHEEL_MASK];
+		uint32_t i = head;
+		head = TIMER_WHEEL_NONE;
+		while(i != TIMER_WHEEL_NONE) {
+			uint32_t next = timers[i].next;
+			link(i);
+			i = next;
+		}
+	}
+
+	// Fire this tick's slot. A callback can cancel other timers in it, so take them off one at a time.
+	uint32_t &head = heads[0][now & TIMER_WHEEL_MASK];
+	while(head != TIMER_WHEEL_NONE) {
+		uint32_t i = head;
+		Timer t = timers[i];
+		unlink(i);
+		release(i);
+		numPending--;
+		t.cb(t.context, t.arg);
+	}
+}
@@ -0,0 +1,79 @@
+#pragma once
+#ifndef TIMER_WHEEL_H
+#define TIMER_WHEEL_H
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#define TIMER_WHEEL_BITS 6                            // 64 slots per level
+#define TIMER_WHEEL_SLOTS (1 << TIMER_WHEEL_BITS)
+#define TIMER_WHEEL_LEVELS 4                          // 64^4 ticks, about 77 hours at 60 Hz
+#define TIMER_WHEEL_NONE 0xffffffffu
+
+// Called with the context and argument it was scheduled with
+typedef void (*TimerCallback)(void *context, uint64_t arg);
+
+// Identifies one scheduled timer. Stays safe to cancel after the timer has fired or been reused,
+// and 0 is never a valid handle.
+typedef uint64_t TimerHandle;
+
+/**
+ * A hierarchical timing wheel in the style of the Linux kernel's, driven by a tick counter
+ * (one simulation tick per advance()). Level 0 has a slot for each of the next 64 ticks; each
+ * level above has slots 64 times as long, and when the levels below wrap around, the next slot
+ * up is emptied into them. So a timer is only touched when it is scheduled, when it moves down a
+ * level (at most TIMER_WHEEL_LEVELS - 1 times) and when it fires, and a tick costs O(1) plus the
+ * timers that are due, however many are pending.
+ * Timers live in a pool with intrusive links, so scheduling doesn't allocate once the pool has
+ * grown to the most timers ever pending at once. Not thread safe.
+ */
+class TimerWheel
+{
+public:
+	TimerWheel(double tickSeconds);
+
+	// Fires cb(context, arg) on the tick that is `seconds` from now, rounded up to a whole tick
+	// (but at least the next one)
+	TimerHandle scheduleIn(double seconds, TimerCallback cb, void *context, uint64_t arg);
+	// Fires cb(context, arg) on the given tick, or on the next one if that has passed
+	TimerHandle scheduleAt(uint64_t tick, TimerCallback cb, void *context, uint64_t arg);
+	// Returns false if the timer already fired or was cancelled
+	bool cancel(TimerHandle h);
+
+	// Moves on one tick and fires the timers due on it. They may schedule and cancel timers.
+	void advance();
+	// Drops every timer and starts counting from tick 0 again
+	void reset();
+
+	uint64_t getTick() const { return now; }
+	size_t size() const { return numPending; }
+	uint64_t ticksFor(double seconds) const;
+
+private:
+	struct Timer {
+		uint64_t due;
+		uint32_t next;
+		uint32_t prev;
+		uint32_t generation; // Bumped whenever the timer is freed, so old handles stop matching
+		uint16_t level;
+		uint16_t slot;
+		bool pending;
+		TimerCallback cb;
+		void *context;
+		uint64_t arg;
+	};
+
+	void link(uint32_t i);
+	void unlink(uint32_t i);
+	void release(uint32_t i);
+
+	double tickSeconds;
+	uint64_t now;
+	size_t numPending;
+	uint32_t heads[TIMER_WHEEL_LEVELS][TIMER_WHEEL_SLOTS];
+	std::vector<Timer> timers;
+	std::vector<uint32_t> freeTimers;
+};
+
+#endif
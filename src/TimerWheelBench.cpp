@@ -0,0 +1,50 @@
+#include "Benchmark.h"
+#include "TimerWheel.h"
+
+#include <cstdlib>
+#include <iostream>
+
+#define TIMER_BENCH_TICK (1.0 / 60.0)
+#define TIMER_BENCH_TICKS 6000
+
+static void countFired(void *context, uint64_t)
+{
+	(*(long *)context)++;
+}
+
+// n timers spread over the next `spread` ticks, each rescheduled as it fires so n stay pending
+static void rescheduleFired(void *context, uint64_t spread)
+{
+	TimerWheel *wheel = (TimerWheel *)context;
+	wheel->scheduleAt(wheel->getTick() + 1 + std::rand() % spread, rescheduleFired, wheel, spread);
+}
+
+static void benchPending(int n, uint64_t spread)
+{
+	std::cout << "  -- " << n << " pending over " << spread << " ticks" << std::endl;
+	TimerWheel wheel(TIMER_BENCH_TICK);
+	std::srand(1);
+	for(int i = 0; i < n; i++) {
+		wheel.scheduleAt(1 + std::rand() % spread, rescheduleFired, &wheel, spread);
+	}
+	double ns = Benchmark::time("tick", TIMER_BENCH_TICKS, [&](){
+		wheel.advance();
+	});
+	// About n / spread fire each tick, and each of those schedules one more
+	Benchmark::report("  per expiry", ns * spread / n);
+}
+
+BENCHMARK_SUITE(timers)
+{
+	// Same pending count, a hundredth as many expiring per tick: the tick should be ~100x cheaper
+	benchPending(100000, 600);
+	benchPending(100000, 60000);
+	benchPending(1000000, 60000);
+
+	TimerWheel wheel(TIMER_BENCH_TICK);
+	long fired = 0;
+	Benchmark::time("schedule + cancel", 1000000, [&](){
+		wheel.cancel(wheel.scheduleIn(2.0, countFired, &fired, 0));
+	});
+	Benchmark::keep(fired);
+}
@@ -0,0 +1,50 @@
+#pragma once
+#ifndef TRIPLE_BUFFER_H
+#define TRIPLE_BUFFER_H
+
+#include <atomic>
+
+/**
+ * Lock-free hand-off of the latest value from one writer thread to one reader thread.
+ * The writer fills writeBuffer() and calls publish(); the reader calls update() and then reads
+ * readBuffer(). Neither side ever waits: the writer always has a free slot, and the reader keeps
+ * the last value it got until a newer one is published. Intermediate values may be skipped.
+ * The slots are reused, so a T holding vectors stops allocating once they have grown.
+ */
+template <typename T>
+class TripleBuffer
+{
+public:
+	TripleBuffer() : shared(1), back(0), front(2) {}
+
+	// Writer side
+	T &writeBuffer() { return slots[back]; }
+	void publish()
+	{
+		// Hand the filled slot over and take back whichever slot was waiting
+		back = shared.exchange(back | FRESH_BIT, std::memory_order_acq_rel) & INDEX_MASK;
+	}
+
+	// Reader side. Returns true if a newer value was swapped in.
+	bool hasUpdate() const { return shared.load(std::memory_order_relaxed) & FRESH_BIT; }
+	bool update()
+	{
+		if(!hasUpdate()) {
+			return false;
+		}
+		front = shared.exchange(front, std::memory_order_acq_rel) & INDEX_MASK;
+		return true;
+	}
+	const T &readBuffer() const { return slots[front]; }
+
+private:
+	static const unsigned INDEX_MASK = 0x3;
+	static const unsigned FRESH_BIT = 0x4;
+
+	T slots[3];
+	std::atomic<unsigned> shared; // Index of the waiting slot, plus FRESH_BIT if the reader hasn't taken it
+	unsigned back;  // Only touched by the writer
+	unsigned front; // Only touched by the reader
+};
+
+#endif
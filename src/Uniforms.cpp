@@ -0,0 +1,35 @@
+#include "Uniforms.h"
+
+void PhongUniforms::resolve(Program &prog)
+{
+	P.resolve(prog, "P");
+	MV.resolve(prog, "MV");
+	lightPos.resolve(prog, "lightPos");
+	ka.resolve(prog, "ka");
+	kd.resolve(prog, "kd");
+	ks.resolve(prog, "ks");
+	s.resolve(prog, "s");
+}
+
+void ParticleUniforms::resolve(Program &prog)
+{
+	P.resolve(prog, "P");
+	MV.resolve(prog, "MV");
+	screenSize.resolve(prog, "screenSize");
+	alphaTexture.resolve(prog, "alphaTexture");
+}
+
+void LineUniforms::resolve(Program &prog)
+{
+	P.resolve(prog, "P");
+	MV.resolve(prog, "MV");
+}
+
+void ProjectileUniforms::resolve(Program &prog)
+{
+	MV.resolve(prog, "MV");
+	dt.resolve(prog, "dt");
+	beamSpeed.resolve(prog, "beamSpeed");
+	beamLength.resolve(prog, "beamLength");
+	beamLife.resolve(prog, "beamLife");
+}
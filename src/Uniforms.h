@@ -0,0 +1,125 @@
+#pragma once
+#ifndef UNIFORMS_H
+#define UNIFORMS_H
+
+#include "Program.h"
+
+#define GLM_FORCE_RADIANS
+#include <glm/glm.hpp>
+#include <glm/gtc/type_ptr.hpp>
+
+/**
+ * A uniform location looked up once after linking, plus the last value sent to it.
+ * set() skips the glUniform* call when the value has not changed. Uniform values are
+ * per-program state, so the cached value stays valid across bind() and unbind().
+ * The owning program must be bound when set() is called.
+ */
+template <typename T>
+class Uniform
+{
+public:
+	void resolve(Program &prog, const std::string &name)
+	{
+		prog.addUniform(name);
+		loc = prog.getUniform(name);
+		cached = false;
+	}
+
+	void set(const T &v)
+	{
+		if(loc == -1 || (cached && value == v)) {
+			return;
+		}
+		value = v;
+		cached = true;
+		send();
+	}
+
+	GLint location() const { return loc; }
+
+private:
+	void send() const;
+
+	GLint loc = -1;
+	bool cached = false;
+	T value;
+};
+
+template <> inline void Uniform<glm::mat4>::send() const { glUniformMatrix4fv(loc, 1, GL_FALSE, glm::value_ptr(value)); }
+template <> inline void Uniform<glm::vec3>::send() const { glUniform3f(loc, value.x, value.y, value.z); }
+template <> inline void Uniform<glm::vec2>::send() const { glUniform2f(loc, value.x, value.y); }
+template <> inline void Uniform<float>::send() const { glUniform1f(loc, value); }
+template <> inline void Uniform<int>::send() const { glUniform1i(loc, value); }
+
+/**
+ * A Program whose uniforms are resolved into the typed handles of Layout right after linking.
+ * Layout must provide resolve(Program &).
+ */
+template <typename Layout>
+class TypedProgram : public Program
+{
+public:
+	Layout u;
+
+	virtual bool init()
+	{
+		if(!Program::init()) {
+			return false;
+		}
+		u.resolve(*this);
+		return true;
+	}
+};
+
+// phong_vert.glsl / phong_frag.glsl
+struct PhongUniforms
+{
+	Uniform<glm::mat4> P;
+	Uniform<glm::mat4> MV;
+	Uniform<glm::vec3> lightPos;
+	Uniform<glm::vec3> ka;
+	Uniform<glm::vec3> kd;
+	Uniform<glm::vec3> ks;
+	Uniform<float> s;
+
+	void resolve(Program &prog);
+};
+
+// vert.glsl / frag.glsl (particles)
+struct ParticleUniforms
+{
+	Uniform<glm::mat4> P;
+	Uniform<glm::mat4> MV;
+	Uniform<glm::vec2> screenSize;
+	Uniform<int> alphaTexture;
+
+	void resolve(Program &prog);
+};
+
+// line_vert.glsl / line_frag.glsl
+struct LineUniforms
+{
+	Uniform<glm::mat4> P;
+	Uniform<glm::mat4> MV;
+
+	void resolve(Program &prog);
+};
+
+// glsl330/projectile_vert.glsl / line_frag.glsl (instanced beams)
+struct ProjectileUniforms
+{
+	Uniform<glm::mat4> MV;
+	Uniform<float> dt;
+	Uniform<float> beamSpeed;
+	Uniform<float> beamLength;
+	Uniform<float> beamLife;
+
+	void resolve(Program &prog);
+};
+
+typedef TypedProgram<PhongUniforms> PhongProgram;
+typedef TypedProgram<ParticleUniforms> ParticleProgram;
+typedef TypedProgram<LineUniforms> LineProgram;
+typedef TypedProgram<ProjectileUniforms> ProjectileProgram;
+
+#endif
@@ -0,0 +1,84 @@
+#include "WorldSnapshot.h"
+
+#include <glm/gtc/quaternion.hpp>
+
+// Anything that moved further than this in one tick wrapped around the map and shouldn't be blended
+#define SNAPSHOT_TELEPORT_DIST 10.0f
+
+glm::mat4 interpolateTransform(const glm::mat4 &a, const glm::mat4 &b, float alpha)
+{
+	float sa = glm::length(glm::vec3(a[0]));
+	float sb = glm::length(glm::vec3(b[0]));
+	if (sa == 0.0f || sb == 0.0f){
+		return b;
+	}
+
+	glm::mat3 Ra, Rb;
+	for (int i = 0; i < 3; i++){
+		Ra[i] = glm::vec3(a[i]) / sa;
+		Rb[i] = glm::vec3(b[i]) / sb;
+	}
+	glm::mat3 R = glm::mat3_cast(glm::slerp(glm::quat_cast(Ra), glm::quat_cast(Rb), alpha));
+	float s = glm::mix(sa, sb, alpha);
+
+	glm::mat4 M(1.0f);
+	for (int i = 0; i < 3; i++){
+		M[i] = glm::vec4(s * R[i], 0.0f);
+	}
+	M[3] = glm::vec4(glm::mix(glm::vec3(a[3]), glm::vec3(b[3]), alpha), 1.0f);
+	return M;
+}
+
+static bool teleported(const glm::vec3 &a, const glm::vec3 &b)
+{
+	return glm::length(b - a) > SNAPSHOT_TELEPORT_DIST;
+}
+
+glm::vec3 originShift(const WorldSnapshot &prev, const WorldSnapshot &curr)
+{
+	return glm::vec3((float)(prev.originX - curr.originX), 0.0f, (float)(prev.originZ - curr.originZ));
+}
+
+static glm::mat4 shifted(glm::mat4 M, const glm::vec3 &d)
+{
+	M[3] += glm::vec4(d, 0.0f);
+	return M;
+}
+
+void interpolateSnapshots(const WorldSnapshot &prev, const WorldSnapshot &curr, float alpha, WorldSnapshot &out)
+{
+	out = curr;
+
+	// Zero unless the origin moved between the two
+	glm::vec3 d = originShift(prev, curr);
+
+	// Ship
+	const ShipSnapshot &s0 = prev.ship;
+	ShipSnapshot &s = out.ship;
+	if (!teleported(s0.pos + d, s.pos)){
+		s.M = interpolateTransform(shifted(s0.M, d), s.M, alpha);
+		s.pos = glm::mix(s0.pos + d, s.pos, alpha);
+		s.roll = glm::mix(s0.roll, s.roll, alpha);
+		// A keyframed animation starting or ending is a jump we don't want to smear
+		if (s0.anim == s.anim){
+			s.drawM = interpolateTransform(shifted(s0.drawM, d), s.drawM, alpha);
+			s.E = interpolateTransform(s0.E, s.E, alpha);
+		}
+	}
+
+	// Asteroids. Both lists are sorted by id, so walk them together.
+	auto a0 = prev.asteroids.begin();
+	for (auto a = out.asteroids.begin(); a != out.asteroids.end(); ++a){
+		while (a0 != prev.asteroids.end() && a0->id < a->id){
+			++a0;
+		}
+		if (a0 == prev.asteroids.end()){
+			break;
+		}
+		if (a0->id != a->id || teleported(a0->bsCenter + d, a->bsCenter)){
+			continue;
+		}
+		a->M[3] = glm::mix(a0->M[3] + glm::vec4(d, 0.0f), a->M[3], alpha);
+		a->bsCenter = glm::mix(a0->bsCenter + d, a->bsCenter, alpha);
+	}
+}
@@ -0,0 +1,85 @@
+#pragma once
+#ifndef WORLD_SNAPSHOT_H
+#define WORLD_SNAPSHOT_H
+
+#include <cstdint>
+#include <vector>
+
+#define GLM_FORCE_RADIANS
+#include <glm/glm.hpp>
+
+class Shape;
+
+// Everything the renderer needs to know about the ship after a simulation tick
+struct ShipSnapshot {
+	glm::mat4 M;      // Model matrix that the cameras follow (Ship::getModelMatrix())
+	glm::mat4 drawM;  // Model matrix the mesh is drawn with (includes the roll and the keyframed animation)
+	glm::mat4 E;      // Keyframed animation matrix, identity when no animation is running
+	glm::vec3 pos;
+	glm::vec3 col;
+	float roll;
+	int anim;
+	bool thrust;      // W is held, so the exhaust emits new particles
+};
+
+struct AsteroidInstance {
+	unsigned id;
+	const Shape *model;
+	glm::mat4 M;
+	glm::vec3 color;
+	glm::vec3 bsCenter;
+	float bsRadius;
+};
+
+// A beam as of the snapshot's tick. Beams fly in straight lines, so the renderer works out where
+// one is at any other time from this, and uploads these as they are for the instanced draw.
+struct ProjectileInstance {
+	glm::vec3 start; // Tail of the beam
+	float age;       // Seconds since it was fired
+	glm::vec3 dir;
+};
+
+// A live particle effect. The renderer owns the particles and creates them the first time an id shows up.
+struct EmitterInstance {
+	unsigned id;
+	glm::mat4 M;
+	glm::vec3 color;
+};
+
+/**
+ * An immutable copy of the world published by the simulation thread after each tick.
+ * The render thread only ever reads snapshots, never the live simulation objects.
+ */
+struct WorldSnapshot {
+	unsigned long tick = 0;
+	double t = 0.0;          // Simulation time of the tick
+	double tPublished = 0.0; // Wall-clock time it was published, used for interpolation
+	double originX = 0.0;    // World position of the local origin, which moves in the open world
+	double originZ = 0.0;
+
+	ShipSnapshot ship;
+	std::vector<AsteroidInstance> asteroids; // Sorted by id
+	std::vector<ProjectileInstance> projectiles;
+	std::vector<EmitterInstance> explosions;
+
+	int numLives = 0;
+	double score = 0.0;
+	// The simulation's FrameArena: most of it a tick has used, and how often it was full and fell
+	// back to the heap
+	uint64_t arenaHighWater = 0;
+	uint64_t arenaOverflows = 0;
+	bool finished = false;   // The game-over explosion has played out
+};
+
+// Blends two rigid transforms with a uniform scale (translation lerp, rotation slerp)
+glm::mat4 interpolateTransform(const glm::mat4 &a, const glm::mat4 &b, float alpha);
+
+// How far prev's positions have to move to be in curr's frame, after the open world rebased its origin
+glm::vec3 originShift(const WorldSnapshot &prev, const WorldSnapshot &curr);
+
+// Fills out with the world between prev (alpha = 0) and curr (alpha = 1).
+// Objects that only exist in curr, or that wrapped around the map, are taken from curr as is.
+// Projectiles are left as they are in curr too; the renderer moves them back to the blended time.
+void interpolateSnapshots(const WorldSnapshot &prev, const WorldSnapshot &curr, float alpha, WorldSnapshot &out);
+
+#endif
@@ -1,4 +1,10 @@
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <cstring>
+#include <fstream>
 #include <iostream>
+#include <thread>
 #include <vector>
 
 #define GLEW_STATIC
@@ -16,15 +22,59 @@
 #include "MatrixStack.h"
 #include "Shape.h"
 #include "Ship.h"
+#include "Maneuver.h"
 #include "Asteroid.h"
+#include "AsteroidField.h"
+#include "AsteroidMesh.h"
 #include "Star.h"
-#include "Beam.h"
+#include "Projectiles.h"
+#include "SpatialQuery.h"
+#include "AsteroidCollider.h"
+#include "CollisionEvents.h"
 #include "Explosion.h"
+#include "TimerWheel.h"
+#include "LineRenderer.h"
+#include "FrameUniforms.h"
+#include "Uniforms.h"
+#include "GLState.h"
+#include "RenderQueue.h"
+#include "TripleBuffer.h"
+#include "WorldSnapshot.h"
+#include "Input.h"
+#include "LatencyTracker.h"
+#include "FramePacer.h"
+#include "Stats.h"
+#include "AllocStats.h"
+#include "MetricsPublisher.h"
+#include "FrameArena.h"
+#include "Pool.h"
+#include "Benchmark.h"
+#include "ScalingSweep.h"
+#include "randomFunctions.h"
 
 using namespace std;
 
 #define NUM_ASTEROID_MODELS 1
 
+// The simulation runs at a fixed rate on its own thread, independent of vsync
+#define SIM_HZ 60.0
+#define SIM_DT (1.0 / SIM_HZ)
+#define SIM_MAX_CATCHUP 5 // Most ticks run back to back after a stall
+
+// --low-latency: the tick schedule drifts by at most this much per frame to line up with input sampling
+#define SIM_PHASE_NUDGE 0.0005
+#define SIM_POLL_INTERVAL 0.0005 // How often the simulation looks for a new input sample time
+#define SIM_WAIT_MAX 0.002       // Longest the render thread waits for the tick after sampling input
+
+#define METRICS_INTERVAL 0.25 // Seconds between updates of the --metrics page
+
+#define SHIP_EXPLOSION_ID 0
+
+#define SIM_ARENA_SIZE (64 * 1024)  // Scratch memory for one simulation tick
+#define EXPLOSION_POOL_SIZE 8       // Explosions made up front, so the first few kills don't hitch
+
+#define SWEEP_LIVES 1000000 // --scaling-sweep: enough that the scripted ship never runs out
+
 enum CAMERA_TYPES{
 	THIRD_PERSON,
 	TOP_DOWN,
@@ -37,40 +87,99 @@ bool drawBoundingBox = false;
 bool drawGrid = true;
 bool drawAxisFrame = false;
 bool debug = false;
-bool pause = false;
+atomic<bool> pause(false);
 int numLives = 3;
+bool coreProfile = true; // OpenGL 3.3 core profile unless --gl-compat is passed
+bool lowLatency = false; // Paces frames just before the refresh (--low-latency)
+string statsOut = "";    // Where to write the timing histograms as JSON at exit (--stats-out)
+bool publishMetrics = false; // Exposes live metrics in shared memory (--metrics)
+string benchName = "";   // Runs this benchmark suite instead of the game (--bench)
+string sweepOut = "";    // Runs the scripted workload at growing sizes and writes the report here (--scaling-sweep)
+bool openWorld = false;  // Streams an endless chunked field around the ship (--open-world)
+unsigned worldSeed = 0;  // What the open world's chunks and generated asteroid meshes come from
+int proceduralVariants = 0; // Asteroid meshes to generate instead of loading asteroid1.obj (--procedural)
 
 GLFWwindow *window; // Main application window
 string RESOURCE_DIR = ""; // Where the resources are loaded from
+string SHADER_DIR = ""; // Where the shaders for the current GL profile are loaded from
 
 int keyPresses[256] = {0}; // only for English keyboards!
-bool isPressed[512] = {0};
+Input input; // Key events from key_callback to the simulation thread
 double score = 0.0;
-double tGlobal = 0.0;
+thread_local double tGlobal = 0.0; // Each thread keeps its own clock
 int NUM_ASTEROIDS = 22;
 
 
-shared_ptr<Program> prog;
+shared_ptr<PhongProgram> prog;
 
 shared_ptr<Camera> camera;
 shared_ptr<Camera> fpcam;
+// Before the ship, which cancels its timers on the way out and so has to go first
+TimerWheel simTimers(SIM_DT); // Everything in the simulation that expires, one tick per simulate()
 shared_ptr<Ship> ship;
 
-shared_ptr<Program> pProg;
+shared_ptr<ParticleProgram> pProg;
 shared_ptr<Texture> alphaTex;
 
 vector<shared_ptr<Shape> > asteroidModels;
+AsteroidBodies asteroidBodies; // Before anything holding asteroids, which hand their bodies back to it
 vector<shared_ptr<Asteroid> > asteroids;
+Pool<Asteroid> asteroidPool; // Destroyed asteroids, reused for the children of later ones
+shared_ptr<AsteroidField> field; // Only with --open-world; asteroids then holds its active chunks
+FrameArena simArena(SIM_ARENA_SIZE);
+bool gameFinished = false;    // Set once the ship's explosion has played out
 vector<shared_ptr<Star> > stars;
 
-vector<shared_ptr<Explosion> > explosions;
+// An explosion as far as the simulation is concerned. The particles live on the render thread.
+struct SimExplosion {
+	unsigned id;   // For the render thread, never reused
+	unsigned slot; // What its expiry timer finds it by
+	glm::vec3 center;
+	glm::vec3 color;
+};
+vector<SimExplosion> explosions;
+vector<unsigned> explosionSlotIndex; // Where the explosion in each slot is now in explosions
+vector<unsigned> freeExplosionSlots;
+unsigned nextExplosionID = SHIP_EXPLOSION_ID + 1;
 
 shared_ptr<Shape> bsModel;
 
 shared_ptr<Shape> frustum;
 
-bool shootBeam = false;
-vector<shared_ptr<Beam> > beams;
+ProjectilePool projectiles;
+vector<vector<ProjectileHit> > beamHits; // Scratch for each thread that looks for beam collisions
+CollisionEventQueue collisionEvents;
+
+// Rebuilt from the world at the start of every tick, for collisions and anything else that
+// wants to know what is near somewhere
+SpatialQuery worldQuery;
+vector<BoundingSphere> asteroidBounds; // In the same order as asteroids
+vector<BoundingSphere> shipBounds;
+vector<BoundingSphere> projectileBounds;
+AsteroidCollider asteroidCollider;
+
+shared_ptr<LineRenderer> lineRenderer;
+shared_ptr<FrameUniforms> frameUniforms;
+shared_ptr<RenderQueue> renderQueue;
+
+// Simulation thread -> render thread
+TripleBuffer<WorldSnapshot> snapshots;
+atomic<bool> simRunning(false);
+unsigned long simTick = 0;
+atomic<double> tInputSampled(-1.0); // When the render thread last polled input, for --low-latency
+
+LatencyTracker latency;
+shared_ptr<FramePacer> pacer; // Only with --low-latency
+bool useFences = false;       // Whether latency can be measured with sync objects instead of glFinish()
+shared_ptr<MetricsPublisher> metrics; // Only with --metrics
+
+// Render thread only
+WorldSnapshot prevSnapshot;  // The snapshot before the newest one
+WorldSnapshot frameSnapshot; // The two blended for the current frame
+vector<pair<unsigned, shared_ptr<Explosion> > > explosionEffects; // Particles for each live explosion id
+Pool<Explosion> explosionPool; // Played-out explosions, kept for reuse
+shared_ptr<MatrixStack> P;  // Reused every frame
+shared_ptr<MatrixStack> MV;
 
 void initStars(){
 	for(int i = 0; i < NUM_STARS; i++){
@@ -78,21 +187,6 @@ void initStars(){
 	}
 }
 
-void initBeams(){
-	for (int i = 0; i < MAX_BEAMS; i++){
-		beams.push_back(make_shared<Beam>());
-	}
-}
-
-std::shared_ptr<Beam> findUnusedBeam(){
-	for (auto b = beams.begin(); b != beams.end(); ++b){
-		if ((*b)->isAlive() == false){
-			return (*b);
-		}
-	}
-	return NULL;
-}
-
 void resetAsteroidPositions(){
 	for (auto a = asteroids.begin(); a != asteroids.end(); ++a){
 		(*a)->randomDir();
@@ -111,19 +205,10 @@ static void key_callback(GLFWwindow *window, int key, int scancode, int action,
 		glfwSetWindowShouldClose(window, GL_TRUE);
 	}
 
-	if (action == GLFW_PRESS){
-		isPressed[key] = true;
-	}
-
-	if (action == GLFW_RELEASE){
-		isPressed[key] = false;
-	}
-
-	if ((key == 'J' || key == 'j') && (action == GLFW_RELEASE) && (ship->getCurrAnim() == NONE) && !pause){
-		shootBeam = true;
-	}
+	// Movement and shooting are handled by the simulation thread
+	input.push(key, action);
 
-	else if ((key == 'P' || key == 'p') && (action == GLFW_PRESS)){
+	if ((key == 'P' || key == 'p') && (action == GLFW_PRESS)){
 		pause = !pause;
 	}
 
@@ -169,44 +254,32 @@ void mouse_button_callback(GLFWwindow* window, int button, int action, int mods)
 	}
 }
 
-void drawHUD(shared_ptr<MatrixStack> &P, shared_ptr<MatrixStack> &MV, double time){
+void submitHUD(shared_ptr<MatrixStack> &P, shared_ptr<MatrixStack> &MV, double time, int width, int height, const WorldSnapshot &world){
 	// Draw the lives
 	// Use an orthogonal projection for the HUD objects
 	// But it might be easier to use a perspective that is very far away (looks close enough to projection)
 	P->pushMatrix();
 	camera->applyOrthogonalMatrix(P);
-	glUniformMatrix4fv(prog->getUniform("P"), 1, GL_FALSE, glm::value_ptr(P->topMatrix()));
+	int hudView = renderQueue->addView(P->topMatrix(), width, height);
 
 	float rot = -M_PI + time * 1.5f;
 	// Draw the spaceship's lives
-	for (int i = 0; i < numLives; i++){
-		glm::vec3 col = ship->getCol();
-		glUniform3f(prog->getUniform("kd"), col.r, col.g, col.b);
-
+	for (int i = 0; i < world.numLives; i++){
 		MV->pushMatrix();
 		glm::vec3 t(-45.0f + 5.5f * i, 42.5f, -3.0f);
 		MV->translate(t);
 		MV->rotate(rot, 0.0f, 1.0f, 0.0f);
 		MV->rotate(-M_PI_2, 1.0f, 0.0f, 0.0f);
 	
-		glUniform3f(prog->getUniform("lightPos"), t.x, t.y, t.z + 5.0);
-		glUniformMatrix4fv(prog->getUniform("MV"), 1, GL_FALSE, glm::value_ptr(MV->topMatrix()));
-		ship->draw(prog);
+		glm::vec3 lightPos(t.x, t.y, t.z + 5.0);
+		renderQueue->submitMesh(hudView, ship.get(), MV->topMatrix(), world.ship.col, lightPos);
 		MV->popMatrix();
 	}
 
 	if (camType == FIRST_PERSON){
-		MV->pushMatrix();
-		glUniform3f(prog->getUniform("kd"), 1.0f, 0.0f, 0.0f);
-		glUniform3f(prog->getUniform("lightPos"), 0.0f, 0.0f, 20.0f);
-		glUniformMatrix4fv(prog->getUniform("MV"), 1, GL_FALSE, glm::value_ptr(MV->topMatrix()));
-		frustum->draw(prog);
-		MV->popMatrix();
+		renderQueue->submitMesh(hudView, frustum.get(), MV->topMatrix(), glm::vec3(1.0f, 0.0f, 0.0f), glm::vec3(0.0f, 0.0f, 20.0f));
 	}
 
-	// Reset light position
-	glUniform3f(prog->getUniform("lightPos"), 0.0f, 0.0f, 0.0f);
-
 	P->popMatrix();
 }
 
@@ -217,37 +290,36 @@ static void init()
 	// Set background color
 	glClearColor(0.05f, 0.05f, 0.05f, 1.0f);
 	// Enable z-buffer test
-	glEnable(GL_DEPTH_TEST);
+	GLState::enable(GL_DEPTH_TEST);
+	// Let the vertex shaders set gl_PointSize (stars and particles)
+	GLState::enable(GL_VERTEX_PROGRAM_POINT_SIZE);
 
 	keyPresses[(unsigned)'c'] = 1;
+
+	// Per-frame camera data shared by all programs (core profile only)
+	frameUniforms = make_shared<FrameUniforms>();
+	if (coreProfile){
+		frameUniforms->init();
+	}
 	
-	prog = make_shared<Program>();
-	prog->setShaderNames(RESOURCE_DIR + "phong_vert.glsl", RESOURCE_DIR + "phong_frag.glsl");
+	prog = make_shared<PhongProgram>();
+	prog->setShaderNames(SHADER_DIR + "phong_vert.glsl", SHADER_DIR + "phong_frag.glsl");
 	prog->setVerbose(true);
 	prog->init();
-	prog->addUniform("P");
-	prog->addUniform("MV");
-	prog->addUniform("lightPos");
-	prog->addUniform("ka");
-	prog->addUniform("kd");
-	prog->addUniform("ks");
-	prog->addUniform("s");
 	prog->addAttribute("aPos");
 	prog->addAttribute("aNor");
+	frameUniforms->attach(prog);
 	prog->setVerbose(false);
 
-	pProg = make_shared<Program>();
-	pProg->setShaderNames(RESOURCE_DIR + "vert.glsl", RESOURCE_DIR + "frag.glsl");
+	pProg = make_shared<ParticleProgram>();
+	pProg->setShaderNames(SHADER_DIR + "vert.glsl", SHADER_DIR + "frag.glsl");
 	pProg->setVerbose(true);
 	pProg->init();
-	pProg->addUniform("P");
-	pProg->addUniform("MV");
-	pProg->addUniform("screenSize");
-	pProg->addUniform("alphaTexture");
 	pProg->addAttribute("aPos");
 	pProg->addAttribute("aAlp");
 	pProg->addAttribute("aCol");
 	pProg->addAttribute("aSca");
+	frameUniforms->attach(pProg);
 
 	pProg->setVerbose(false);
 	
@@ -258,6 +330,7 @@ static void init()
 	ship->loadMesh(RESOURCE_DIR + "ship.obj");
 	ship->initExhaust(RESOURCE_DIR);
 	ship->init();
+	Maneuvers::bake();
 
 	// Initialize the bounding sphere model
 	bsModel = make_shared<Shape>();
@@ -270,21 +343,65 @@ static void init()
 	frustum->init();
 
 	// Initialize asteroid meshes. We only want to load them in once:
-	for (int i = 0; i < NUM_ASTEROID_MODELS; i++){
-		asteroidModels.push_back(make_shared<Shape>());
-		asteroidModels.at(i)->loadMesh(RESOURCE_DIR + "asteroid" + to_string(i + 1) + ".obj");
-		asteroidModels.at(i)->init();
+	if (proceduralVariants > 0){
+		double t0 = glfwGetTime();
+		vector<AsteroidMeshData> meshes;
+		int cached = generateAsteroidMeshes(worldSeed, proceduralVariants, meshes);
+		for (int i = 0; i < proceduralVariants; i++){
+			shared_ptr<AsteroidModel> m = make_shared<AsteroidModel>();
+			m->setMeshData(meshes.at(i));
+			m->init();
+			asteroidModels.push_back(m);
+		}
+		cout << "Generated " << proceduralVariants << " asteroid meshes (" << cached << " cached) in "
+			<< 1000.0 * (glfwGetTime() - t0) << " ms" << endl;
+	}
+	else{
+		for (int i = 0; i < NUM_ASTEROID_MODELS; i++){
+			asteroidModels.push_back(make_shared<Shape>());
+			asteroidModels.at(i)->loadMesh(RESOURCE_DIR + "asteroid" + to_string(i + 1) + ".obj");
+			asteroidModels.at(i)->init();
+		}
 	}
 	
-	for (int i = 0; i < NUM_ASTEROIDS; i++){
-		asteroids.push_back(make_shared<Asteroid>(asteroidModels.at(i % NUM_ASTEROID_MODELS)));
+	if (openWorld){
+		// NUM_ASTEROIDS is then the number in each chunk
+		int activeChunks = (2 * CHUNK_ACTIVE_RADIUS + 1) * (2 * CHUNK_ACTIVE_RADIUS + 1);
+		int loadedChunks = (2 * CHUNK_REDUCED_RADIUS + 1) * (2 * CHUNK_REDUCED_RADIUS + 1);
+		asteroids.reserve(2 * activeChunks * NUM_ASTEROIDS);
+		asteroidPool.reserve(2 * loadedChunks * NUM_ASTEROIDS);
+		// Pooled asteroids keep their bodies too
+		asteroidBodies.reserve(2 * (activeChunks + loadedChunks) * NUM_ASTEROIDS);
+		explosions.reserve(2 * NUM_ASTEROIDS);
+		explosionSlotIndex.reserve(2 * NUM_ASTEROIDS);
+		freeExplosionSlots.reserve(2 * NUM_ASTEROIDS);
+
+		field = make_shared<AsteroidField>(worldSeed, NUM_ASTEROIDS, asteroidModels, asteroidPool);
+		field->start(ship->getPos(), asteroids);
+	}
+	else{
+		// Every asteroid can split once, so there are never more than twice as many
+		asteroids.reserve(2 * NUM_ASTEROIDS);
+		asteroidPool.reserve(2 * NUM_ASTEROIDS);
+		asteroidBodies.reserve(4 * NUM_ASTEROIDS);
+		for (int i = 0; i < NUM_ASTEROIDS; i++){
+			asteroids.push_back(make_shared<Asteroid>(asteroidModels.at(i % asteroidModels.size())));
+		}
+		explosions.reserve(2 * NUM_ASTEROIDS);
+		explosionSlotIndex.reserve(2 * NUM_ASTEROIDS);
+		freeExplosionSlots.reserve(2 * NUM_ASTEROIDS);
 	}
 
 	// Initialize the stars:
 	initStars();
 
-	// Initialize the beam objects:
-	initBeams();
+	// Initialize the batched star/beam/grid renderer
+	lineRenderer = make_shared<LineRenderer>();
+	lineRenderer->init(SHADER_DIR, stars);
+	frameUniforms->attach(lineRenderer->getProgram());
+	if (lineRenderer->getProjectileProgram()){
+		frameUniforms->attach(lineRenderer->getProjectileProgram());
+	}
 
 	// Initialize the particle alpha texture
 	alphaTex = make_shared<Texture>();
@@ -293,6 +410,20 @@ static void init()
 	alphaTex->setUnit(0);
 	alphaTex->setWrapModes(GL_REPEAT, GL_REPEAT);
 
+	// Make a few explosions now rather than when the first asteroids blow up
+	explosionPool.reserve(EXPLOSION_POOL_SIZE);
+	for (int i = 0; i < EXPLOSION_POOL_SIZE; i++){
+		explosionPool.release(make_shared<Explosion>(RESOURCE_DIR, Eigen::Vector3f(1.0f, 1.0f, 1.0f)));
+	}
+	explosionEffects.reserve(EXPLOSION_POOL_SIZE);
+
+	P = make_shared<MatrixStack>();
+	MV = make_shared<MatrixStack>();
+
+	// All draws are submitted to the render queue and issued in sorted order at the end of render()
+	renderQueue = make_shared<RenderQueue>();
+	renderQueue->init(prog, pProg, alphaTex, lineRenderer, frameUniforms);
+
 	// Initialize time.
 	glfwSetTime(0.0);
 	
@@ -302,6 +433,52 @@ static void init()
 	GLSL::checkError(GET_FILE_LINE);
 }
 
+// Files everything in the world under worldQuery as it is at the start of this tick
+void buildWorldQuery(){
+	// The asteroids wrap around the playfield, except in the open world
+	if (field){ worldQuery.setWrap(0.0f, 0.0f); }
+	else{ worldQuery.setWrap(MAX_X, MAX_Z); }
+
+	asteroidBounds.clear();
+	for (auto a = asteroids.begin(); a != asteroids.end(); ++a){
+		asteroidBounds.push_back((*a)->getBoundingSphere());
+	}
+	worldQuery.build(QUERY_ASTEROIDS, asteroidBounds);
+
+	shipBounds.clear();
+	shipBounds.push_back(ship->getBoundingSphere());
+	worldQuery.build(QUERY_SHIPS, shipBounds);
+
+	projectiles.getBounds(projectileBounds);
+	worldQuery.build(QUERY_PROJECTILES, projectileBounds);
+}
+
+// Narrowphase for a pair the bounding spheres let through: whether the ship's triangles touch
+// those of the asteroid at hit, which may be a copy of it across the wraparound edge
+bool shipTouchesAsteroid(const QueryHit &hit){
+	shared_ptr<Asteroid> &a = asteroids.at(hit.index);
+	const MeshBVH &bvh = a->model->getBVH();
+	if (bvh.empty() || ship->getBVH().empty()){
+		return true;
+	}
+	glm::mat4 M = a->getModelMatrix();
+	M[3] += glm::vec4(hit.center - a->getPos(), 0.0f);
+	return MeshBVH::overlap(bvh, ship->getBVH(), glm::inverse(M) * ship->getDrawMatrix());
+}
+
+// Narrowphase for a beam whose segment from p along d for len units enters asteroid j's sphere:
+// whether it hits the mesh, and if so how far along (t)
+bool beamHitsAsteroid(int j, const glm::vec3 &p, const glm::vec3 &d, float len, float &t){
+	shared_ptr<Asteroid> &a = asteroids.at(j);
+	const MeshBVH &bvh = a->model->getBVH();
+	if (bvh.empty()){
+		return true;
+	}
+	// In the model's space, where t still counts world units along the beam
+	glm::mat4 Minv = glm::inverse(a->getModelMatrix());
+	return bvh.raycast(glm::vec3(Minv * glm::vec4(p, 1.0f)), glm::vec3(Minv * glm::vec4(d, 0.0f)), len, t);
+}
+
 // Checks if the ship has collided with an asteroid.
 // Returns ``i``, where ``i`` is the index of the asteroid that the ship collided with.
 // If there was no collision, returns ``-1``.
@@ -312,110 +489,454 @@ int checkShipCollisions(){
 	}
 	
 	// Bounding sphere of the ship:
-	auto bsS = ship->getBoundingSphere();
-
-	for (int i = 0; i < asteroids.size(); i++){
-		auto a = asteroids.at(i);
-		auto bsA = a->getBoundingSphere();
-
-		if (bsS->collided(*bsA.get())){
-			return i;
+	BoundingSphere bsS = ship->getBoundingSphere();
+
+	// Whatever gets past the spheres has its triangles checked against the ship's
+	std::vector<QueryHit, ArenaAllocator<QueryHit> > hits(8, QueryHit(), simArena);
+	int n = worldQuery.overlap(bsS, QUERY_MASK(QUERY_ASTEROIDS), hits.data(), (int)hits.size());
+	if (n > (int)hits.size()){
+		hits.resize(n);
+		worldQuery.overlap(bsS, QUERY_MASK(QUERY_ASTEROIDS), hits.data(), n);
+	}
+	for (int i = 0; i < n; i++){
+		if (shipTouchesAsteroid(hits.at(i))){
+			return hits.at(i).index;
 		}
 	}
 
 	return -1;
 }
 
-// Checks if there are any beams that have collided with asteroids
-void checkBeamCollisions(){
+// Timer callbacks. Each gets what it expires by id, since indices move as things come and go.
+void expireProjectile(void *, uint64_t id){
+	// Beams that hit something are already gone, so this is often a no-op
+	projectiles.despawnID((uint32_t)id);
+}
 
-	std::vector<std::shared_ptr<Asteroid> > newChildren;
+void expireExplosion(void *, uint64_t slot){
+	// A slot is only freed here, so it can't have been reused while its timer was pending
+	unsigned i = explosionSlotIndex.at(slot);
+	explosions.at(i) = explosions.back();
+	explosionSlotIndex.at(explosions.at(i).slot) = i;
+	explosions.pop_back();
+	freeExplosionSlots.push_back((unsigned)slot);
+}
 
-	if (asteroids.size() == 0 && ship->getCurrAnim() != GAME_OVER){
-		cout << " ====== YOU WIN! ====== \n";
-		ship->gameOver(RESOURCE_DIR);
-		score += 2500 * numLives;
+void finishGame(void *, uint64_t){
+	gameFinished = true;
+}
+
+// Adds an explosion that the simulation forgets once its particles have died out
+void addExplosion(const glm::vec3 &center, const glm::vec3 &color){
+	SimExplosion e;
+	e.id = nextExplosionID++;
+	if (freeExplosionSlots.empty()){
+		e.slot = (unsigned)explosionSlotIndex.size();
+		explosionSlotIndex.push_back(0);
+	}
+	else{
+		e.slot = freeExplosionSlots.back();
+		freeExplosionSlots.pop_back();
 	}
+	e.center = center;
+	e.color = color;
+	explosionSlotIndex.at(e.slot) = (unsigned)explosions.size();
+	explosions.push_back(e);
+	simTimers.scheduleIn(EXPLOSION_LIFESPAN, expireExplosion, nullptr, e.slot);
+}
 
-	for (int i = 0; i < beams.size(); i++){
-		auto b = beams.at(i);
-		if (b->isAlive() == false){ continue; }
+// Blows the ship up. The game is over once its explosion has played out.
+void endGame(){
+	ship->gameOver();
+	simTimers.scheduleIn(EXPLOSION_LIFESPAN, finishGame, nullptr, 0);
+}
 
-		glm::vec3 start = b->getStart();
-		glm::vec3 end = b->getEnd();
-		
-		std::shared_ptr<MatrixStack> MA = make_shared<MatrixStack>(); // A matrix stack to store the transformations from asteroid coords to world coords 
-		for (int j = 0; j < asteroids.size(); j++){
-			auto a = asteroids.at(j);
-			auto bs = a->getBoundingSphere();
+// Finds every beam that hit an asteroid this tick, without acting on any of them. The beams are
+// split over the cores when there are enough of them; nothing here writes to the world.
+void detectBeamCollisions(){
+	if (projectiles.size() == 0){
+		return;
+	}
 
-			if (bs->collided(start, end)){
-				if (debug){
-					std::cout << "Beam " << i << " collided with asteroid " << j << endl; 
-				}
+	// Sweep every beam against the grid of the asteroids, then against the meshes of the
+	// asteroids whose spheres it went through
+	const SpatialGrid &grid = worldQuery.getGrid(QUERY_ASTEROIDS);
+	beamHits.resize(collisionEvents.getMaxThreads());
+	collisionEvents.detect(projectiles.size(), [&grid](int thread, int begin, int end, vector<CollisionEvent> &out){
+		vector<ProjectileHit> &hits = beamHits.at(thread);
+		hits.clear();
+		projectiles.collide(grid, begin, end, hits, beamHitsAsteroid);
+		for (auto h = hits.begin(); h != hits.end(); ++h){
+			out.push_back(CollisionEvent(COLLISION_BEAM_ASTEROID, h->projectile, h->target, h->t));
+		}
+	});
+}
+
+// Applies what the tick's collisions did to the game, in the order gather() puts them in
+void resolveCollisions(){
+	const vector<CollisionEvent> &events = collisionEvents.gather();
+	std::vector<std::shared_ptr<Asteroid>, ArenaAllocator<std::shared_ptr<Asteroid> > > newChildren(simArena);
+
+	// Several beams can hit the same asteroid in one tick. They all stop, but it only blows up once.
+	std::vector<char, ArenaAllocator<char> > destroyed(asteroids.size(), 0, simArena);
+	bool anyDestroyed = false;
+	for (auto e = events.begin(); e != events.end(); ++e){
+		int j = e->target;
+		if (e->kind == COLLISION_SHIP_ASTEROID){
+			if (debug){
+				cout << "Ship collided with asteroid " << j << " at time " << tGlobal << endl;
+			}
 
-				beams.at(i)->setDead();
-				score += ceil(bs->radius) * 10;
+			numLives--;
 
-				// Create an explosion at the asteroid's center
-				glm::vec3 aCol = a->getColor();
-				Eigen::Vector3f asteroidCol(aCol.x, aCol.y, aCol.z); 
+			if (numLives < 0 && ship->getCurrAnim() != GAME_OVER){
+				// Begin ship explosion animation
+				endGame();
+			}
+			else{
+				// Start invincibility
+				ship->setInvincible();
+			}
+			continue;
+		}
 
-				auto e = make_shared<Explosion>(RESOURCE_DIR, asteroidCol);
-				e->setCenter(a->getPos());
-				explosions.push_back(e);
+		if (destroyed.at(j)){ continue; }
+		destroyed.at(j) = 1;
+		anyDestroyed = true;
 
-				auto children = a->getChildren();
-				if (!children.empty()){
-					newChildren.push_back(children.at(0));
-					newChildren.push_back(children.at(1));
-				}
+		auto a = asteroids.at(j);
+		const BoundingSphere &bs = asteroidBounds.at(j);
+		if (debug){
+			std::cout << "Beam " << e->source << " collided with asteroid " << j << endl; 
+		}
+
+		score += ceil(bs.radius) * 10;
 
-				asteroids.erase(asteroids.begin() + j);
-				j--;
+		// Create an explosion at the asteroid's center. The render thread makes the particles.
+		addExplosion(a->getPos(), a->getColor());
+
+		shared_ptr<Asteroid> c1, c2;
+		if (a->getChildren(asteroidPool, c1, c2)){
+			newChildren.push_back(c1);
+			newChildren.push_back(c2);
+		}
+
+		asteroidPool.release(a);
+	}
+
+	// Beam events are sorted by index, so going backwards a despawn only ever moves a projectile
+	// that is staying
+	for (auto e = events.rbegin(); e != events.rend() && e->kind == COLLISION_BEAM_ASTEROID; ++e){
+		projectiles.despawn(e->source);
+	}
+
+	// Drop the destroyed asteroids in one pass. The rest keep their order, so they stay sorted by id.
+	if (anyDestroyed){
+		size_t n = 0;
+		for (size_t i = 0; i < asteroids.size(); i++){
+			if (!destroyed.at(i)){
+				asteroids.at(n++) = std::move(asteroids.at(i));
 			}
 		}
+		asteroids.erase(asteroids.begin() + n, asteroids.end());
 	}
 
 	// Add child asteroids to the asteroids array
 	for (int i = 0; i < newChildren.size(); i++){
 		asteroids.push_back(newChildren.at(i));
 	}
+
+	// An open world never runs out of asteroids
+	if (!field && asteroids.size() == 0 && ship->getCurrAnim() != GAME_OVER){
+		cout << " ====== YOU WIN! ====== \n";
+		endGame();
+		score += 2500 * numLives;
+	}
 }
 
-void render()
-{
-	// Update time.
-	double t = glfwGetTime();
+// Copies the world into the free snapshot slot and hands it to the render thread
+void publishSnapshot(){
+	WorldSnapshot &s = snapshots.writeBuffer();
+	s.tick = ++simTick;
+	s.t = tGlobal;
 
-	if (!pause){
-		tGlobal = t;
+	ship->getSnapshot(s.ship);
+
+	s.asteroids.resize(asteroids.size());
+	for (int i = 0; i < asteroids.size(); i++){
+		asteroids.at(i)->getInstance(s.asteroids.at(i));
 	}
 
-	// Check if the player has collided with an asteroid
-	int collision = checkShipCollisions();
+	s.originX = s.originZ = 0.0;
+	if (field){
+		// The reduced-rate chunks are drawn too, and the renderer wants every asteroid sorted by id
+		field->getInstances(s.asteroids);
+		std::sort(s.asteroids.begin(), s.asteroids.end(), [](const AsteroidInstance &a, const AsteroidInstance &b){
+			return a.id < b.id;
+		});
+		s.originX = field->getOriginX();
+		s.originZ = field->getOriginZ();
+	}
 
-	if (collision != -1){
+	s.projectiles.clear();
+	projectiles.getInstances(s.projectiles, tGlobal);
+
+	s.explosions.clear();
+	for (auto e = explosions.begin(); e != explosions.end(); ++e){
+		EmitterInstance ei;
+		ei.id = e->id;
+		ei.M = glm::translate(glm::mat4(1.0f), e->center);
+		ei.color = e->color;
+		s.explosions.push_back(ei);
+	}
+
+	// The ship's own explosion follows it until it has played out, then the game ends
+	s.finished = gameFinished;
+	if (ship->getCurrAnim() == GAME_OVER && !gameFinished){
+		EmitterInstance ei;
+		ei.id = SHIP_EXPLOSION_ID;
+		ei.M = s.ship.M;
+		ei.color = glm::vec3(1.0f, 1.0f, 1.0f);
+		s.explosions.push_back(ei);
+	}
+
+	s.numLives = numLives;
+	s.score = score;
+	s.arenaHighWater = simArena.getHighWater();
+	s.arenaOverflows = simArena.getOverflows();
+	s.tPublished = glfwGetTime();
+
+	snapshots.publish();
+}
+
+// Streams chunks in and out around the ship, and moves everything back towards the origin
+// when the ship has gone far enough from it
+void updateOpenWorld(){
+	field->update(ship->getPos(), asteroids);
+
+	glm::vec3 shift = field->rebase(ship->getPos(), asteroids);
+	if (shift != glm::vec3(0.0f)){
+		ship->rebase(shift);
+		projectiles.shift(shift);
+		for (auto e = explosions.begin(); e != explosions.end(); ++e){
+			e->center += shift;
+		}
 		if (debug){
-			cout << "Ship collided with asteroid " << collision << " at time " << t << endl;
+			cout << "Rebased the origin to (" << field->getOriginX() << ", " << field->getOriginZ() << ")" << endl;
 		}
+	}
+}
+
+// Advances the world by one fixed step. Only runs on the simulation thread (or before it starts).
+void simulate()
+{
+	simArena.reset();
+	Stats::Mark m0 = Stats::mark();
 
-		numLives--;
+	// Fire whatever expires this tick
+	simTimers.advance();
+	buildWorldQuery();
+
+	// Find what collided with what first, then act on it all at once
+	collisionEvents.clear();
+	int collision = checkShipCollisions();
+	if (collision != -1){
+		collisionEvents.push(CollisionEvent(COLLISION_SHIP_ASTEROID, 0, collision));
+	}
+	detectBeamCollisions();
+	resolveCollisions();
 
-		if (numLives < 0 && ship->getCurrAnim() != GAME_OVER){
-			// Begin ship explosion animation
-			ship->gameOver(RESOURCE_DIR);
+	// Asteroids bounce off each other before they move
+	if (field){ asteroidCollider.step(asteroids, 0.0f, 0.0f); }
+	else{ asteroidCollider.step(asteroids, MAX_X, MAX_Z); }
+
+	Stats::Mark m1 = Stats::mark();
+	Stats::record(STAT_SIM_COLLISIONS, m0, m1);
+
+	ship->moveShip(input.getDown());
+
+	for (auto a = asteroids.begin(); a != asteroids.end(); ++a){
+		if (field){ (*a)->drift(1.0f); }
+		else{ (*a)->move(); }
+	}
+	projectiles.update(tGlobal);
+
+	if (field){
+		updateOpenWorld();
+	}
+	else{
+		ship->boundShip();
+	}
+	if (ship->getCurrAnim() != GAME_OVER){
+		ship->updateAnimation();
+	}
+
+	// Check if the user shot a beam
+	if (input.wasReleased(GLFW_KEY_J) && (ship->getCurrAnim() == NONE)){
+		// If the user shot a beam, then:
+		// 1. Its position should be initialized to the spaceship's current position
+		// 2. Its direction should be initialized to the direction the camera is facing
+		MatrixStack MB;
+		MB.pushMatrix();
+		ship->applyMVTransforms(MB);
+
+		glm::vec3 beamPos = MB.topMatrix() * glm::vec4(0.0f, 0.5f, 2.0f, 1.0f);
+		glm::vec3 beamDir = MB.topMatrix() * glm::vec4(0.0f, 0.0f, 1.0f, 0.0f);
+
+		int b = projectiles.spawn(beamPos, beamDir, tGlobal);
+		if (b != -1){
+			simTimers.scheduleIn(BEAM_LIFE, expireProjectile, nullptr, projectiles.getID(b));
 		}
-		else{
-			// Start invincibility
-			ship->setInvincible();
+	}
+
+	Stats::Mark m2 = Stats::mark();
+	Stats::record(STAT_SIM_MOVE, m1, m2);
+
+	publishSnapshot();
+
+	Stats::record(STAT_SIM_PUBLISH, m2, Stats::mark());
+
+	// THIS NEEDS TO BE CALLED AFTER THE SHIP'S TRANSFORMS ARE SNAPSHOT
+	ship->updatePrevPos();
+}
+
+// Shifts the tick schedule a little towards the time the render thread last sampled input,
+// so that with --low-latency a tick runs right after each poll instead of up to SIM_DT later
+void alignTicks(double &tNext){
+	double tSampled = tInputSampled.exchange(-1.0);
+	if (tSampled < 0.0){
+		return;
+	}
+	double err = fmod(tNext - tSampled, SIM_DT);
+	if (err < 0.0){ err += SIM_DT; }
+	if (err < 0.5 * SIM_DT){
+		tNext -= std::min(err, SIM_PHASE_NUDGE);
+	}
+	else{
+		tNext += std::min(SIM_DT - err, SIM_PHASE_NUDGE);
+	}
+}
+
+// Runs simulate() every SIM_DT seconds until the window closes
+void simLoop()
+{
+	double tNext = glfwGetTime();
+
+	while (simRunning.load(memory_order_acquire)){
+		if (lowLatency){
+			alignTicks(tNext);
+		}
+		double t = glfwGetTime();
+		if (t < tNext){
+			double tSleep = tNext - t;
+			if (lowLatency){ tSleep = std::min(tSleep, SIM_POLL_INTERVAL); }
+			this_thread::sleep_for(chrono::duration<double>(tSleep));
+			continue;
+		}
+
+		// Catch up after a stall, but drop the backlog rather than spiral if ticks can't keep up
+		for (int i = 0; i < SIM_MAX_CATCHUP && tNext <= t; i++){
+			// Replay the key events that arrived since the last tick. While paused they are dropped.
+			input.drain();
+			if (!pause){
+				tGlobal = tNext;
+				ScopedStat tickStat(STAT_SIM_TICK);
+				simulate();
+				// The effect of this input is in the snapshot just published
+				if (input.getOldestEventTime() >= 0.0){
+					latency.stampInput(simTick, input.getOldestEventTime());
+				}
+			}
+			tNext += SIM_DT;
+		}
+		if (tNext <= t){
+			tNext = t + SIM_DT;
+		}
+	}
+}
+
+// Creates the particles for explosions the render thread hasn't seen yet, returns the ones the
+// simulation has forgotten to the pool, and submits the rest.
+void submitExplosions(int view, shared_ptr<MatrixStack> &MV, const WorldSnapshot &world){
+	static vector<pair<unsigned, shared_ptr<Explosion> > > live;
+
+	for (auto em = world.explosions.begin(); em != world.explosions.end(); ++em){
+		shared_ptr<Explosion> e;
+		for (auto fx = explosionEffects.begin(); fx != explosionEffects.end(); ++fx){
+			if (fx->first == em->id){
+				e = std::move(fx->second);
+				break;
+			}
+		}
+		if (!e){
+			Eigen::Vector3f col(em->color.x, em->color.y, em->color.z);
+			e = explosionPool.acquire();
+			if (e){
+				e->reset(col);
+			}
+			else{
+				e = make_shared<Explosion>(RESOURCE_DIR, col);
+			}
+			e->setCenter(glm::vec3(0.0f, 0.0f, 0.0f));
 		}
+
+		e->step();
+		MV->pushMatrix();
+		MV->multMatrix(em->M);
+		e->submit(*renderQueue, view, MV);
+		MV->popMatrix();
+
+		live.push_back(make_pair(em->id, e));
 	}
 
-	checkBeamCollisions();
+	// Whatever wasn't moved into live above has played out
+	for (auto fx = explosionEffects.begin(); fx != explosionEffects.end(); ++fx){
+		if (fx->second){
+			explosionPool.release(std::move(fx->second));
+		}
+	}
+
+	explosionEffects.swap(live);
+	live.clear();
+}
+
+void render()
+{
+	// Update time. This clock only drives the particles; the simulation thread has its own.
+	double t = glfwGetTime();
 
 	if (!pause){
-		ship->moveShip(isPressed);
+		tGlobal = t;
+	}
+
+	Stats::Mark mSnapshot = Stats::mark();
+
+	// Take the newest snapshot and blend towards it from the one before
+	if (snapshots.hasUpdate()){
+		prevSnapshot = snapshots.readBuffer();
+		snapshots.update();
+
+		// The exhaust particles are in world space, so they move with the open world's origin
+		glm::vec3 shift = originShift(prevSnapshot, snapshots.readBuffer());
+		if (shift != glm::vec3(0.0f)){
+			ship->shiftFlames(shift);
+		}
+	}
+	const WorldSnapshot &latest = snapshots.readBuffer();
+	latency.beginFrame(latest.tick);
+	double span = latest.t - prevSnapshot.t;
+	if (span <= 0.0){ span = SIM_DT; }
+	float alpha = glm::clamp((float)((t - latest.tPublished) / span), 0.0f, 1.0f);
+	interpolateSnapshots(prevSnapshot, latest, alpha, frameSnapshot);
+	const WorldSnapshot &world = frameSnapshot;
+
+	Stats::Mark mSubmit = Stats::mark();
+	Stats::record(STAT_SNAPSHOT, mSnapshot, mSubmit);
+
+	if (world.finished){
+		cout << "  - FINAL SCORE: " << std::max(world.score - std::min(ceil(world.t), 2000.0), 0.0) << endl;
+		glfwSetWindowShouldClose(window, GL_TRUE);
+		return;
 	}
 	
 	// Get current frame buffer size.
@@ -423,37 +944,29 @@ void render()
 	glfwGetFramebufferSize(window, &width, &height);
 	glViewport(0, 0, width, height);
 	
-	// Use the window size for camera.
+	// Use the window size for camera. The particle shaders also scale point sizes by it.
 	glfwGetWindowSize(window, &width, &height);
 	camera->setAspect((float)width/(float)height);
 	
-	// Clear buffers
+	// Clear buffers. The particles leave depth writes off, and glClear respects the depth mask.
+	GLState::depthMask(GL_TRUE);
 	glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
-	if(keyPresses[(unsigned)'c'] % 2) {
-		glEnable(GL_CULL_FACE);
-	} else {
-		glDisable(GL_CULL_FACE);
-	}
-	if(keyPresses[(unsigned)'z'] % 2) {
-		glPolygonMode(GL_FRONT_AND_BACK, GL_LINE);
-	} else {
-		glPolygonMode(GL_FRONT_AND_BACK, GL_FILL);
-	}
-	
-	auto P = make_shared<MatrixStack>();
-	auto MV = make_shared<MatrixStack>();
+	GLState::setEnabled(GL_CULL_FACE, keyPresses[(unsigned)'c'] % 2);
+	GLState::polygonMode((keyPresses[(unsigned)'z'] % 2) ? GL_LINE : GL_FILL);
+	GLState::disable(GL_BLEND);
 	
-	prog->bind();
+	P->reset();
+	MV->reset();
 
 	// Apply camera transforms
 	P->pushMatrix();
 
-	// Draw HUD before applying projection matrix
-	drawHUD(P, MV, t);
+	// Submit the HUD before applying projection matrix
+	submitHUD(P, MV, t, width, height, world);
 
 	// Modify the camera's FOV:
-	if (isPressed[GLFW_KEY_F]){ camera->increaseFOV(); }
-	if (isPressed[GLFW_KEY_G]){ camera->decreaseFOV(); }
+	if (glfwGetKey(window, GLFW_KEY_F) == GLFW_PRESS){ camera->increaseFOV(); }
+	if (glfwGetKey(window, GLFW_KEY_G) == GLFW_PRESS){ camera->decreaseFOV(); }
 
 	if (camType == TOP_DOWN){ 
 		P->scale(0.4f, 0.4f, 0.4f);
@@ -466,227 +979,338 @@ void render()
 		camera->applyProjectionMatrix(P); 
 	}
 
-	int currShipAnim = ship->getCurrAnim();
+	int currShipAnim = world.ship.anim;
 
 	MV->pushMatrix();
-	auto E = make_shared<MatrixStack>();
 	switch (camType){
 		case THIRD_PERSON:
 			camera->applyViewMatrix(MV);
-			ship->applyMVTransforms(E);
 			MV->rotate(M_PI, 0,1,0);
-			MV->multMatrix(glm::inverse(E->topMatrix()));
+			MV->multMatrix(glm::inverse(world.ship.M));
 			break;
 		case TOP_DOWN:
 			camera->applyTopDownViewMatrix(MV);
 			break;
 		case FIRST_PERSON:
 			if (currShipAnim != NONE && currShipAnim != GAME_OVER){
-				glm::mat4 Eship = ship->generateEMatrix();
+				glm::mat4 Eship = world.ship.E;
 				if (currShipAnim == LEFT_ROLL || currShipAnim == RIGHT_ROLL){
 					MV->translate(-1.0f * Eship[3]);
 				}
 				MV->multMatrix(Eship);
 			}
 			camera->applyFPSViewMatrix(MV);
-			ship->applyMVTransforms(E);
 			MV->rotate(M_PI, 0,1,0);
-			MV->multMatrix(glm::inverse(E->topMatrix()));
+			MV->multMatrix(glm::inverse(world.ship.M));
 			break;
 		default:
 			break;
 	}
 
-	glUniformMatrix4fv(prog->getUniform("P"), 1, GL_FALSE, glm::value_ptr(P->topMatrix()));
+	int sceneView = renderQueue->addView(P->topMatrix(), width, height);
+	glm::vec3 lightPos(0.0f, 0.0f, 0.0f);
 
-	// Draw the asteroids
-	for (int i = 0; i < asteroids.size(); i++){
-		if (!pause){
-			asteroids.at(i)->move();
-		}
-		asteroids.at(i)->drawAsteroid(prog, MV);
+	// Draw the asteroids, coarser the further they are from the ship
+	for (auto a = world.asteroids.begin(); a != world.asteroids.end(); ++a){
+		const Shape *mesh = a->model->getLOD(glm::length(a->bsCenter - world.ship.pos));
+		renderQueue->submitMesh(sceneView, mesh, MV->topMatrix() * a->M, a->color, lightPos);
 	}
 
 	// Draw the ship
-	ship->boundShip();
-	if (ship->getCurrAnim() != GAME_OVER){
-		ship->drawShip(prog, MV);
+	if (currShipAnim != GAME_OVER && camType != FIRST_PERSON){
+		renderQueue->submitMesh(sceneView, ship.get(), MV->topMatrix() * world.ship.drawM, world.ship.col, lightPos);
 	}
 
 	if (drawBoundingBox){
-		glUniform3f(prog->getUniform("kd"), 1.0f, 1.0f, 1.0f);
+		glm::vec3 bsCol(1.0f, 1.0f, 1.0f);
 
 		// Draw the ship's bounding sphere:
+		BoundingSphere bsS = ship->getMeshSphere().transformed(world.ship.drawM);
 		MV->pushMatrix();
-		auto bs = ship->getBoundingSphere();
-		MV->translate(bs->center);
-		MV->scale(bs->radius);
-		glUniformMatrix4fv(prog->getUniform("MV"), 1, GL_FALSE, glm::value_ptr(MV->topMatrix()));
-		bsModel->draw(prog);
+		MV->translate(bsS.center);
+		MV->scale(bsS.radius);
+		renderQueue->submitMesh(sceneView, bsModel.get(), MV->topMatrix(), bsCol, lightPos);
 		MV->popMatrix();
 
 		// Draw each asteroid's bounding box:
-		for (auto a = asteroids.begin(); a != asteroids.end(); ++a){
-			bs = (*a)->getBoundingSphere();
+		for (auto a = world.asteroids.begin(); a != world.asteroids.end(); ++a){
 			MV->pushMatrix();
-			MV->translate(bs->center);
-			MV->scale(bs->radius);
-			glUniformMatrix4fv(prog->getUniform("MV"), 1, GL_FALSE, glm::value_ptr(MV->topMatrix()));
-			bsModel->draw(prog);
+			MV->translate(a->bsCenter);
+			MV->scale(a->bsRadius);
+			renderQueue->submitMesh(sceneView, bsModel.get(), MV->topMatrix(), bsCol, lightPos);
 			MV->popMatrix();
 		}
 	}
 
-	prog->unbind();
-
 	// Draw any explosions
-	pProg->bind();
+	{
+		ScopedStat particleStat(STAT_PARTICLES);
+		submitExplosions(sceneView, MV, world);
+		ship->submitFlames(*renderQueue, sceneView, MV, world.ship);
+	}
+	
+	// The beams are drawn at the blended time, which is up to a tick before the latest snapshot
+	lineRenderer->setProjectiles(world.projectiles, (alpha - 1.0f) * (float)span);
 
-	glfwGetWindowSize(window, &width, &height);
+	// Draw the stars, beams, frame and grid
+	renderQueue->submitLines(sceneView, MV->topMatrix(), drawGrid, drawAxisFrame);
 
-	for (int i = 0; i < explosions.size(); i++){
+	Stats::Mark mExecute = Stats::mark();
+	Stats::record(STAT_SUBMIT, mSubmit, mExecute);
 
-		if (!explosions.at(i)->isAlive()){
-			explosions.erase(explosions.begin() + i);
-			i--;
-			continue;
-		}
+	// Sort and issue everything submitted above
+	renderQueue->execute();
 
-		explosions.at(i)->step();
-		explosions.at(i)->draw(P, MV, width, height, alphaTex, pProg);
-	}
+	Stats::record(STAT_EXECUTE, mExecute, Stats::mark());
+	
+	// Pop stacks
+	MV->popMatrix();
+	P->popMatrix();
+	
+	GLSL::checkError(GET_FILE_LINE);
+}
 
-	if (ship->getCurrAnim() == GAME_OVER){
-		ship->drawExplosion(P, MV, width, height, alphaTex, pProg);
+string lowercase(string s){
+	for (int i = 0; i < s.length(); i++){
+		s.at(i) = tolower(s.at(i));
 	}
 
-	ship->drawFlames(P, MV, width, height, alphaTex, pProg);
+	return s;
+}
 
-	pProg->unbind();
-	
-	// Draw the frame and the grid with OpenGL 1.x (no GLSL)
-	
-	// Setup the projection matrix
-	glMatrixMode(GL_PROJECTION);
-	glPushMatrix();
-	glLoadMatrixf(glm::value_ptr(P->topMatrix()));
-	
-	// Setup the modelview matrix
-	glMatrixMode(GL_MODELVIEW);
 
-	// Draw the stars
-	for (int i = 0; i < stars.size(); i++){
-		MV->pushMatrix();
-		MV->translate(stars.at(i)->pos);
-		glPushMatrix();
-		glLoadMatrixf(glm::value_ptr(MV->topMatrix()));
-		stars.at(i)->draw();
-		glPopMatrix();
-		MV->popMatrix();
+void printLatency(){
+	const Histogram &h = Stats::get(STAT_INPUT_LATENCY);
+	if (h.getCount() > 0){
+		cout << "Input latency: p50 " << 1000.0 * h.getPercentile(0.5) << " ms, p99 " << 1000.0 * h.getPercentile(0.99)
+			<< " ms (" << h.getCount() << " samples)" << endl;
 	}
+}
 
-	// Check if the user shot a beam
-	if (shootBeam && (ship->getCurrAnim() != SOMERSAULT)){
-		std::shared_ptr<Beam> b = findUnusedBeam();
-		
-		if (b != NULL){
-			// If the user shot a beam, then:
-			// 1. Its position should be initialized to the spaceship's current position
-			// 2. Its direction should be initialized to the direction the camera is facing
-			auto MB = make_shared<MatrixStack>();
-			MB->pushMatrix();
-			ship->applyMVTransforms(MB);
+// Prints how many redundant GL state calls the shadow cache filtered out and the input latency, about once a second
+void printDebugStats(){
+	static int frame = 0;
+	if (++frame % 60 == 0){
+		cout << "GL state calls: " << GLState::getIssuedCalls() << " issued, " << GLState::getSkippedCalls() << " skipped" << endl;
+		printLatency();
+	}
+}
 
-			glm::vec3 beamPos = MB->topMatrix() * glm::vec4(0.0f, 0.5f, 2.0f, 1.0f);
-			glm::vec3 beamDir = MB->topMatrix() * glm::vec4(0.0f, 0.0f, 1.0f, 0.0f);
+// Refreshes the --metrics page every METRICS_INTERVAL seconds. Doesn't allocate or wait on readers.
+void updateMetrics(){
+	static double tStart = glfwGetTime();
+	static double tLast = tStart;
+	static uint64_t frames = 0;
+	static uint64_t framesLast = 0;
+	static uint64_t allocsLast = 0;
 
-			b->reset(beamPos, beamDir);
-		}
+	frames++;
+	double t = glfwGetTime();
+	if (t - tLast < METRICS_INTERVAL){
+		return;
+	}
 
-		shootBeam = false;
+	const WorldSnapshot &world = frameSnapshot;
+	uint64_t allocs = AllocStats::getCount();
+
+	MetricsData &d = metrics->beginWrite();
+	d.uptime = t - tStart;
+	d.fps = (frames - framesLast) / (t - tLast);
+	d.frames = frames;
+	d.ticks = world.tick;
+	d.asteroids = world.asteroids.size();
+	d.beams = world.projectiles.size();
+	d.explosions = world.explosions.size();
+	d.particles = 0;
+	for (auto fx = explosionEffects.begin(); fx != explosionEffects.end(); ++fx){
+		d.particles += fx->second->getNumParticles();
 	}
-	
-	// Draw the beams
-	MV->pushMatrix();
-	glPushMatrix();
-	glLoadMatrixf(glm::value_ptr(MV->topMatrix()));
-	for (auto b = beams.begin(); b != beams.end(); ++b){ 
-		(*b)->draw(); 
+	d.lives = world.numLives;
+	d.score = (int32_t)world.score;
+	d.allocs = allocs;
+	d.allocsPerSecond = (allocs - allocsLast) / (t - tLast);
+	d.simArenaHighWater = world.arenaHighWater;
+	d.simArenaOverflows = world.arenaOverflows;
+	d.numPhases = std::min((int)STAT_NUM_PHASES, METRICS_MAX_PHASES);
+	for (uint32_t i = 0; i < d.numPhases; i++){
+		const Histogram &h = Stats::get(i);
+		MetricsPhase &p = d.phases[i];
+		strncpy(p.name, Stats::getName(i), METRICS_NAME_LENGTH);
+		p.p50Ms = 1000.0 * h.getPercentile(0.5);
+		p.p99Ms = 1000.0 * h.getPercentile(0.99);
+		p.maxMs = 1000.0 * h.getMax();
+		p.meanMs = 1000.0 * h.getMean();
+		p.allocsPerCall = Stats::getAllocsPerCall(i);
+		p.maxAllocs = Stats::getMaxAllocs(i);
 	}
+	metrics->endWrite();
 
-	glPopMatrix();
-	MV->popMatrix();
+	tLast = t;
+	framesLast = frames;
+	allocsLast = allocs;
+}
 
-	// THIS NEEDS TO BE CALLED AFTER DRAWING THE SHIP AND BOUNDING BOX
-	ship->updatePrevPos();
+// With --low-latency, gives the simulation a moment to run the tick that consumes the input just polled
+void waitForTick(){
+	tInputSampled = glfwGetTime();
+	double tGiveUp = glfwGetTime() + SIM_WAIT_MAX;
+	while (!pause && !snapshots.hasUpdate() && glfwGetTime() < tGiveUp){
+		this_thread::yield();
+	}
+}
 
-	glPushMatrix();
-	glLoadMatrixf(glm::value_ptr(MV->topMatrix()));
-	
-	// Draw frame
-	if (drawAxisFrame){
-		glLineWidth(2);
-		glBegin(GL_LINES);
-		glColor3f(1, 0, 0);
-		glVertex3f(0, 0, 0);
-		glVertex3f(1, 0, 0);
-		glColor3f(0, 1, 0);
-		glVertex3f(0, 0, 0);
-		glVertex3f(0, 1, 0);
-		glColor3f(0, 0, 1);
-		glVertex3f(0, 0, 0);
-		glVertex3f(0, 0, 1);
-		glEnd();
-		glLineWidth(1);
+// --scaling-sweep: presses and releases keys on a fixed schedule, so every point plays the same game.
+// The ship thrusts the whole time, weaves left and right, and fires four beams a second.
+void scriptInput(int tick){
+	if (tick == 0){ input.push(GLFW_KEY_W, GLFW_PRESS); }
+	switch (tick % 240){
+		case 0: input.push(GLFW_KEY_A, GLFW_PRESS); break;
+		case 60: input.push(GLFW_KEY_A, GLFW_RELEASE); break;
+		case 120: input.push(GLFW_KEY_D, GLFW_PRESS); break;
+		case 180: input.push(GLFW_KEY_D, GLFW_RELEASE); break;
+		default: break;
 	}
-	
-	// Draw grid
-	if (drawGrid){
-		float gridSizeHalf = 115.0f;
-		float gridOffset = -5.0f;
-		int gridNx = 20;
-		int gridNz = 20;
-
-		glLineWidth(1);
-		glColor3f(0.1f, 0.5f, 0.1f);
-		glBegin(GL_LINES);
-		for(int i = 0; i < gridNx+1; ++i) {
-			float alpha = i / (float)gridNx;
-			float x = (1.0f - alpha) * (-gridSizeHalf) + alpha * gridSizeHalf;
-			glVertex3f(x, gridOffset, -gridSizeHalf);
-			glVertex3f(x, gridOffset,  gridSizeHalf);
-		}
-		for(int i = 0; i < gridNz+1; ++i) {
-			float alpha = i / (float)gridNz;
-			float z = (1.0f - alpha) * (-gridSizeHalf) + alpha * gridSizeHalf;
-			glVertex3f(-gridSizeHalf, gridOffset, z);
-			glVertex3f( gridSizeHalf, gridOffset, z);
-		}
-		glEnd();
+	if (tick % 15 == 0){ input.push(GLFW_KEY_J, GLFW_PRESS); }
+	else if (tick % 15 == 1){ input.push(GLFW_KEY_J, GLFW_RELEASE); }
+}
+
+// Tops the simulation's explosions up to n, scattered over the map
+void keepExplosionsAlive(int n){
+	while ((int)explosions.size() < n){
+		addExplosion(glm::vec3(randomFloat(-MAX_X, MAX_X), 0.0f, randomFloat(-MAX_Z, MAX_Z)), glm::vec3(1.0f, 0.6f, 0.2f));
 	}
-	
-	// Pop modelview matrix
-	glPopMatrix();
-	
-	// Pop projection matrix
-	glMatrixMode(GL_PROJECTION);
-	glPopMatrix();
-	
-	// Pop stacks
-	MV->popMatrix();
-	P->popMatrix();
-	
-	GLSL::checkError(GET_FILE_LINE);
 }
 
-string lowercase(string s){
-	for (int i = 0; i < s.length(); i++){
-		s.at(i) = tolower(s.at(i));
+// Starts the world over with numAsteroids fresh asteroids, the ship at rest, and no keys held
+void resetSweepWorld(int numAsteroids){
+	srand(SWEEP_SEED);
+
+	for (auto a = asteroids.begin(); a != asteroids.end(); ++a){
+		asteroidPool.release(*a);
+	}
+	asteroids.clear();
+	asteroids.reserve(2 * numAsteroids);
+	asteroidPool.reserve(2 * numAsteroids);
+	asteroidBodies.reserve(4 * numAsteroids);
+	explosions.reserve(2 * numAsteroids);
+	explosionSlotIndex.reserve(2 * numAsteroids);
+	freeExplosionSlots.reserve(2 * numAsteroids);
+	for (int i = 0; i < numAsteroids; i++){
+		shared_ptr<Asteroid> a = asteroidPool.acquire();
+		if (a){
+			a->reset(asteroidModels.at(i % asteroidModels.size()));
+		}
+		else{
+			a = make_shared<Asteroid>(asteroidModels.at(i % asteroidModels.size()));
+		}
+		asteroids.push_back(a);
 	}
 
-	return s;
+	explosions.clear();
+	explosionSlotIndex.clear();
+	freeExplosionSlots.clear();
+	projectiles.clear();
+	simTimers.reset();
+	gameFinished = false;
+	ship->respawn();
+	numLives = SWEEP_LIVES;
+	score = 0.0;
+
+	input.push(GLFW_KEY_W, GLFW_RELEASE);
+	input.push(GLFW_KEY_A, GLFW_RELEASE);
+	input.push(GLFW_KEY_D, GLFW_RELEASE);
+	input.push(GLFW_KEY_J, GLFW_RELEASE);
+	input.drain();
+}
+
+// Runs the scripted game for SWEEP_TICKS frames with one simulation tick and one render each,
+// all on this thread, and collects what the phases cost
+SweepPoint runSweepPoint(int numAsteroids, int numExplosions){
+	resetSweepWorld(numAsteroids);
+
+	SweepPoint pt;
+	pt.asteroids = numAsteroids;
+	pt.explosions = numExplosions;
+	uint64_t allocs0 = 0;
+
+	for (int tick = 0; tick < SWEEP_WARMUP_TICKS + SWEEP_TICKS; tick++){
+		bool measured = tick >= SWEEP_WARMUP_TICKS;
+		if (tick == SWEEP_WARMUP_TICKS){
+			Stats::reset();
+			allocs0 = AllocStats::getCount();
+		}
+		Stats::Mark m0 = Stats::mark();
+
+		// The simulation's clock is the tick count, whatever the wall clock says (render() moves it)
+		tGlobal = tick * SIM_DT;
+		scriptInput(tick);
+		input.drain();
+		keepExplosionsAlive(numExplosions);
+		{
+			ScopedStat tickStat(STAT_SIM_TICK);
+			simulate();
+		}
+
+		render();
+		glfwSwapBuffers(window);
+		// Waits for the GPU, so each frame's draws are paid for in that frame
+		glFinish();
+		glfwPollEvents();
+
+		if (measured){
+			Stats::record(STAT_FRAME, m0, Stats::mark());
+			pt.liveAsteroids += asteroids.size();
+			for (auto fx = explosionEffects.begin(); fx != explosionEffects.end(); ++fx){
+				pt.liveParticles += fx->second->getNumParticles();
+			}
+		}
+	}
+
+	pt.liveAsteroids /= SWEEP_TICKS;
+	pt.liveParticles /= SWEEP_TICKS;
+	pt.allocsPerFrame = (double)(AllocStats::getCount() - allocs0) / SWEEP_TICKS;
+	ScalingSweep::readMemory(pt.rssMB, pt.peakRssMB);
+
+	const int phases[SWEEP_NUM_SUBSYSTEMS] = { STAT_FRAME, STAT_SIM_COLLISIONS, STAT_SIM_MOVE, STAT_PARTICLES, STAT_SUBMIT, STAT_EXECUTE };
+	for (int s = 0; s < SWEEP_NUM_SUBSYSTEMS; s++){
+		const Histogram &h = Stats::get(phases[s]);
+		pt.meanMs[s] = 1000.0 * h.getMean();
+		pt.p99Ms[s] = 1000.0 * h.getPercentile(0.99);
+	}
+	// The particles are submitted inside the submit phase. Its p99 is left whole.
+	pt.meanMs[SWEEP_SUBMISSION] = std::max(pt.meanMs[SWEEP_SUBMISSION] - pt.meanMs[SWEEP_PARTICLES], 0.0);
+	return pt;
 }
 
+// Sweeps the asteroid count and then the particle density geometrically, and reports how each
+// subsystem scales with them. Returns false if the report couldn't be written.
+bool runScalingSweep(){
+	vector<SweepPoint> byCount;
+	vector<double> xCount;
+	for (int n = SWEEP_MIN_ASTEROIDS; n <= SWEEP_MAX_ASTEROIDS; n *= 2){
+		cout << "Sweep: " << n << " asteroids, " << SWEEP_BASE_EXPLOSIONS << " explosions" << endl;
+		byCount.push_back(runSweepPoint(n, SWEEP_BASE_EXPLOSIONS));
+		xCount.push_back(byCount.back().liveAsteroids);
+	}
+
+	vector<SweepPoint> byDensity;
+	vector<double> xDensity;
+	for (int k = 1; k <= SWEEP_MAX_EXPLOSIONS; k *= 2){
+		cout << "Sweep: " << NUM_ASTEROIDS << " asteroids, " << k << " explosions" << endl;
+		byDensity.push_back(runSweepPoint(NUM_ASTEROIDS, k));
+		xDensity.push_back(byDensity.back().liveParticles);
+	}
+
+	string countTitle = "Asteroid count (" + to_string(SWEEP_BASE_EXPLOSIONS) + " explosions, " + to_string(SWEEP_TICKS) + " frames per point)";
+	string densityTitle = "Particle density (" + to_string(NUM_ASTEROIDS) + " asteroids, " + to_string(SWEEP_TICKS) + " frames per point)";
+	ScalingSweep::writeTable(cout, countTitle, "asteroids", xCount, byCount);
+	ScalingSweep::writeTable(cout, densityTitle, "particles", xDensity, byDensity);
+
+	ofstream out(sweepOut);
+	ScalingSweep::writeTable(out, countTitle, "asteroids", xCount, byCount);
+	ScalingSweep::writeTable(out, densityTitle, "particles", xDensity, byDensity);
+	return (bool)out;
+}
 
 void processInputs(int argc, char **argv){
 	RESOURCE_DIR = argv[1] + string("/");
@@ -713,7 +1337,35 @@ void processInputs(int argc, char **argv){
 		else if (opt == "-g"){ drawGrid = true; }
 		else if (opt == "-t"){ camType = TOP_DOWN; }
 		else if (opt == "-fp"){ camType = FIRST_PERSON; }
+		else if (opt == "--gl-compat"){ coreProfile = false; }
+		else if (opt == "-d"){ debug = true; }
+		else if (opt == "--low-latency"){ lowLatency = true; }
+		else if (opt == "--metrics"){ publishMetrics = true; }
+		else if (opt == "--open-world"){
+			i += 1;
+			openWorld = true;
+			worldSeed = (unsigned)std::stoul(argv[i]);
+		}
+		else if (opt == "--procedural"){
+			i += 1;
+			proceduralVariants = std::stoi(argv[i]);
+		}
+		else if (opt == "--bench"){
+			i += 1;
+			benchName = lowercase(argv[i]);
+		}
+		else if (opt == "--stats-out"){
+			i += 1;
+			statsOut = argv[i];
+		}
+		else if (opt == "--scaling-sweep"){
+			i += 1;
+			sweepOut = argv[i];
+		}
 	}
+
+	// The GLSL 330 shaders live in their own directory
+	SHADER_DIR = coreProfile ? RESOURCE_DIR + "glsl330/" : RESOURCE_DIR;
 }
 
 int main(int argc, char **argv)
@@ -727,11 +1379,30 @@ int main(int argc, char **argv)
 		cout << "         -g     - Turns on the grid\n";
 		cout << "         -t     - Defaults to top-down cam\n";
 		cout << "         -fp    - Defaults to first-person cam\n";
+		cout << "         -d     - Prints debug output (collisions, GL state calls skipped per frame, input latency)\n";
+		cout << "         --gl-compat - Uses an OpenGL 2.1 compatibility context instead of 3.3 core\n";
+		cout << "         --low-latency - Renders just before each refresh and samples input late\n";
+		cout << "         --stats-out FILE - Writes frame and phase timing histograms to FILE as JSON at exit\n";
+		cout << "         --metrics - Publishes live metrics in shared memory for tools/metrics_reader\n";
+		cout << "         --open-world SEED - Flies through an endless field generated from SEED (-a is then per chunk)\n";
+		cout << "         --procedural N - Generates N asteroid meshes (cached in asteroid-cache/) instead of loading asteroid1.obj\n";
+		cout << "         --bench NAME - Runs a benchmark suite (or all) instead of the game\n";
+		cout << "         --scaling-sweep FILE - Plays a scripted game offscreen at growing asteroid counts and particle densities, and writes how each subsystem scales to FILE\n";
 
 		return 0;
 	}
 
 	processInputs(argc, argv);
+
+	// Benchmarks don't need a window
+	if(!benchName.empty()) {
+		if(!Benchmark::run(benchName)) {
+			cerr << "Unknown benchmark " << benchName << ". Available: ";
+			Benchmark::list(cerr);
+			return 1;
+		}
+		return 0;
+	}
 	
 	// Set error callback.
 	glfwSetErrorCallback(error_callback);
@@ -739,6 +1410,19 @@ int main(int argc, char **argv)
 	if(!glfwInit()) {
 		return -1;
 	}
+	// Request an OpenGL 3.3 core profile context unless the compatibility path was asked for.
+	if(coreProfile) {
+		glfwWindowHint(GLFW_CONTEXT_VERSION_MAJOR, 3);
+		glfwWindowHint(GLFW_CONTEXT_VERSION_MINOR, 3);
+		glfwWindowHint(GLFW_OPENGL_PROFILE, GLFW_OPENGL_CORE_PROFILE);
+#ifdef __APPLE__
+		glfwWindowHint(GLFW_OPENGL_FORWARD_COMPAT, GL_TRUE);
+#endif
+	}
+	// The sweep renders offscreen, as fast as it can
+	if(!sweepOut.empty()) {
+		glfwWindowHint(GLFW_VISIBLE, GLFW_FALSE);
+	}
 	// Create a windowed mode window and its OpenGL context.
 	window = glfwCreateWindow(640, 480, "OCTAVIO ALMANZA", NULL, NULL);
 	if(!window) {
@@ -757,7 +1441,13 @@ int main(int argc, char **argv)
 	cout << "OpenGL version: " << glGetString(GL_VERSION) << endl;
 	cout << "GLSL version: " << glGetString(GL_SHADING_LANGUAGE_VERSION) << endl;
 	// Set vsync.
-	glfwSwapInterval(1);
+	glfwSwapInterval(sweepOut.empty() ? 1 : 0);
+	// Sync objects are core in 3.2; the compatibility context needs the extension
+	useFences = coreProfile || GLEW_ARB_sync;
+	if(lowLatency) {
+		const GLFWvidmode *mode = glfwGetVideoMode(glfwGetPrimaryMonitor());
+		pacer = make_shared<FramePacer>((mode && mode->refreshRate > 0) ? mode->refreshRate : 60.0);
+	}
 	// Set keyboard callback.
 	glfwSetKeyCallback(window, key_callback);
 	// Set char callback.
@@ -766,18 +1456,103 @@ int main(int argc, char **argv)
 	glfwSetCursorPosCallback(window, cursor_position_callback);
 	// Set mouse button callback.
 	glfwSetMouseButtonCallback(window, mouse_button_callback);
+	// The sweep replays its own game in the wrapping field
+	if(!sweepOut.empty() && openWorld) {
+		cout << "--open-world is ignored with --scaling-sweep" << endl;
+		openWorld = false;
+	}
 	// Initialize scene.
 	init();
+	if(!sweepOut.empty()) {
+		bool written = runScalingSweep();
+		if(!written) {
+			cerr << "Could not write the scaling report to " << sweepOut << endl;
+		}
+		glfwDestroyWindow(window);
+		glfwTerminate();
+		return written ? 0 : 1;
+	}
+	if(publishMetrics) {
+		metrics = make_shared<MetricsPublisher>();
+		if(metrics->open()) {
+			cout << "Publishing metrics at " << metrics->getName() << endl;
+		}
+		else {
+			cerr << "Could not create the metrics page" << endl;
+			metrics.reset();
+		}
+	}
+	// Give the render thread a first snapshot, then hand the world over to the simulation thread.
+	publishSnapshot();
+	simRunning = true;
+	thread simThread(simLoop);
 	// Loop until the user closes the window.
+	Stats::Mark mFrame = Stats::mark();
+	bool firstFrame = true;
 	while(!glfwWindowShouldClose(window)) {
+		Stats::Mark mNow = Stats::mark();
+		if(!firstFrame) {
+			Stats::record(STAT_FRAME, mFrame, mNow);
+		}
+		mFrame = mNow;
+		firstFrame = false;
 		if(!glfwGetWindowAttrib(window, GLFW_ICONIFIED)) {
 			// Render scene.
+			GLState::resetFrameStats();
+			if(lowLatency) {
+				pacer->beginWork(glfwGetTime());
+			}
+			else {
+				latency.poll(glfwGetTime());
+			}
 			render();
+			if(debug) {
+				printDebugStats();
+			}
+			if(lowLatency) {
+				glFinish();
+				pacer->workDone(glfwGetTime());
+			}
 			// Swap front and back buffers.
-			glfwSwapBuffers(window);
+			{
+				ScopedStat swapStat(STAT_SWAP);
+				glfwSwapBuffers(window);
+			}
+			// Note when the frame is done so the latency tracker can time it
+			if(lowLatency) {
+				glFinish();
+				double t = glfwGetTime();
+				pacer->presented(t);
+				latency.present(t);
+			}
+			else if(useFences) {
+				latency.fence();
+			}
+		}
+		if(metrics) {
+			updateMetrics();
+		}
+		if(lowLatency) {
+			pacer->wait();
 		}
 		// Poll for and process events.
-		glfwPollEvents();
+		{
+			ScopedStat pollStat(STAT_POLL);
+			glfwPollEvents();
+		}
+		if(lowLatency) {
+			waitForTick();
+		}
+	}
+	// Stop the simulation before tearing down the context.
+	simRunning = false;
+	simThread.join();
+	field.reset(); // Stops its workers
+	Stats::print(cout);
+	cout << "  - SIM ARENA: " << simArena.getHighWater() << " of " << SIM_ARENA_SIZE << " bytes at most, "
+		<< simArena.getOverflows() << " allocations fell back to the heap" << endl;
+	if(!statsOut.empty() && !Stats::writeJSON(statsOut)) {
+		cerr << "Could not write stats to " << statsOut << endl;
 	}
 	// Quit program.
 	glfwDestroyWindow(window);
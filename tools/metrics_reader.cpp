@@ -0,0 +1,110 @@
+// Prints the metrics a running game publishes with --metrics, in Prometheus text format.
+// Usage: metrics_reader PID [-w]   (-w keeps printing once a second)
+
+#include <chrono>
+#include <cstring>
+#include <iostream>
+#include <string>
+#include <thread>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <unistd.h>
+
+#include "MetricsPage.h"
+
+using namespace std;
+
+#define READ_ATTEMPTS 1000
+
+// Copies the data out of the page, retrying while the game is in the middle of writing it
+bool readPage(const MetricsPage *page, MetricsData &out){
+	for (int i = 0; i < READ_ATTEMPTS; i++){
+		uint32_t s0 = page->seq.load(memory_order_acquire);
+		if (s0 & 1){
+			this_thread::yield();
+			continue;
+		}
+		memcpy(&out, (const void *)&page->data, sizeof(MetricsData));
+		atomic_thread_fence(memory_order_acquire);
+		if (page->seq.load(memory_order_relaxed) == s0){
+			return true;
+		}
+	}
+	return false;
+}
+
+void print(const MetricsData &d, uint32_t pid){
+	string l = "{pid=\"" + to_string(pid) + "\"}";
+	cout << "final_uptime_seconds" << l << " " << d.uptime << "\n";
+	cout << "final_fps" << l << " " << d.fps << "\n";
+	cout << "final_frames_total" << l << " " << d.frames << "\n";
+	cout << "final_ticks_total" << l << " " << d.ticks << "\n";
+	cout << "final_asteroids" << l << " " << d.asteroids << "\n";
+	cout << "final_beams" << l << " " << d.beams << "\n";
+	cout << "final_explosions" << l << " " << d.explosions << "\n";
+	cout << "final_particles" << l << " " << d.particles << "\n";
+	cout << "final_lives" << l << " " << d.lives << "\n";
+	cout << "final_score" << l << " " << d.score << "\n";
+	cout << "final_allocs_total" << l << " " << d.allocs << "\n";
+	cout << "final_allocs_per_second" << l << " " << d.allocsPerSecond << "\n";
+	cout << "final_sim_arena_high_water_bytes" << l << " " << d.simArenaHighWater << "\n";
+	cout << "final_sim_arena_overflows_total" << l << " " << d.simArenaOverflows << "\n";
+
+	uint32_t n = d.numPhases < METRICS_MAX_PHASES ? d.numPhases : METRICS_MAX_PHASES;
+	for (uint32_t i = 0; i < n; i++){
+		const MetricsPhase &p = d.phases[i];
+		string name(p.name, strnlen(p.name, METRICS_NAME_LENGTH));
+		string pl = "{pid=\"" + to_string(pid) + "\",phase=\"" + name + "\"";
+		cout << "final_phase_ms" << pl << ",stat=\"p50\"} " << p.p50Ms << "\n";
+		cout << "final_phase_ms" << pl << ",stat=\"p99\"} " << p.p99Ms << "\n";
+		cout << "final_phase_ms" << pl << ",stat=\"max\"} " << p.maxMs << "\n";
+		cout << "final_phase_ms" << pl << ",stat=\"mean\"} " << p.meanMs << "\n";
+		cout << "final_phase_allocs" << pl << ",stat=\"per_call\"} " << p.allocsPerCall << "\n";
+		cout << "final_phase_allocs" << pl << ",stat=\"max\"} " << p.maxAllocs << "\n";
+	}
+	cout << flush;
+}
+
+int main(int argc, char **argv)
+{
+	if(argc < 2) {
+		cout << "Usage: ./metrics_reader PID [-w]\n";
+		cout << "Reads the metrics page of a game started with --metrics\n";
+		return 0;
+	}
+	bool watch = argc > 2 && string(argv[2]) == "-w";
+
+	string name = string(METRICS_SHM_PREFIX) + argv[1];
+	int fd = shm_open(name.c_str(), O_RDONLY, 0);
+	if(fd < 0) {
+		cerr << "No metrics page " << name << " (is the game running with --metrics?)" << endl;
+		return 1;
+	}
+	void *mem = mmap(nullptr, sizeof(MetricsPage), PROT_READ, MAP_SHARED, fd, 0);
+	close(fd);
+	if(mem == MAP_FAILED) {
+		cerr << "Could not map " << name << endl;
+		return 1;
+	}
+	const MetricsPage *page = (const MetricsPage *)mem;
+	if(page->magic != METRICS_MAGIC || page->version != METRICS_VERSION) {
+		cerr << name << " is not a version " << METRICS_VERSION << " metrics page" << endl;
+		return 1;
+	}
+
+	do {
+		MetricsData d;
+		if(!readPage(page, d)) {
+			cerr << "Gave up waiting for a consistent read" << endl;
+			return 1;
+		}
+		print(d, page->pid);
+		if(watch) {
+			this_thread::sleep_for(chrono::seconds(1));
+		}
+	} while(watch);
+
+	munmap(mem, sizeof(MetricsPage));
+	return 0;
+}